@@ -0,0 +1,265 @@
+#pragma once
+/*
+ * hyprswitcher.h - libhyprswitcher public API
+ *
+ * The window-list machinery of the hyprswitcher overlay, usable from other
+ * programs (bars, launchers, scripts) without the Wayland UI:
+ *
+ *   - hs_snapshot: the client list from Hyprland's j/clients reply,
+ *     queried over the socket or parsed from a buffer you already hold
+ *   - hs_events:   the socket2 event stream, parsed into fixed-size events
+ *   - hs_model:    an incrementally maintained window list in MRU, class,
+ *                  workspace or monitor order
+ *
+ * Allocation: every object is allocated through the hs_allocator passed
+ * to its constructor (NULL = malloc/free), in one block per object where
+ * possible. hs_events_read(), hs_event_parse_line() and hs_model_rows()
+ * never allocate. Pointers handed out by a snapshot or model stay valid
+ * until that object is freed or (for a model) the window is removed.
+ *
+ * Threads: objects are not internally locked; use each from one thread
+ * at a time. Different objects may be used concurrently.
+ *
+ * Logging: silent unless HYPRSWITCHER_LOG is set (debug, info, warn,
+ * error), in which case messages go to stderr.
+ *
+ * Return values: functions returning int use 0 for success and -1 for
+ * failure unless documented otherwise.
+ */
+
+#ifndef HYPRSWITCHER_H
+#define HYPRSWITCHER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Bumped on incompatible changes; compare with hs_api_version() */
+#define HYPRSWITCHER_API_VERSION 1
+
+#if defined(__GNUC__) && !defined(HYPRSWITCHER_STATIC)
+#define HS_EXPORT __attribute__((visibility("default")))
+#else
+#define HS_EXPORT
+#endif
+
+/* API version the library was built with (HYPRSWITCHER_API_VERSION). */
+HS_EXPORT int hs_api_version(void);
+
+/* ============================================================================
+ * Allocation
+ * ============================================================================ */
+
+typedef struct hs_allocator {
+    void *(*alloc)(void *ctx, size_t size);   /* Returns NULL on failure */
+    void (*free)(void *ctx, void *ptr);       /* Never called with NULL */
+    void *ctx;
+} hs_allocator;
+
+/* ============================================================================
+ * Clients
+ * ============================================================================ */
+
+typedef struct hs_client {
+    const char *address;        /* "0x..." window address */
+    const char *app_class;      /* Class, or initialClass when empty */
+    const char *title;          /* Sanitized title, "(untitled)" when empty */
+    int workspace_id;           /* -1 when unknown */
+    int monitor_id;             /* -1 when unknown */
+    int pid;                    /* -1 when unknown */
+    int focus_history_id;       /* 0 = focused, -1 = unknown */
+    bool focused;
+} hs_client;
+
+/* ============================================================================
+ * Snapshots
+ * ============================================================================ */
+
+typedef struct hs_snapshot hs_snapshot;
+
+/*
+ * Query Hyprland's client list over the command socket
+ * ($XDG_RUNTIME_DIR/hypr/$HYPRLAND_INSTANCE_SIGNATURE/.socket.sock).
+ *
+ * Returns:
+ *   Snapshot sorted most recently focused first, or NULL on error
+ */
+HS_EXPORT hs_snapshot *hs_snapshot_query(const hs_allocator *allocator);
+
+/*
+ * Parse a j/clients reply already in memory (len bytes, NUL not required).
+ *
+ * Returns:
+ *   Snapshot sorted most recently focused first, or NULL on malformed
+ *   input or allocation failure
+ */
+HS_EXPORT hs_snapshot *hs_snapshot_parse(const char *json, size_t len,
+                                         const hs_allocator *allocator);
+
+/* Number of clients in the snapshot (0 for NULL). */
+HS_EXPORT size_t hs_snapshot_count(const hs_snapshot *snapshot);
+
+/*
+ * Client at a position of the snapshot.
+ *
+ * Returns:
+ *   Client, or NULL if index is out of range
+ */
+HS_EXPORT const hs_client *hs_snapshot_at(const hs_snapshot *snapshot, size_t index);
+
+/* Free a snapshot and its strings (NULL is ignored). */
+HS_EXPORT void hs_snapshot_free(hs_snapshot *snapshot);
+
+/* ============================================================================
+ * Events
+ * ============================================================================ */
+
+typedef enum hs_event_type {
+    HS_EVENT_NONE = 0,
+    HS_EVENT_OPEN_WINDOW,       /* address, workspace_id, window_class, title */
+    HS_EVENT_CLOSE_WINDOW,      /* address */
+    HS_EVENT_ACTIVE_WINDOW,     /* window_class, title */
+    HS_EVENT_MOVE_WINDOW,       /* address, workspace_id (-1 for named workspaces) */
+    HS_EVENT_ACTIVE_WINDOW_V2,  /* address ("0x..." form) */
+    HS_EVENT_WINDOW_TITLE_V2,   /* address, title */
+} hs_event_type;
+
+typedef struct hs_event {
+    hs_event_type type;
+    char address[32];
+    char window_class[128];
+    char title[256];
+    int workspace_id;
+} hs_event;
+
+typedef struct hs_events hs_events;
+
+/*
+ * Connect to Hyprland's event socket (socket2). The socket is
+ * non-blocking; poll hs_events_fd() for readability.
+ *
+ * Returns:
+ *   Event stream, or NULL on error
+ */
+HS_EXPORT hs_events *hs_events_connect(const hs_allocator *allocator);
+
+/* File descriptor to poll for POLLIN (-1 for NULL). */
+HS_EXPORT int hs_events_fd(const hs_events *events);
+
+/*
+ * Read the next window event without blocking. Call until it returns 0
+ * after each POLLIN; events this library does not model are skipped.
+ *
+ * Returns:
+ *   1:  An event was stored in `event`
+ *   0:  No complete event buffered
+ *   -1: Connection closed or read error
+ */
+HS_EXPORT int hs_events_read(hs_events *events, hs_event *event);
+
+/* Close the socket and free the stream (NULL is ignored). */
+HS_EXPORT void hs_events_disconnect(hs_events *events);
+
+/*
+ * Parse one event line ("EVENT>>DATA", without the newline), for callers
+ * that read the socket themselves.
+ *
+ * Returns:
+ *   true if `event` now holds one of the hs_event_type events
+ */
+HS_EXPORT bool hs_event_parse_line(const char *line, hs_event *event);
+
+/* ============================================================================
+ * Model
+ * ============================================================================ */
+
+typedef enum hs_order {
+    HS_ORDER_MRU = 0,           /* Most recently focused first */
+    HS_ORDER_CLASS,             /* By class, then recency */
+    HS_ORDER_WORKSPACE,         /* By workspace id, then recency */
+    HS_ORDER_MONITOR,           /* By monitor, workspace, then recency */
+} hs_order;
+
+typedef struct hs_model hs_model;
+
+/*
+ * Create an empty model in MRU order. The allocator covers the model
+ * itself; windows are kept on the C heap.
+ *
+ * Returns:
+ *   Model, or NULL on allocation failure
+ */
+HS_EXPORT hs_model *hs_model_new(const hs_allocator *allocator);
+
+/* Free the model and every window in it (NULL is ignored). */
+HS_EXPORT void hs_model_free(hs_model *model);
+
+/*
+ * Reconcile the model with a snapshot: windows are matched by address,
+ * only new or changed ones are repositioned. The snapshot is not
+ * modified and may be freed afterwards.
+ */
+HS_EXPORT int hs_model_apply_snapshot(hs_model *model, const hs_snapshot *snapshot);
+
+/*
+ * Apply a window event (open, close, activate by address, move, retitle).
+ * Titles are applied as they come; callers redrawing on every change may
+ * want to rate-limit HS_EVENT_WINDOW_TITLE_V2 themselves.
+ *
+ * Returns:
+ *   1:  The model changed
+ *   0:  Nothing to do (unknown window, already current, other event)
+ *   -1: The event cannot be applied in place (move to a named workspace,
+ *       allocation failure); re-sync from a snapshot
+ */
+HS_EXPORT int hs_model_apply_event(hs_model *model, const hs_event *event);
+
+/* Low-level mutators, as used by hs_model_apply_event (true if changed). */
+HS_EXPORT bool hs_model_insert(hs_model *model, const char *address, const char *app_class,
+                               const char *title, int workspace_id);
+HS_EXPORT bool hs_model_remove(hs_model *model, const char *address);
+HS_EXPORT bool hs_model_touch(hs_model *model, const char *address);
+HS_EXPORT bool hs_model_move(hs_model *model, const char *address, int workspace_id);
+HS_EXPORT bool hs_model_set_title(hs_model *model, const char *address, const char *title);
+
+/* Select the order used by hs_model_at(), hs_model_rows() and hs_model_index_of(). */
+HS_EXPORT int hs_model_set_order(hs_model *model, hs_order order);
+HS_EXPORT hs_order hs_model_get_order(const hs_model *model);
+
+/* Number of windows (0 for NULL). */
+HS_EXPORT size_t hs_model_count(const hs_model *model);
+
+/*
+ * Window at a position of the current order. The client (and its
+ * strings) is overwritten by the next hs_model_at() call on this model.
+ *
+ * Returns:
+ *   Client, or NULL if index is out of range
+ */
+HS_EXPORT const hs_client *hs_model_at(hs_model *model, size_t index);
+
+/*
+ * Copy up to max windows of the current order, starting at first, into a
+ * caller-provided array. String pointers refer to the model's storage.
+ *
+ * Returns:
+ *   Number of rows written
+ */
+HS_EXPORT size_t hs_model_rows(const hs_model *model, size_t first, hs_client *out, size_t max);
+
+/*
+ * Position of a window in the current order.
+ *
+ * Returns:
+ *   Index, or -1 if the address is unknown
+ */
+HS_EXPORT int hs_model_index_of(const hs_model *model, const char *address);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HYPRSWITCHER_H */
@@ -0,0 +1,48 @@
+#!/bin/sh
+# Compare `hyprswitcher --focus-class` with the usual hyprctl + jq pipeline.
+#
+# Usage: scripts/bench-run-or-raise.sh CLASS [RUNS]
+#
+# Both variants focus the most recent window of CLASS, so run it with at
+# least one such window open (focus moves around while it runs). Uses
+# hyperfine when installed, otherwise a plain timing loop.
+
+set -eu
+
+class=${1:?usage: $0 CLASS [RUNS]}
+runs=${2:-200}
+switcher=${HYPRSWITCHER:-hyprswitcher}
+
+for tool in hyprctl jq "$switcher"; do
+    command -v "$tool" >/dev/null 2>&1 || { echo "$tool not found" >&2; exit 1; }
+done
+
+pipeline="addr=\$(hyprctl clients -j | jq -r --arg c '$class' \
+'[.[] | select(.class == \$c)] | sort_by(.focusHistoryID) | .[0].address // empty'); \
+[ -n \"\$addr\" ] && hyprctl dispatch focuswindow address:\$addr >/dev/null"
+oneshot="$switcher --focus-class '$class'"
+
+if command -v hyperfine >/dev/null 2>&1; then
+    exec hyperfine --warmup 10 --runs "$runs" --ignore-failure \
+        --command-name "hyprctl | jq + dispatch" "$pipeline" \
+        --command-name "hyprswitcher --focus-class" "$oneshot"
+fi
+
+now_us() {
+    date +%s%6N
+}
+
+bench() {
+    name=$1
+    cmd=$2
+    i=0
+    while [ "$i" -lt 10 ]; do sh -c "$cmd" >/dev/null 2>&1 || true; i=$((i + 1)); done
+    start=$(now_us)
+    i=0
+    while [ "$i" -lt "$runs" ]; do sh -c "$cmd" >/dev/null 2>&1 || true; i=$((i + 1)); done
+    end=$(now_us)
+    echo "$name: $(( (end - start) / runs )) us/run over $runs runs"
+}
+
+bench "hyprctl | jq + dispatch   " "$pipeline"
+bench "hyprswitcher --focus-class" "$oneshot"
@@ -0,0 +1,158 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "bg_layer.h"
+#include "logger/logger.h"
+
+#include <string.h>
+#include <wayland-client.h>
+#include "viewporter-client-protocol.h"
+#include "single-pixel-buffer-v1-client-protocol.h"
+
+static struct wp_viewporter *s_viewporter = NULL;
+static struct wp_single_pixel_buffer_manager_v1 *s_pixel_manager = NULL;
+static struct wl_subcompositor *s_subcompositor = NULL;
+
+static struct wl_surface *s_content = NULL;
+static struct wl_subsurface *s_subsurface = NULL;
+static struct wp_viewport *s_viewport = NULL;
+
+/* What the parent currently shows, to skip unchanged background updates */
+static struct wl_buffer *s_pixel = NULL;
+static ConfigColor s_pixel_color;
+static int s_width = 0;
+static int s_height = 0;
+static int s_x = -1;
+static int s_y = -1;
+
+bool bg_layer_bind(struct wl_registry *registry, uint32_t name,
+                   const char *interface, uint32_t version) {
+    (void)version;
+    if (strcmp(interface, "wp_viewporter") == 0) {
+        s_viewporter = wl_registry_bind(registry, name, &wp_viewporter_interface, 1);
+        return true;
+    }
+    if (strcmp(interface, "wp_single_pixel_buffer_manager_v1") == 0) {
+        s_pixel_manager = wl_registry_bind(registry, name,
+                                           &wp_single_pixel_buffer_manager_v1_interface, 1);
+        return true;
+    }
+    if (strcmp(interface, "wl_subcompositor") == 0) {
+        s_subcompositor = wl_registry_bind(registry, name, &wl_subcompositor_interface, 1);
+        return true;
+    }
+    return false;
+}
+
+bool bg_layer_attach(struct wl_compositor *compositor, struct wl_surface *parent) {
+    if (!s_viewporter || !s_pixel_manager || !s_subcompositor) {
+        LOG_WARN("[BGLAYER] Compositor lacks %s; drawing the background into the buffer",
+                 !s_viewporter ? "wp_viewporter"
+                 : !s_pixel_manager ? "wp_single_pixel_buffer_manager_v1"
+                 : "wl_subcompositor");
+        return false;
+    }
+
+    s_content = wl_compositor_create_surface(compositor);
+    s_subsurface = wl_subcompositor_get_subsurface(s_subcompositor, s_content, parent);
+    s_viewport = wp_viewporter_get_viewport(s_viewporter, parent);
+    if (!s_content || !s_subsurface || !s_viewport) {
+        LOG_ERROR("[BGLAYER] Failed to create the content subsurface");
+        bg_layer_destroy();
+        return false;
+    }
+
+    /* Synchronized: content commits show up together with the parent's */
+    wl_subsurface_set_sync(s_subsurface);
+
+    /* Keyboard focus stays on the layer surface; the content takes no input */
+    struct wl_region *empty = wl_compositor_create_region(compositor);
+    wl_surface_set_input_region(s_content, empty);
+    wl_region_destroy(empty);
+
+    LOG_INFO("[BGLAYER] Background from a single-pixel buffer, rows in a subsurface");
+    return true;
+}
+
+bool bg_layer_active(void) {
+    return s_content != NULL;
+}
+
+struct wl_surface *bg_layer_content_surface(void) {
+    return s_content;
+}
+
+/* Premultiplied channel scaled to the protocol's full 32-bit range */
+static uint32_t channel_u32(double value, double alpha) {
+    double v = value * alpha;
+    if (v <= 0.0) return 0;
+    if (v >= 1.0) return UINT32_MAX;
+    return (uint32_t)(v * (double)UINT32_MAX);
+}
+
+/* Returns the replaced buffer (or NULL); destroy it after the next commit */
+static struct wl_buffer *pixel_update(const ConfigColor *color, bool *changed) {
+    *changed = false;
+    if (s_pixel && memcmp(&s_pixel_color, color, sizeof(*color)) == 0) {
+        return NULL;
+    }
+    struct wl_buffer *pixel = wp_single_pixel_buffer_manager_v1_create_u32_rgba_buffer(
+        s_pixel_manager,
+        channel_u32(color->r, color->a),
+        channel_u32(color->g, color->a),
+        channel_u32(color->b, color->a),
+        channel_u32(1.0, color->a));
+    if (!pixel) {
+        return NULL;
+    }
+    struct wl_buffer *old = s_pixel;
+    s_pixel = pixel;
+    s_pixel_color = *color;
+    *changed = true;
+    return old;
+}
+
+void bg_layer_commit(struct wl_surface *parent, int x, int y,
+                     int width, int height, const ConfigColor *color) {
+    if (!s_content || !parent) {
+        return;
+    }
+
+    if (x != s_x || y != s_y) {
+        wl_subsurface_set_position(s_subsurface, x, y);
+        s_x = x;
+        s_y = y;
+    }
+
+    bool new_pixel;
+    struct wl_buffer *old_pixel = pixel_update(color, &new_pixel);
+    if (new_pixel) {
+        wl_surface_attach(parent, s_pixel, 0, 0);
+        wl_surface_damage_buffer(parent, 0, 0, 1, 1);
+    }
+    if (new_pixel || width != s_width || height != s_height) {
+        wp_viewport_set_destination(s_viewport, width, height);
+        s_width = width;
+        s_height = height;
+        LOG_DEBUG("[BGLAYER] Background %dx%d", width, height);
+    }
+
+    wl_surface_commit(parent);
+    if (old_pixel) {
+        wl_buffer_destroy(old_pixel);   /* no longer attached */
+    }
+}
+
+void bg_layer_destroy(void) {
+    if (s_viewport) { wp_viewport_destroy(s_viewport); s_viewport = NULL; }
+    if (s_subsurface) { wl_subsurface_destroy(s_subsurface); s_subsurface = NULL; }
+    if (s_content) { wl_surface_destroy(s_content); s_content = NULL; }
+    if (s_pixel) { wl_buffer_destroy(s_pixel); s_pixel = NULL; }
+    if (s_viewporter) { wp_viewporter_destroy(s_viewporter); s_viewporter = NULL; }
+    if (s_pixel_manager) {
+        wp_single_pixel_buffer_manager_v1_destroy(s_pixel_manager);
+        s_pixel_manager = NULL;
+    }
+    if (s_subcompositor) { wl_subcompositor_destroy(s_subcompositor); s_subcompositor = NULL; }
+    s_width = s_height = 0;
+    s_x = s_y = -1;
+}
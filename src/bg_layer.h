@@ -0,0 +1,65 @@
+#pragma once
+/*
+ * bg_layer.h - Solid overlay background without a full-size shm buffer
+ *
+ * With `background_layer=true` the panel background is a single-pixel
+ * buffer (wp_single_pixel_buffer_v1) stretched over the overlay surface by
+ * wp_viewporter, and the rows are drawn into a subsurface buffer that only
+ * covers the content. The compositor fills the background itself, so the
+ * client no longer rasterizes or uploads width x height pixels per frame.
+ *
+ * A single pixel cannot carry rounded corners or a shadow: the panel is a
+ * plain rectangle in this mode. Item decorations are unaffected.
+ *
+ * Main thread only.
+ */
+
+#ifndef BG_LAYER_H
+#define BG_LAYER_H
+
+#include "config.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+struct wl_registry;
+struct wl_compositor;
+struct wl_surface;
+
+/*
+ * Bind wp_viewporter, wp_single_pixel_buffer_manager_v1 or wl_subcompositor
+ * (call from the registry listener for every global).
+ *
+ * Returns:
+ *   true if `interface` was one of them
+ */
+bool bg_layer_bind(struct wl_registry *registry, uint32_t name,
+                   const char *interface, uint32_t version);
+
+/*
+ * Create the content subsurface and the viewport on `parent`.
+ *
+ * Returns:
+ *   true if the layer is active; false if a global is missing, in which
+ *   case the overlay is drawn as one full buffer as before
+ */
+bool bg_layer_attach(struct wl_compositor *compositor, struct wl_surface *parent);
+
+/* Whether bg_layer_attach() succeeded and frames go to the content surface. */
+bool bg_layer_active(void);
+
+/* Surface the row buffers are attached to (NULL when inactive). */
+struct wl_surface *bg_layer_content_surface(void);
+
+/*
+ * Place the content at (x, y), fill the parent with `color` at
+ * width x height and commit the parent, which also applies the content
+ * surface's last commit. The background buffer is only replaced when the
+ * color or size changed.
+ */
+void bg_layer_commit(struct wl_surface *parent, int x, int y,
+                     int width, int height, const ConfigColor *color);
+
+/* Destroy the subsurface, viewport, pixel buffer and bound globals. */
+void bg_layer_destroy(void);
+
+#endif /* BG_LAYER_H */
@@ -0,0 +1,134 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "buffer_pool.h"
+#include "wayland.h"
+#include "logger/logger.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <wayland-client.h>
+
+/* Double buffering plus one spare while the compositor holds two */
+#define POOL_MAX_BUFFERS 3
+
+static PoolBuffer s_buffers[POOL_MAX_BUFFERS];
+static unsigned s_next_serial = 0;
+
+/*
+ * Create an anonymous shared memory file for a Wayland buffer.
+ * Returns file descriptor on success, -1 on failure.
+ */
+static int create_shm_file(size_t size) {
+    char name[] = "/tmp/hyprswitcher-shm-XXXXXX";
+    int fd = mkstemp(name);
+    if (fd < 0) {
+        LOG_ERROR("[POOL] shm mkstemp failed");
+        return -1;
+    }
+    unlink(name);
+
+    if (ftruncate(fd, (off_t)size) < 0) {
+        LOG_ERROR("[POOL] shm ftruncate failed (size=%zu)", size);
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void buffer_release(void *data, struct wl_buffer *buffer) {
+    (void)buffer;
+    PoolBuffer *buf = data;
+    buf->busy = false;
+}
+
+static const struct wl_buffer_listener buffer_listener = {
+    .release = buffer_release,
+};
+
+static void buffer_free(PoolBuffer *buf) {
+    if (buf->buffer) {
+        wl_buffer_destroy(buf->buffer);
+    }
+    if (buf->data) {
+        munmap(buf->data, buf->size);
+    }
+    memset(buf, 0, sizeof(*buf));
+}
+
+static bool buffer_alloc(PoolBuffer *buf, int width, int height) {
+    int stride = width * 4;
+    size_t size = (size_t)stride * (size_t)height;
+
+    int fd = create_shm_file(size);
+    if (fd < 0) {
+        return false;
+    }
+    void *data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED) {
+        LOG_ERROR("[POOL] mmap failed for %dx%d (size=%zu)", width, height, size);
+        close(fd);
+        return false;
+    }
+
+    struct wl_shm_pool *pool = wl_shm_create_pool(get_shm(), fd, (int32_t)size);
+    struct wl_buffer *buffer = wl_shm_pool_create_buffer(pool, 0, width, height, stride,
+                                                         WL_SHM_FORMAT_ARGB8888);
+    wl_shm_pool_destroy(pool);
+    close(fd);   /* the compositor has its own reference */
+
+    buf->buffer = buffer;
+    buf->data = data;
+    buf->size = size;
+    buf->width = width;
+    buf->height = height;
+    buf->stride = stride;
+    buf->busy = false;
+    buf->serial = ++s_next_serial;
+    wl_proxy_set_queue((struct wl_proxy *)buffer, get_render_queue());
+    wl_buffer_add_listener(buffer, &buffer_listener, buf);
+    LOG_DEBUG("[POOL] Allocated %dx%d buffer", width, height);
+    return true;
+}
+
+PoolBuffer *buffer_pool_acquire(int width, int height) {
+    if (width <= 0 || height <= 0 || width > 16384 || height > 16384) {
+        LOG_ERROR("[POOL] Invalid dimensions: %dx%d", width, height);
+        return NULL;
+    }
+
+    /* Prefer a released buffer of the right size, then any free slot */
+    PoolBuffer *spare = NULL;
+    for (size_t i = 0; i < POOL_MAX_BUFFERS; i++) {
+        PoolBuffer *buf = &s_buffers[i];
+        if (buf->busy) {
+            continue;
+        }
+        if (buf->buffer && buf->width == width && buf->height == height) {
+            return buf;
+        }
+        if (!spare || (!spare->buffer && buf->buffer)) {
+            spare = buf;   /* recycle a wrong-sized buffer before growing */
+        }
+    }
+    if (!spare) {
+        LOG_WARN("[POOL] All %d buffers busy; dropping frame", POOL_MAX_BUFFERS);
+        return NULL;
+    }
+
+    buffer_free(spare);
+    return buffer_alloc(spare, width, height) ? spare : NULL;
+}
+
+void buffer_pool_mark_busy(PoolBuffer *buf) {
+    if (buf) {
+        buf->busy = true;
+    }
+}
+
+void buffer_pool_destroy(void) {
+    for (size_t i = 0; i < POOL_MAX_BUFFERS; i++) {
+        buffer_free(&s_buffers[i]);
+    }
+}
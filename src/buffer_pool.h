@@ -0,0 +1,47 @@
+#pragma once
+/*
+ * buffer_pool.h - Reusable wl_shm buffers for the overlay
+ *
+ * Each frame used to create, map and unmap a fresh shm file. The pool keeps
+ * a few mapped buffers alive instead and hands out one the compositor has
+ * released, so a frame costs only the drawing. Buffers are recreated when
+ * the surface size changes.
+ *
+ * Main thread only. Release events arrive on the render queue.
+ */
+
+#ifndef BUFFER_POOL_H
+#define BUFFER_POOL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+struct wl_buffer;
+
+typedef struct {
+    struct wl_buffer *buffer;
+    void *data;              /* Mapped ARGB8888 pixels, stride * height bytes */
+    size_t size;
+    int width;
+    int height;
+    int stride;
+    bool busy;               /* Attached; the compositor has not released it yet */
+    unsigned serial;         /* New whenever the buffer is (re)allocated */
+} PoolBuffer;
+
+/*
+ * Get a buffer of the given size the compositor is not reading. Its
+ * contents are whatever was last drawn into it.
+ *
+ * Returns:
+ *   Buffer, or NULL if every buffer is busy or allocation failed
+ */
+PoolBuffer *buffer_pool_acquire(int width, int height);
+
+/* Record that the buffer was attached and committed. */
+void buffer_pool_mark_busy(PoolBuffer *buf);
+
+/* Destroy all buffers (call before the wl_shm global goes away). */
+void buffer_pool_destroy(void);
+
+#endif /* BUFFER_POOL_H */
@@ -0,0 +1,811 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "client_model.h"
+#include "logger/logger.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+/* One treap per sort order, plus one keyed by address for lookups and
+ * one holding the rows of a frozen session */
+enum {
+    INDEX_ADDRESS = SORT_ORDER_COUNT,
+    INDEX_FROZEN,
+    INDEX_COUNT
+};
+
+typedef struct Entry Entry;
+typedef struct ClassList ClassList;
+
+typedef struct {
+    Entry *left;
+    Entry *right;
+    size_t size;             /* Nodes in this subtree */
+} Link;
+
+struct Entry {
+    HyprClientInfo info;
+    uint64_t mru;            /* Larger = focused more recently; 0 = never seen focused */
+    uint64_t id;             /* Creation sequence, final tie-break */
+    uint64_t seat;           /* Row key while frozen: order at freeze time, then arrival */
+    uint32_t prio;           /* Heap priority, shared by all treaps */
+    uint32_t sync_gen;       /* Last snapshot that listed this window */
+    Link link[INDEX_COUNT];
+    ClassList *cls;          /* Windows of the same app_class (NULL if unindexed) */
+    Entry *class_prev;       /* More recent window of that class */
+    Entry *class_next;       /* Less recent window of that class */
+};
+
+/* Windows of one app_class, most recent first */
+struct ClassList {
+    char *app_class;
+    uint32_t hash;
+    size_t count;
+    Entry *head;
+    Entry *tail;
+    ClassList *chain;        /* Next list in the same hash bucket */
+};
+
+struct ClientModel {
+    Entry *root[INDEX_COUNT];
+    SortOrder order;
+    uint64_t mru_clock;
+    uint64_t next_id;
+    uint32_t sync_gen;
+    uint32_t rng;
+    uint64_t generation;     /* Bumped on every visible change */
+    bool frozen;             /* Rows follow INDEX_FROZEN instead of `order` */
+    uint64_t seat_clock;     /* Last seat handed out */
+    size_t held_reorders;    /* Recency changes not shown because of the freeze */
+    ClassList **classes;     /* app_class -> ClassList hash table */
+    size_t class_buckets;    /* Power of two, or 0 before the first window */
+    size_t class_lists;
+};
+
+/* ============================================================================
+ * Ordering
+ * ============================================================================ */
+
+static uint32_t next_priority(ClientModel *m) {
+    /* xorshift32: priorities only need to be independent of the keys */
+    m->rng ^= m->rng << 13;
+    m->rng ^= m->rng >> 17;
+    m->rng ^= m->rng << 5;
+    return m->rng;
+}
+
+static int compare_mru(const Entry *a, const Entry *b) {
+    if (a->mru != b->mru) return a->mru > b->mru ? -1 : 1;
+    return a->id < b->id ? -1 : (a->id > b->id);
+}
+
+/* Ids compared unsigned: special workspaces (negative) and unknown (-1) sort last */
+static int compare_id(int a, int b) {
+    unsigned ua = (unsigned)a, ub = (unsigned)b;
+    return (ua > ub) - (ua < ub);
+}
+
+static int compare_entries(int index, const Entry *a, const Entry *b) {
+    int c;
+    switch (index) {
+        case SORT_ORDER_CLASS: {
+            const char *ca = a->info.app_class ? a->info.app_class : "";
+            const char *cb = b->info.app_class ? b->info.app_class : "";
+            if ((c = strcasecmp(ca, cb)) != 0) return c;
+            if ((c = strcmp(ca, cb)) != 0) return c;
+            return compare_mru(a, b);
+        }
+        case SORT_ORDER_WORKSPACE:
+            if ((c = compare_id(a->info.workspace_id, b->info.workspace_id)) != 0) return c;
+            return compare_mru(a, b);
+        case SORT_ORDER_MONITOR:
+            if ((c = compare_id(a->info.monitor_id, b->info.monitor_id)) != 0) return c;
+            if ((c = compare_id(a->info.workspace_id, b->info.workspace_id)) != 0) return c;
+            return compare_mru(a, b);
+        case INDEX_ADDRESS:
+            return strcmp(a->info.address, b->info.address);
+        case INDEX_FROZEN:
+            if (a->seat != b->seat) return a->seat < b->seat ? -1 : 1;
+            return a->id < b->id ? -1 : (a->id > b->id);
+        case SORT_ORDER_MRU:
+        default:
+            return compare_mru(a, b);
+    }
+}
+
+/* ============================================================================
+ * Size-Augmented Treap
+ * ============================================================================ */
+
+static size_t tree_size(const Entry *t, int index) {
+    return t ? t->link[index].size : 0;
+}
+
+static void tree_update(Entry *t, int index) {
+    Link *l = &t->link[index];
+    l->size = 1 + tree_size(l->left, index) + tree_size(l->right, index);
+}
+
+/* Split t into entries ordered before key (*lo) and the rest (*hi) */
+static void tree_split(Entry *t, int index, const Entry *key, Entry **lo, Entry **hi) {
+    if (!t) {
+        *lo = *hi = NULL;
+        return;
+    }
+    Link *l = &t->link[index];
+    if (compare_entries(index, t, key) < 0) {
+        tree_split(l->right, index, key, &l->right, hi);
+        *lo = t;
+    } else {
+        tree_split(l->left, index, key, lo, &l->left);
+        *hi = t;
+    }
+    tree_update(t, index);
+}
+
+/* Join two treaps where every entry of lo orders before every entry of hi */
+static Entry *tree_merge(Entry *lo, Entry *hi, int index) {
+    if (!lo) return hi;
+    if (!hi) return lo;
+    if (lo->prio > hi->prio) {
+        lo->link[index].right = tree_merge(lo->link[index].right, hi, index);
+        tree_update(lo, index);
+        return lo;
+    }
+    hi->link[index].left = tree_merge(lo, hi->link[index].left, index);
+    tree_update(hi, index);
+    return hi;
+}
+
+static Entry *tree_insert(Entry *t, int index, Entry *e) {
+    if (!t) {
+        return e;
+    }
+    if (e->prio > t->prio) {
+        tree_split(t, index, e, &e->link[index].left, &e->link[index].right);
+        tree_update(e, index);
+        return e;
+    }
+    Link *l = &t->link[index];
+    if (compare_entries(index, e, t) < 0) {
+        l->left = tree_insert(l->left, index, e);
+    } else {
+        l->right = tree_insert(l->right, index, e);
+    }
+    tree_update(t, index);
+    return t;
+}
+
+/* Remove e, located by its current key (change keys only after erasing) */
+static Entry *tree_erase(Entry *t, int index, const Entry *e) {
+    if (!t) {
+        return NULL;
+    }
+    Link *l = &t->link[index];
+    if (t == e) {
+        return tree_merge(l->left, l->right, index);
+    }
+    if (compare_entries(index, e, t) < 0) {
+        l->left = tree_erase(l->left, index, e);
+    } else {
+        l->right = tree_erase(l->right, index, e);
+    }
+    tree_update(t, index);
+    return t;
+}
+
+static Entry *tree_select(Entry *t, int index, size_t pos) {
+    while (t) {
+        size_t left = tree_size(t->link[index].left, index);
+        if (pos < left) {
+            t = t->link[index].left;
+        } else if (pos == left) {
+            return t;
+        } else {
+            pos -= left + 1;
+            t = t->link[index].right;
+        }
+    }
+    return NULL;
+}
+
+static size_t tree_rank(Entry *t, int index, const Entry *e) {
+    size_t rank = 0;
+    while (t) {
+        size_t left = tree_size(t->link[index].left, index);
+        if (t == e) {
+            return rank + left;
+        }
+        if (compare_entries(index, e, t) < 0) {
+            t = t->link[index].left;
+        } else {
+            rank += left + 1;
+            t = t->link[index].right;
+        }
+    }
+    return rank;
+}
+
+static void tree_collect(Entry *t, int index, Entry **out, size_t *n) {
+    while (t) {
+        tree_collect(t->link[index].left, index, out, n);
+        out[(*n)++] = t;
+        t = t->link[index].right;
+    }
+}
+
+/* ============================================================================
+ * Class Index
+ * ============================================================================ */
+
+static const char *entry_class(const Entry *e) {
+    return e->info.app_class ? e->info.app_class : "";
+}
+
+/* FNV-1a */
+static uint32_t class_hash(const char *s) {
+    uint32_t h = 2166136261u;
+    for (; *s; s++) {
+        h = (h ^ (uint8_t)*s) * 16777619u;
+    }
+    return h;
+}
+
+static ClassList *class_find(const ClientModel *m, const char *app_class, uint32_t hash) {
+    if (m->class_buckets == 0) {
+        return NULL;
+    }
+    ClassList *l = m->classes[hash & (m->class_buckets - 1)];
+    while (l && (l->hash != hash || strcmp(l->app_class, app_class) != 0)) {
+        l = l->chain;
+    }
+    return l;
+}
+
+/* Keep at most one list per bucket on average */
+static bool class_reserve(ClientModel *m) {
+    if (m->class_lists < m->class_buckets) {
+        return true;
+    }
+    size_t buckets = m->class_buckets ? m->class_buckets * 2 : 16;
+    ClassList **table = calloc(buckets, sizeof(*table));
+    if (!table) {
+        return m->class_buckets > 0;   /* keep chaining in the old table */
+    }
+    for (size_t i = 0; i < m->class_buckets; i++) {
+        ClassList *l = m->classes[i];
+        while (l) {
+            ClassList *chain = l->chain;
+            l->chain = table[l->hash & (buckets - 1)];
+            table[l->hash & (buckets - 1)] = l;
+            l = chain;
+        }
+    }
+    free(m->classes);
+    m->classes = table;
+    m->class_buckets = buckets;
+    return true;
+}
+
+/* Add e to its class list at its MRU position, searching from the least recent end */
+static void class_link(ClientModel *m, Entry *e) {
+    const char *app_class = entry_class(e);
+    uint32_t hash = class_hash(app_class);
+    ClassList *l = class_find(m, app_class, hash);
+    if (!l) {
+        l = class_reserve(m) ? calloc(1, sizeof(*l)) : NULL;
+        char *key = l ? strdup(app_class) : NULL;
+        if (!key) {
+            LOG_ERROR("[MODEL] Out of memory indexing class of %s", e->info.address);
+            free(l);
+            e->cls = NULL;
+            return;
+        }
+        l->app_class = key;
+        l->hash = hash;
+        l->chain = m->classes[hash & (m->class_buckets - 1)];
+        m->classes[hash & (m->class_buckets - 1)] = l;
+        m->class_lists++;
+    }
+
+    /* New windows (never focused) belong at the tail, so this is O(1) for them */
+    Entry *prev = l->tail;
+    while (prev && compare_mru(e, prev) < 0) {
+        prev = prev->class_prev;
+    }
+    Entry *next = prev ? prev->class_next : l->head;
+    e->class_prev = prev;
+    e->class_next = next;
+    if (prev) prev->class_next = e; else l->head = e;
+    if (next) next->class_prev = e; else l->tail = e;
+    e->cls = l;
+    l->count++;
+}
+
+static void class_unlink(ClientModel *m, Entry *e) {
+    ClassList *l = e->cls;
+    if (!l) {
+        return;
+    }
+    if (e->class_prev) e->class_prev->class_next = e->class_next; else l->head = e->class_next;
+    if (e->class_next) e->class_next->class_prev = e->class_prev; else l->tail = e->class_prev;
+    e->cls = NULL;
+    e->class_prev = e->class_next = NULL;
+
+    if (--l->count == 0) {
+        ClassList **pp = &m->classes[l->hash & (m->class_buckets - 1)];
+        while (*pp != l) {
+            pp = &(*pp)->chain;
+        }
+        *pp = l->chain;
+        m->class_lists--;
+        free(l->app_class);
+        free(l);
+    }
+}
+
+/* e just became the most recent window: move it to the front of its class */
+static void class_raise(Entry *e) {
+    ClassList *l = e->cls;
+    if (!l || l->head == e) {
+        return;
+    }
+    e->class_prev->class_next = e->class_next;
+    if (e->class_next) e->class_next->class_prev = e->class_prev; else l->tail = e->class_prev;
+    e->class_prev = NULL;
+    e->class_next = l->head;
+    l->head->class_prev = e;
+    l->head = e;
+}
+
+/* Free every class list (the entries are being freed too) */
+static void class_clear(ClientModel *m) {
+    for (size_t i = 0; i < m->class_buckets; i++) {
+        while (m->classes[i]) {
+            ClassList *l = m->classes[i];
+            m->classes[i] = l->chain;
+            free(l->app_class);
+            free(l);
+        }
+    }
+    m->class_lists = 0;
+}
+
+/* ============================================================================
+ * Entries
+ * ============================================================================ */
+
+static Entry *find_entry(const ClientModel *m, const char *address) {
+    Entry *t = m->root[INDEX_ADDRESS];
+    while (t) {
+        int c = strcmp(address, t->info.address);
+        if (c == 0) return t;
+        t = c < 0 ? t->link[INDEX_ADDRESS].left : t->link[INDEX_ADDRESS].right;
+    }
+    return NULL;
+}
+
+static void link_entry(ClientModel *m, Entry *e, int first, int last) {
+    for (int i = first; i <= last; i++) {
+        e->link[i].left = NULL;
+        e->link[i].right = NULL;
+        e->link[i].size = 1;
+        m->root[i] = tree_insert(m->root[i], i, e);
+    }
+}
+
+static void unlink_entry(ClientModel *m, Entry *e, int first, int last) {
+    for (int i = first; i <= last; i++) {
+        m->root[i] = tree_erase(m->root[i], i, e);
+    }
+}
+
+/* Takes ownership of info's strings */
+static Entry *entry_new(ClientModel *m, HyprClientInfo *info) {
+    Entry *e = calloc(1, sizeof(*e));
+    if (!e) {
+        LOG_ERROR("[MODEL] Out of memory adding %s", info->address);
+        hypr_ipc_free_client_info(info);
+        return NULL;
+    }
+    e->info = *info;
+    memset(info, 0, sizeof(*info));
+    e->id = ++m->next_id;
+    e->seat = ++m->seat_clock;   /* new windows join a frozen list at the end */
+    e->prio = next_priority(m);
+    link_entry(m, e, 0, INDEX_COUNT - 1);
+    class_link(m, e);
+    return e;
+}
+
+static void entry_free(Entry *e) {
+    hypr_ipc_free_client_info(&e->info);
+    free(e);
+}
+
+/* Take e out of every index and free it */
+static void entry_destroy(ClientModel *m, Entry *e) {
+    unlink_entry(m, e, 0, INDEX_COUNT - 1);
+    class_unlink(m, e);
+    entry_free(e);
+}
+
+static bool same_string(const char *a, const char *b) {
+    return strcmp(a ? a : "", b ? b : "") == 0;
+}
+
+/* Refresh e from a snapshot entry (takes ownership of info's strings) */
+static void entry_update(ClientModel *m, Entry *e, HyprClientInfo *info) {
+    bool reclass = !same_string(e->info.app_class, info->app_class);
+    bool rekey = reclass ||
+                 e->info.workspace_id != info->workspace_id ||
+                 e->info.monitor_id != info->monitor_id;
+    if (rekey) {
+        unlink_entry(m, e, SORT_ORDER_CLASS, SORT_ORDER_MONITOR);
+    }
+    if (reclass) {
+        class_unlink(m, e);
+    }
+
+    free(e->info.title);
+    free(e->info.app_class);
+    e->info.title = info->title;
+    e->info.app_class = info->app_class;
+    e->info.workspace_id = info->workspace_id;
+    e->info.monitor_id = info->monitor_id;
+    e->info.pid = info->pid;
+    e->info.focused = info->focused;
+    e->info.focusHistoryID = info->focusHistoryID;
+    free(info->address);
+    memset(info, 0, sizeof(*info));
+
+    if (rekey) {
+        link_entry(m, e, SORT_ORDER_CLASS, SORT_ORDER_MONITOR);
+    }
+    if (reclass) {
+        class_link(m, e);
+    }
+}
+
+/*
+ * Move e to a new MRU stamp in every order that depends on it. The stamp
+ * must be newer than every other window's, which keeps the class list
+ * update O(1).
+ */
+static void entry_restamp(ClientModel *m, Entry *e, uint64_t mru) {
+    unlink_entry(m, e, SORT_ORDER_MRU, SORT_ORDER_MONITOR);
+    e->mru = mru;
+    link_entry(m, e, SORT_ORDER_MRU, SORT_ORDER_MONITOR);
+    class_raise(e);
+}
+
+/* Renumber the frozen rows to follow `order` */
+static void reseat(ClientModel *m, int order) {
+    size_t total = client_model_count(m);
+    Entry **all = total > 0 ? malloc(total * sizeof(*all)) : NULL;
+    if (!all) {
+        if (total > 0) {
+            LOG_ERROR("[MODEL] Out of memory freezing %zu windows", total);
+        }
+        return;
+    }
+    size_t n = 0;
+    tree_collect(m->root[order], order, all, &n);
+    m->root[INDEX_FROZEN] = NULL;
+    for (size_t i = 0; i < n; i++) {
+        all[i]->seat = i + 1;
+        link_entry(m, all[i], INDEX_FROZEN, INDEX_FROZEN);
+    }
+    m->seat_clock = n;
+    free(all);
+}
+
+/* Treap the rows are read from */
+static int row_index(const ClientModel *m) {
+    return m->frozen ? INDEX_FROZEN : (int)m->order;
+}
+
+/* ============================================================================
+ * Public API
+ * ============================================================================ */
+
+ClientModel *client_model_new(void) {
+    ClientModel *m = calloc(1, sizeof(*m));
+    if (!m) {
+        LOG_ERROR("[MODEL] Out of memory creating client model");
+        return NULL;
+    }
+    m->order = SORT_ORDER_MRU;
+    m->rng = 0x9e3779b9u;
+    return m;
+}
+
+void client_model_free(ClientModel *m) {
+    if (!m) {
+        return;
+    }
+    client_model_clear(m);
+    free(m->classes);
+    free(m);
+}
+
+void client_model_sync(ClientModel *m, HyprClientInfo *list, size_t count) {
+    uint32_t gen = ++m->sync_gen;
+    Entry **listed = count > 0 ? malloc(count * sizeof(*listed)) : NULL;
+    size_t n_listed = 0;
+    size_t added = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        HyprClientInfo *info = &list[i];
+        Entry *e = info->address ? find_entry(m, info->address) : NULL;
+        if (!info->address || (e && e->sync_gen == gen)) {
+            hypr_ipc_free_client_info(info);   /* no address, or listed twice */
+            continue;
+        }
+        if (e) {
+            entry_update(m, e, info);
+        } else if ((e = entry_new(m, info)) != NULL) {
+            added++;
+        } else {
+            continue;
+        }
+        e->sync_gen = gen;
+        if (listed) {
+            listed[n_listed++] = e;
+        }
+    }
+    free(list);
+
+    /* Drop windows the snapshot no longer lists */
+    size_t total = client_model_count(m);
+    size_t removed = 0;
+    Entry **all = total > 0 ? malloc(total * sizeof(*all)) : NULL;
+    if (all) {
+        size_t n = 0;
+        tree_collect(m->root[INDEX_ADDRESS], INDEX_ADDRESS, all, &n);
+        for (size_t i = 0; i < n; i++) {
+            if (all[i]->sync_gen != gen) {
+                entry_destroy(m, all[i]);
+                removed++;
+            }
+        }
+    }
+
+    /*
+     * Activation events normally keep the stamps in Hyprland's order. Only
+     * if the snapshot disagrees (missed events, new windows) are all
+     * windows restamped from the snapshot order.
+     */
+    bool restamped = false;
+    if (listed && all && n_listed == client_model_count(m)) {
+        size_t n = 0;
+        tree_collect(m->root[SORT_ORDER_MRU], SORT_ORDER_MRU, all, &n);
+        if (memcmp(all, listed, n * sizeof(*all)) != 0) {
+            /* Least recent first, so each new stamp is the newest yet */
+            for (size_t i = n_listed; i-- > 0;) {
+                entry_restamp(m, listed[i], m->mru_clock + n_listed - i);
+            }
+            m->mru_clock += n_listed;
+            restamped = true;
+            if (m->frozen) {
+                m->held_reorders++;
+            }
+        }
+    } else if (total > 0 || count > 0) {
+        LOG_WARN("[MODEL] Could not verify recency order of %zu windows", count);
+    }
+    free(all);
+    free(listed);
+    m->generation++;
+
+    LOG_DEBUG("[MODEL] Synced %zu windows (%zu added, %zu removed%s)",
+              client_model_count(m), added, removed, restamped ? ", restamped" : "");
+}
+
+bool client_model_insert(ClientModel *m, const char *address, const char *app_class,
+                         const char *title, int workspace_id) {
+    if (!address || find_entry(m, address)) {
+        return false;
+    }
+
+    HyprClientInfo info;
+    memset(&info, 0, sizeof(info));
+    info.address = strdup(address);
+    info.title = strdup(title && title[0] ? title : "(untitled)");
+    info.app_class = strdup(app_class ? app_class : "");
+    info.workspace_id = workspace_id;
+    info.monitor_id = -1;
+    info.pid = -1;
+    info.focusHistoryID = -1;
+    if (!info.address || !info.title || !info.app_class) {
+        LOG_ERROR("[MODEL] Out of memory adding %s", address);
+        hypr_ipc_free_client_info(&info);
+        return false;
+    }
+    if (!entry_new(m, &info)) {
+        return false;
+    }
+    m->generation++;
+    return true;
+}
+
+bool client_model_remove(ClientModel *m, const char *address) {
+    Entry *e = address ? find_entry(m, address) : NULL;
+    if (!e) {
+        return false;
+    }
+    entry_destroy(m, e);
+    m->generation++;
+    return true;
+}
+
+bool client_model_touch(ClientModel *m, const char *address) {
+    Entry *e = address ? find_entry(m, address) : NULL;
+    if (!e) {
+        return false;
+    }
+
+    Entry *top = tree_select(m->root[SORT_ORDER_MRU], SORT_ORDER_MRU, 0);
+    if (top == e && e->mru != 0) {
+        if (!e->info.focused) {
+            e->info.focused = true;
+            m->generation++;
+        }
+        return false;
+    }
+    if (top) {
+        top->info.focused = false;
+    }
+    e->info.focused = true;
+    e->info.focusHistoryID = 0;
+    entry_restamp(m, e, ++m->mru_clock);
+    if (m->frozen) {
+        m->held_reorders++;
+    }
+    m->generation++;
+    return true;
+}
+
+bool client_model_move(ClientModel *m, const char *address, int workspace_id) {
+    Entry *e = address ? find_entry(m, address) : NULL;
+    if (!e || e->info.workspace_id == workspace_id) {
+        return false;
+    }
+    unlink_entry(m, e, SORT_ORDER_WORKSPACE, SORT_ORDER_MONITOR);
+    e->info.workspace_id = workspace_id;
+    link_entry(m, e, SORT_ORDER_WORKSPACE, SORT_ORDER_MONITOR);
+    m->generation++;
+    return true;
+}
+
+bool client_model_set_title(ClientModel *m, const char *address, const char *title) {
+    Entry *e = address ? find_entry(m, address) : NULL;
+    if (!e || !title) {
+        return false;
+    }
+    if (!title[0]) {
+        title = "(untitled)";   /* as for windows added by events */
+    }
+    if (same_string(e->info.title, title)) {
+        return false;
+    }
+    char *copy = strdup(title);
+    if (!copy) {
+        LOG_ERROR("[MODEL] Out of memory retitling %s", address);
+        return false;
+    }
+    free(e->info.title);
+    e->info.title = copy;
+    m->generation++;
+    return true;
+}
+
+size_t client_model_count(const ClientModel *m) {
+    return tree_size(m->root[INDEX_ADDRESS], INDEX_ADDRESS);
+}
+
+const HyprClientInfo *client_model_at(const ClientModel *m, size_t index) {
+    int view = row_index(m);
+    Entry *e = tree_select(m->root[view], view, index);
+    return e ? &e->info : NULL;
+}
+
+const HyprClientInfo *client_model_mru_at(const ClientModel *m, size_t index) {
+    Entry *e = tree_select(m->root[SORT_ORDER_MRU], SORT_ORDER_MRU, index);
+    return e ? &e->info : NULL;
+}
+
+int client_model_index_of(const ClientModel *m, const char *address) {
+    Entry *e = address ? find_entry(m, address) : NULL;
+    if (!e) {
+        return -1;
+    }
+    int view = row_index(m);
+    return (int)tree_rank(m->root[view], view, e);
+}
+
+void client_model_set_order(ClientModel *m, SortOrder order) {
+    if (order < 0 || order >= SORT_ORDER_COUNT) {
+        return;
+    }
+    if (order != m->order) {
+        LOG_DEBUG("[MODEL] Order %s -> %s", config_sort_order_name(m->order),
+                  config_sort_order_name(order));
+        m->generation++;
+        if (m->frozen) {
+            reseat(m, order);   /* asked for explicitly, so the rows do move */
+        }
+    }
+    m->order = order;
+}
+
+void client_model_freeze(ClientModel *m, bool frozen) {
+    if (frozen == m->frozen) {
+        return;
+    }
+    if (frozen) {
+        reseat(m, m->order);
+        m->held_reorders = 0;
+    } else {
+        LOG_DEBUG("[MODEL] Thawed; applying %zu held reorders", m->held_reorders);
+        m->generation++;
+    }
+    m->frozen = frozen;
+}
+
+bool client_model_frozen(const ClientModel *m) {
+    return m->frozen;
+}
+
+SortOrder client_model_get_order(const ClientModel *m) {
+    return m->order;
+}
+
+size_t client_model_class_count(const ClientModel *m, const char *address) {
+    Entry *e = address ? find_entry(m, address) : NULL;
+    return e && e->cls ? e->cls->count : 0;
+}
+
+const HyprClientInfo *client_model_class_step(const ClientModel *m, const char *address,
+                                              int direction) {
+    Entry *e = address ? find_entry(m, address) : NULL;
+    if (!e || !e->cls) {
+        return NULL;
+    }
+    Entry *next;
+    if (direction >= 0) {
+        next = e->class_next ? e->class_next : e->cls->head;
+    } else {
+        next = e->class_prev ? e->class_prev : e->cls->tail;
+    }
+    return &next->info;
+}
+
+uint64_t client_model_generation(const ClientModel *m) {
+    return m->generation;
+}
+
+void client_model_clear(ClientModel *m) {
+    size_t total = client_model_count(m);
+    Entry **all = total > 0 ? malloc(total * sizeof(*all)) : NULL;
+    if (all) {
+        size_t n = 0;
+        tree_collect(m->root[INDEX_ADDRESS], INDEX_ADDRESS, all, &n);
+        for (size_t i = 0; i < n; i++) {
+            entry_free(all[i]);
+        }
+        free(all);
+    } else {
+        /* Out of memory: unlink one at a time */
+        while (m->root[INDEX_ADDRESS]) {
+            entry_destroy(m, m->root[INDEX_ADDRESS]);
+        }
+    }
+    memset(m->root, 0, sizeof(m->root));
+    class_clear(m);
+    m->frozen = false;
+    m->seat_clock = 0;
+    m->generation++;
+}
@@ -0,0 +1,177 @@
+#pragma once
+/*
+ * client_model.h - Window list kept in every sort order at once
+ *
+ * Each window lives in one size-augmented treap per sort order (plus one
+ * keyed by address), so switching order is O(1), inserting, removing or
+ * re-focusing a window is O(log n) per order, and index <-> window lookups
+ * for the visible rows are O(log n) without ever re-sorting the list.
+ *
+ * Recency is an MRU stamp per window: snapshots seed it from Hyprland's
+ * focusHistoryID and activation events bump it. Ties in the class,
+ * workspace and monitor orders are broken by recency.
+ *
+ * For the length of a switcher session the rows can be frozen (one more
+ * treap, keyed by the row each window had when frozen): removed windows
+ * leave their row, new ones are appended and recency changes are only
+ * shown after thawing, so rows never jump under the user's selection.
+ *
+ * A hash of app_class -> windows of that class in MRU order is updated
+ * alongside, so stepping through one application's windows never walks
+ * the whole list.
+ *
+ * Returned HyprClientInfo pointers stay valid until that window is
+ * removed or the model is cleared. A model is not thread-safe; the
+ * switcher owns one, and libhyprswitcher hands out others.
+ */
+
+#ifndef CLIENT_MODEL_H
+#define CLIENT_MODEL_H
+
+#include "ipc.h"
+#include "config.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct ClientModel ClientModel;
+
+/*
+ * Create an empty model in MRU order.
+ *
+ * Returns:
+ *   Model, or NULL on allocation failure
+ */
+ClientModel *client_model_new(void);
+
+/* Free the model and every window in it (NULL is ignored). */
+void client_model_free(ClientModel *m);
+
+/*
+ * Reconcile the model with a full snapshot, most recently focused first
+ * (as sorted by hypr_ipc_sort_clients_by_focus). Windows are matched by
+ * address; only changed or new ones are repositioned. Takes ownership of
+ * the list and its strings.
+ */
+void client_model_sync(ClientModel *m, HyprClientInfo *list, size_t count);
+
+/*
+ * Add a window reported by an event, least recent until it is activated.
+ * Unknown fields stay at -1 until the next snapshot.
+ *
+ * Returns:
+ *   true:  Added
+ *   false: Already present or allocation failed
+ */
+bool client_model_insert(ClientModel *m, const char *address, const char *app_class,
+                         const char *title, int workspace_id);
+
+/*
+ * Remove a window.
+ *
+ * Returns:
+ *   true if the window was present
+ */
+bool client_model_remove(ClientModel *m, const char *address);
+
+/*
+ * Mark a window as the active one (most recent in MRU order).
+ *
+ * Returns:
+ *   true if the window is known and its position changed
+ */
+bool client_model_touch(ClientModel *m, const char *address);
+
+/*
+ * Record that a window moved to another workspace.
+ *
+ * Returns:
+ *   true if the window is known and its workspace changed
+ */
+bool client_model_move(ClientModel *m, const char *address, int workspace_id);
+
+/*
+ * Replace a window's title. Titles take no part in any order, so nothing
+ * is repositioned.
+ *
+ * Returns:
+ *   true if the window is known and its title changed
+ */
+bool client_model_set_title(ClientModel *m, const char *address, const char *title);
+
+/* Number of windows. */
+size_t client_model_count(const ClientModel *m);
+
+/*
+ * Window at a position of the current order.
+ *
+ * Returns:
+ *   Window, or NULL if index is out of range
+ */
+const HyprClientInfo *client_model_at(const ClientModel *m, size_t index);
+
+/*
+ * Window at a position of the MRU order, whatever the current order.
+ *
+ * Returns:
+ *   Window, or NULL if index is out of range
+ */
+const HyprClientInfo *client_model_mru_at(const ClientModel *m, size_t index);
+
+/*
+ * Position of a window in the current order.
+ *
+ * Returns:
+ *   Index, or -1 if the address is unknown
+ */
+int client_model_index_of(const ClientModel *m, const char *address);
+
+/* Select the order used by client_model_at() and client_model_index_of(). */
+void client_model_set_order(ClientModel *m, SortOrder order);
+
+/* Current order. */
+SortOrder client_model_get_order(const ClientModel *m);
+
+/*
+ * Freeze the rows in the current order, or thaw them. While frozen,
+ * client_model_at() and client_model_index_of() keep every window on its
+ * row: removals close the gap, new windows are appended, and activation
+ * and snapshot reorders are held until thawing. Changing the order while
+ * frozen re-freezes in the new order; client_model_clear() thaws.
+ */
+void client_model_freeze(ClientModel *m, bool frozen);
+
+/* Whether the rows are frozen. */
+bool client_model_frozen(const ClientModel *m);
+
+/*
+ * Number of windows sharing the app_class of a window.
+ *
+ * Returns:
+ *   Count including the window itself, or 0 if the address is unknown
+ */
+size_t client_model_class_count(const ClientModel *m, const char *address);
+
+/*
+ * Step from a window to the next one of the same app_class in MRU order,
+ * wrapping around: direction >= 0 moves to the next less recently used
+ * window, direction < 0 to the next more recent one. O(log n) to find the
+ * address, O(1) to step.
+ *
+ * Returns:
+ *   Window (the same one if it is alone in its class), or NULL if the
+ *   address is unknown
+ */
+const HyprClientInfo *client_model_class_step(const ClientModel *m, const char *address,
+                                              int direction);
+
+/*
+ * Change counter, bumped whenever a window is added, removed, reordered
+ * or updated, or the order changes. Equal values mean equal contents.
+ */
+uint64_t client_model_generation(const ClientModel *m);
+
+/* Free every window. */
+void client_model_clear(ClientModel *m);
+
+#endif /* CLIENT_MODEL_H */
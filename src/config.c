@@ -6,8 +6,10 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <ctype.h>
 #include <errno.h>
+#include <sys/stat.h>
 
 /* Global configuration instance */
 static SwitcherConfig g_config;
@@ -106,6 +108,33 @@ bool config_parse_color(const char *str, ConfigColor *color) {
     return true;
 }
 
+/* ============================================================================
+ * Sort Order Names
+ * ============================================================================ */
+
+static const char *const s_sort_order_names[SORT_ORDER_COUNT] = {
+    [SORT_ORDER_MRU]       = "mru",
+    [SORT_ORDER_CLASS]     = "class",
+    [SORT_ORDER_WORKSPACE] = "workspace",
+    [SORT_ORDER_MONITOR]   = "monitor",
+};
+
+bool config_parse_sort_order(const char *str, SortOrder *order) {
+    if (!str) return false;
+    for (int i = 0; i < SORT_ORDER_COUNT; i++) {
+        if (strcasecmp(str, s_sort_order_names[i]) == 0) {
+            *order = (SortOrder)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char *config_sort_order_name(SortOrder order) {
+    if (order < 0 || order >= SORT_ORDER_COUNT) return "mru";
+    return s_sort_order_names[order];
+}
+
 /* ============================================================================
  * Configuration Initialization
  * ============================================================================ */
@@ -152,6 +181,12 @@ void config_init_defaults(void) {
     g_config.border_color.b = CONFIG_DEFAULT_BORDER_B;
     g_config.border_color.a = CONFIG_DEFAULT_BORDER_A;
     
+    /* Drop shadow */
+    g_config.shadow_color.r = CONFIG_DEFAULT_SHADOW_R;
+    g_config.shadow_color.g = CONFIG_DEFAULT_SHADOW_G;
+    g_config.shadow_color.b = CONFIG_DEFAULT_SHADOW_B;
+    g_config.shadow_color.a = CONFIG_DEFAULT_SHADOW_A;
+    
     /* Sizing */
     g_config.padding = CONFIG_DEFAULT_PADDING;
     g_config.item_padding_x = CONFIG_DEFAULT_ITEM_PADDING_X;
@@ -162,10 +197,20 @@ void config_init_defaults(void) {
     g_config.border_width_selected = CONFIG_DEFAULT_BORDER_WIDTH_SELECTED;
     g_config.overlay_width = CONFIG_DEFAULT_OVERLAY_WIDTH;
     g_config.max_visible_items = CONFIG_DEFAULT_MAX_VISIBLE_ITEMS;
+    g_config.shadow_size = CONFIG_DEFAULT_SHADOW_SIZE;
+    g_config.background_layer = CONFIG_DEFAULT_BACKGROUND_LAYER;
     
     /* Behavior */
     g_config.show_index = CONFIG_DEFAULT_SHOW_INDEX;
     g_config.center_text = CONFIG_DEFAULT_CENTER_TEXT;
+    g_config.marquee_speed = CONFIG_DEFAULT_MARQUEE_SPEED;
+    g_config.command_ring = CONFIG_DEFAULT_COMMAND_RING;
+    g_config.slo_ms = CONFIG_DEFAULT_SLO_MS;
+    g_config.prepare_timeout_ms = CONFIG_DEFAULT_PREPARE_TIMEOUT_MS;
+    g_config.show_delay_ms = CONFIG_DEFAULT_SHOW_DELAY_MS;
+    g_config.title_update_ms = CONFIG_DEFAULT_TITLE_UPDATE_MS;
+    g_config.window_backend = CONFIG_DEFAULT_WINDOW_BACKEND;
+    g_config.sort_order = CONFIG_DEFAULT_SORT_ORDER;
     
     g_config.loaded = false;
     g_config_initialized = true;
@@ -203,6 +248,50 @@ int config_get_path(char *buf, size_t bufsize) {
     return -1;
 }
 
+/*
+ * Create a directory and any missing parents with the given mode.
+ */
+static int mkdir_parents(char *path, mode_t mode) {
+    for (char *p = path + 1; *p; p++) {
+        if (*p == '/') {
+            *p = '\0';
+            if (mkdir(path, 0755) < 0 && errno != EEXIST) {
+                *p = '/';
+                return -1;
+            }
+            *p = '/';
+        }
+    }
+    if (mkdir(path, mode) < 0 && errno != EEXIST) {
+        return -1;
+    }
+    return 0;
+}
+
+int config_get_state_dir(char *buf, size_t bufsize) {
+    if (!buf || bufsize == 0) {
+        return -1;
+    }
+    
+    int ret = -1;
+    const char *state_home = getenv("XDG_STATE_HOME");
+    const char *home = getenv("HOME");
+    if (state_home && state_home[0] == '/') {
+        ret = snprintf(buf, bufsize, "%s/hyprswitcher", state_home);
+    } else if (home && home[0] != '\0') {
+        ret = snprintf(buf, bufsize, "%s/.local/state/hyprswitcher", home);
+    }
+    if (ret <= 0 || (size_t)ret >= bufsize) {
+        return -1;
+    }
+    
+    if (mkdir_parents(buf, 0700) != 0) {
+        LOG_DEBUG("[CONFIG] Could not create state directory %s: %s", buf, strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
 /* ============================================================================
  * Configuration File Parsing
  * ============================================================================ */
@@ -283,6 +372,9 @@ static void parse_config_line(char *line) {
     else if (strcmp(key, "border_color") == 0) {
         config_parse_color(value, &g_config.border_color);
     }
+    else if (strcmp(key, "shadow_color") == 0) {
+        config_parse_color(value, &g_config.shadow_color);
+    }
     else if (strcmp(key, "padding") == 0) {
         int v = atoi(value);
         if (v >= 0 && v <= 100) g_config.padding = v;
@@ -319,12 +411,56 @@ static void parse_config_line(char *line) {
         int v = atoi(value);
         if (v >= 0 && v <= 50) g_config.max_visible_items = v;
     }
+    else if (strcmp(key, "shadow_size") == 0) {
+        int v = atoi(value);
+        if (v >= 0 && v <= 64) g_config.shadow_size = v;
+    }
+    else if (strcmp(key, "background_layer") == 0) {
+        g_config.background_layer = (strcmp(value, "true") == 0 || strcmp(value, "1") == 0);
+    }
     else if (strcmp(key, "show_index") == 0) {
         g_config.show_index = (strcmp(value, "true") == 0 || strcmp(value, "1") == 0);
     }
     else if (strcmp(key, "center_text") == 0) {
         g_config.center_text = (strcmp(value, "true") == 0 || strcmp(value, "1") == 0);
     }
+    else if (strcmp(key, "marquee_speed") == 0) {
+        int v = atoi(value);
+        if (v >= 0 && v <= 1000) g_config.marquee_speed = v;
+    }
+    else if (strcmp(key, "command_ring") == 0) {
+        g_config.command_ring = (strcmp(value, "true") == 0 || strcmp(value, "1") == 0);
+    }
+    else if (strcmp(key, "slo_ms") == 0) {
+        int v = atoi(value);
+        if (v >= 0 && v <= 10000) g_config.slo_ms = v;
+    }
+    else if (strcmp(key, "prepare_timeout_ms") == 0) {
+        int v = atoi(value);
+        if (v >= 100 && v <= 10000) g_config.prepare_timeout_ms = v;
+    }
+    else if (strcmp(key, "show_delay_ms") == 0) {
+        int v = atoi(value);
+        if (v >= 0 && v <= 2000) g_config.show_delay_ms = v;
+    }
+    else if (strcmp(key, "title_update_ms") == 0) {
+        int v = atoi(value);
+        if (v >= 0 && v <= 5000) g_config.title_update_ms = v;
+    }
+    else if (strcmp(key, "window_backend") == 0) {
+        if (strcmp(value, "toplevel") == 0) {
+            g_config.window_backend = WINDOW_BACKEND_TOPLEVEL;
+        } else if (strcmp(value, "hyprland") == 0) {
+            g_config.window_backend = WINDOW_BACKEND_HYPRLAND;
+        } else {
+            LOG_WARN("[CONFIG] Unknown window_backend '%s'", value);
+        }
+    }
+    else if (strcmp(key, "sort_order") == 0) {
+        if (!config_parse_sort_order(value, &g_config.sort_order)) {
+            LOG_WARN("[CONFIG] Unknown sort_order '%s'", value);
+        }
+    }
     else {
         LOG_DEBUG("[CONFIG] Unknown key: %s", key);
     }
@@ -41,6 +41,21 @@ typedef struct {
     double a;  /* 0.0 - 1.0 */
 } ConfigColor;
 
+/* Source of the window list and window activation */
+typedef enum {
+    WINDOW_BACKEND_HYPRLAND = 0,  /* Hyprland socket IPC (j/clients, dispatch) */
+    WINDOW_BACKEND_TOPLEVEL       /* zwlr_foreign_toplevel_manager_v1 on the Wayland connection */
+} WindowBackend;
+
+/* Order of the window list (see client_model.h) */
+typedef enum {
+    SORT_ORDER_MRU = 0,      /* Most recently focused first */
+    SORT_ORDER_CLASS,        /* Alphabetical by class, then MRU */
+    SORT_ORDER_WORKSPACE,    /* By workspace id, then MRU */
+    SORT_ORDER_MONITOR,      /* By monitor, then workspace, then MRU */
+    SORT_ORDER_COUNT
+} SortOrder;
+
 /* Configuration structure */
 typedef struct {
     /* Font settings */
@@ -53,6 +68,7 @@ typedef struct {
     ConfigColor highlight_bg;    /* Selected item background fill */
     ConfigColor highlight_border;/* Selected item border */
     ConfigColor border_color;    /* Normal item border */
+    ConfigColor shadow_color;    /* Drop shadow around the overlay */
     
     /* Sizing */
     int padding;                 /* Outer padding in pixels */
@@ -64,10 +80,20 @@ typedef struct {
     int border_width_selected;   /* Border width for selected item */
     int overlay_width;           /* Overlay width (0 = auto) */
     int max_visible_items;       /* Maximum items to show (0 = no limit) */
+    int shadow_size;             /* Drop shadow extent, drawn inside the surface (0 = none) */
+    bool background_layer;       /* Compositor-filled square background, rows in a subsurface */
     
     /* Behavior */
     bool show_index;             /* Show item index numbers */
     bool center_text;            /* Center text in items */
+    int marquee_speed;           /* Scroll a cut-off selected title, pixels per second (0 = off) */
+    bool command_ring;           /* Accept helper commands via shared-memory ring */
+    int slo_ms;                  /* Key press to commit budget; slower actions dump the flight recorder (0 = off) */
+    int prepare_timeout_ms;      /* A --prepare instance exits if no Tab arrives within this */
+    int show_delay_ms;           /* Hold Alt this long before the overlay is created (0 = at once) */
+    int title_update_ms;         /* Apply a window's live title at most this often (0 = every change) */
+    WindowBackend window_backend; /* Window list source (falls back to Hyprland IPC) */
+    SortOrder sort_order;        /* Initial window list order (switchable at runtime) */
     
     /* Internal */
     bool loaded;                 /* Whether config was loaded from file */
@@ -129,6 +155,23 @@ int config_load(void);
  */
 bool config_parse_color(const char *str, ConfigColor *color);
 
+/*
+ * Parse a sort order name: "mru", "class", "workspace" or "monitor".
+ *
+ * Returns:
+ *   true:  Parsed successfully
+ *   false: Unknown name (order unchanged)
+ */
+bool config_parse_sort_order(const char *str, SortOrder *order);
+
+/*
+ * Name of a sort order, as accepted by config_parse_sort_order().
+ *
+ * Returns:
+ *   Static string (never NULL)
+ */
+const char *config_sort_order_name(SortOrder order);
+
 /*
  * Get the config file path (for logging/debugging).
  *
@@ -141,6 +184,20 @@ bool config_parse_color(const char *str, ConfigColor *color);
  */
 int config_get_path(char *buf, size_t bufsize);
 
+/*
+ * Get the per-user state directory, creating it (mode 0700) if missing:
+ *   1. $XDG_STATE_HOME/hyprswitcher
+ *   2. ~/.local/state/hyprswitcher
+ *
+ * @param buf     Buffer to write path into
+ * @param bufsize Size of buffer
+ *
+ * Returns:
+ *   0:  Success
+ *   -1: Error (buffer too small, env vars not set or mkdir failed)
+ */
+int config_get_state_dir(char *buf, size_t bufsize);
+
 /* ============================================================================
  * Default Values (can be used for reset)
  * ============================================================================ */
@@ -179,6 +236,11 @@ int config_get_path(char *buf, size_t bufsize);
 #define CONFIG_DEFAULT_BORDER_B      0.45
 #define CONFIG_DEFAULT_BORDER_A      0.60
 
+#define CONFIG_DEFAULT_SHADOW_R      0.0
+#define CONFIG_DEFAULT_SHADOW_G      0.0
+#define CONFIG_DEFAULT_SHADOW_B      0.0
+#define CONFIG_DEFAULT_SHADOW_A      0.50
+
 /* Default sizing */
 #define CONFIG_DEFAULT_PADDING              16
 #define CONFIG_DEFAULT_ITEM_PADDING_X       12
@@ -189,9 +251,19 @@ int config_get_path(char *buf, size_t bufsize);
 #define CONFIG_DEFAULT_BORDER_WIDTH_SELECTED 2
 #define CONFIG_DEFAULT_OVERLAY_WIDTH        600
 #define CONFIG_DEFAULT_MAX_VISIBLE_ITEMS    12
+#define CONFIG_DEFAULT_SHADOW_SIZE          0
+#define CONFIG_DEFAULT_BACKGROUND_LAYER     false
 
 /* Default behavior */
 #define CONFIG_DEFAULT_SHOW_INDEX    false
 #define CONFIG_DEFAULT_CENTER_TEXT   false
+#define CONFIG_DEFAULT_MARQUEE_SPEED 60
+#define CONFIG_DEFAULT_COMMAND_RING  false
+#define CONFIG_DEFAULT_SLO_MS        16
+#define CONFIG_DEFAULT_PREPARE_TIMEOUT_MS 1500
+#define CONFIG_DEFAULT_SHOW_DELAY_MS 0
+#define CONFIG_DEFAULT_TITLE_UPDATE_MS 250
+#define CONFIG_DEFAULT_WINDOW_BACKEND WINDOW_BACKEND_HYPRLAND
+#define CONFIG_DEFAULT_SORT_ORDER    SORT_ORDER_MRU
 
 #endif /* CONFIG_H */
\ No newline at end of file
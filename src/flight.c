@@ -0,0 +1,165 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "flight.h"
+#include "config.h"
+#include "logger/logger.h"
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <sys/stat.h>
+
+#define FLIGHT_RING_SIZE      2048                     /* power of two */
+#define FLIGHT_WINDOW_NS      (5ull * 1000000000ull)   /* history written per dump */
+#define FLIGHT_DUMP_MIN_GAP_NS (10ull * 1000000000ull) /* at most one dump per 10 s */
+#define FLIGHT_DUMP_SLOTS     8                        /* flight-0.txt .. flight-7.txt */
+
+typedef struct {
+    uint64_t start_ns;
+    uint64_t dur_ns;
+    int64_t arg;
+    uint32_t kind;
+} FlightEntry;
+
+static FlightEntry s_ring[FLIGHT_RING_SIZE];
+static atomic_uint_fast64_t s_next = 0;
+
+static int s_slo_ms = CONFIG_DEFAULT_SLO_MS;
+static uint64_t s_action_start = 0;   /* 0 = no action pending */
+static uint64_t s_last_dump = 0;
+
+static const char *s_kind_names[FLIGHT_KIND_COUNT] = {
+    [FLIGHT_KEY]     = "key",
+    [FLIGHT_COMMAND] = "command",
+    [FLIGHT_IPC]     = "ipc",
+    [FLIGHT_EVENTS]  = "events",
+    [FLIGHT_REFRESH] = "refresh",
+    [FLIGHT_RENDER]  = "render",
+    [FLIGHT_COMMIT]  = "commit",
+    [FLIGHT_FOCUS]   = "focus",
+    [FLIGHT_ACTION]  = "action",
+};
+
+void flight_init(int slo_ms) {
+    s_slo_ms = slo_ms;
+}
+
+uint64_t flight_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void flight_record(FlightKind kind, uint64_t start_ns, uint64_t end_ns, int64_t arg) {
+    uint64_t slot = atomic_fetch_add_explicit(&s_next, 1, memory_order_relaxed);
+    FlightEntry *e = &s_ring[slot & (FLIGHT_RING_SIZE - 1)];
+    e->start_ns = start_ns;
+    e->dur_ns = end_ns - start_ns;
+    e->arg = arg;
+    e->kind = (uint32_t)kind;
+}
+
+void flight_span(FlightKind kind, uint64_t start_ns, int64_t arg) {
+    flight_record(kind, start_ns, flight_now(), arg);
+}
+
+void flight_mark(FlightKind kind, int64_t arg) {
+    uint64_t now = flight_now();
+    flight_record(kind, now, now, arg);
+}
+
+void flight_action_begin(FlightKind kind, int64_t arg) {
+    uint64_t now = flight_now();
+    flight_record(kind, now, now, arg);
+    if (s_action_start == 0) {
+        s_action_start = now;
+    }
+}
+
+/*
+ * Pick the dump slot: the first missing file, else the oldest one.
+ */
+static int flight_dump_path(char *buf, size_t bufsize) {
+    char dir[384];
+    if (config_get_state_dir(dir, sizeof(dir)) != 0) {
+        return -1;
+    }
+
+    int best = 0;
+    time_t best_mtime = 0;
+    for (int i = 0; i < FLIGHT_DUMP_SLOTS; i++) {
+        char path[512];
+        struct stat st;
+        snprintf(path, sizeof(path), "%s/flight-%d.txt", dir, i);
+        if (stat(path, &st) != 0) {
+            best = i;
+            break;
+        }
+        if (i == 0 || st.st_mtime < best_mtime) {
+            best = i;
+            best_mtime = st.st_mtime;
+        }
+    }
+    int ret = snprintf(buf, bufsize, "%s/flight-%d.txt", dir, best);
+    return (ret > 0 && (size_t)ret < bufsize) ? 0 : -1;
+}
+
+/*
+ * Write the entries of the last FLIGHT_WINDOW_NS in recording order.
+ * Offsets are relative to the end of the slow action. Entries written by
+ * other threads while we read may be torn; this is a diagnostic aid.
+ */
+static void flight_dump(uint64_t end_ns, uint64_t elapsed_ns) {
+    char path[512];
+    if (flight_dump_path(path, sizeof(path)) != 0) {
+        return;
+    }
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        LOG_WARN("[FLIGHT] Could not write %s", path);
+        return;
+    }
+
+    char when[32];
+    time_t wall = time(NULL);
+    struct tm tm_info;
+    localtime_r(&wall, &tm_info);
+    strftime(when, sizeof(when), "%Y-%m-%d %H:%M:%S", &tm_info);
+
+    fprintf(f, "# hyprswitcher flight recorder, %s\n", when);
+    fprintf(f, "# action took %.3f ms (slo %d ms)\n", elapsed_ns / 1e6, s_slo_ms);
+    fprintf(f, "# %12s %10s  %-8s %s\n", "start_ms", "dur_ms", "kind", "arg");
+
+    uint64_t next = atomic_load_explicit(&s_next, memory_order_acquire);
+    uint64_t first = next > FLIGHT_RING_SIZE ? next - FLIGHT_RING_SIZE : 0;
+    for (uint64_t i = first; i < next; i++) {
+        const FlightEntry *e = &s_ring[i & (FLIGHT_RING_SIZE - 1)];
+        if (e->start_ns + FLIGHT_WINDOW_NS < end_ns || e->kind >= FLIGHT_KIND_COUNT) {
+            continue;
+        }
+        double start_ms = ((double)e->start_ns - (double)end_ns) / 1e6;
+        fprintf(f, "  %12.3f %10.3f  %-8s %lld\n", start_ms, e->dur_ns / 1e6,
+                s_kind_names[e->kind], (long long)e->arg);
+    }
+    fclose(f);
+    LOG_WARN("[FLIGHT] Action took %.1f ms (slo %d ms); recent activity written to %s",
+             elapsed_ns / 1e6, s_slo_ms, path);
+}
+
+void flight_action_end(void) {
+    if (s_action_start == 0) {
+        return;
+    }
+    uint64_t now = flight_now();
+    uint64_t elapsed = now - s_action_start;
+    bool slow = s_slo_ms > 0 && elapsed > (uint64_t)s_slo_ms * 1000000ull;
+    flight_record(FLIGHT_ACTION, s_action_start, now, slow);
+    s_action_start = 0;
+
+    if (slow && (s_last_dump == 0 || now - s_last_dump >= FLIGHT_DUMP_MIN_GAP_NS)) {
+        s_last_dump = now;
+        flight_dump(now, elapsed);
+    }
+}
@@ -0,0 +1,67 @@
+#pragma once
+/*
+ * flight.h - Always-on flight recorder for slow Alt+Tab actions
+ *
+ * Averages do not explain a single stutter. Every interesting step (key
+ * presses, helper commands, Hyprland requests, event batches, client list
+ * refreshes, renders, commits, focus dispatches) is recorded into a fixed
+ * in-memory ring at the cost of a clock read and a few stores. When an
+ * action takes longer than `slo_ms` from the key press (or helper command)
+ * to the commit that shows it, the last few seconds of the ring are written
+ * to $XDG_STATE_HOME/hyprswitcher/flight-N.txt.
+ *
+ * Recording is safe from any thread. Action tracking and dumping happen on
+ * the main loop thread only.
+ */
+
+#ifndef FLIGHT_H
+#define FLIGHT_H
+
+#include <stdint.h>
+
+typedef enum {
+    FLIGHT_KEY = 0,      /* Key press that starts an action (arg = evdev code) */
+    FLIGHT_COMMAND,      /* Helper command received (arg = SwitcherCmdType) */
+    FLIGHT_IPC,          /* Hyprland socket request (span, arg = reply bytes) */
+    FLIGHT_EVENTS,       /* Hyprland event batch (span, arg = events) */
+    FLIGHT_REFRESH,      /* Client list refresh (span, arg = clients) */
+    FLIGHT_RENDER,       /* Frame drawn (span) */
+    FLIGHT_COMMIT,       /* Surface commit */
+    FLIGHT_FOCUS,        /* Focus dispatch (span, arg = 0 on success) */
+    FLIGHT_ACTION,       /* Completed action (span from its start, arg = slow) */
+    FLIGHT_KIND_COUNT
+} FlightKind;
+
+/*
+ * Set the latency budget. 0 disables dumps (recording continues).
+ */
+void flight_init(int slo_ms);
+
+/*
+ * Monotonic timestamp in nanoseconds, for use as a span start.
+ */
+uint64_t flight_now(void);
+
+/*
+ * Record a span that started at `start_ns` and ends now.
+ */
+void flight_span(FlightKind kind, uint64_t start_ns, int64_t arg);
+
+/*
+ * Record an instantaneous event.
+ */
+void flight_mark(FlightKind kind, int64_t arg);
+
+/*
+ * Record an event that starts a user-visible action. The latency clock
+ * keeps running from the earliest action not yet completed.
+ */
+void flight_action_begin(FlightKind kind, int64_t arg);
+
+/*
+ * Complete the pending action (frame committed or focus dispatched). If it
+ * exceeded the budget, dump the recent history (rate limited).
+ */
+void flight_action_end(void);
+
+#endif /* FLIGHT_H */
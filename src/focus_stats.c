@@ -0,0 +1,209 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "focus_stats.h"
+#include "config.h"
+#include "logger/logger.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define STATS_FILE_NAME "focus-stats"
+
+/* A strategy is skipped once it has failed this often with no success */
+#define STATS_MIN_ATTEMPTS_FOR_SKIP 4
+/* Skipped strategies get re-probed once every N skips in case Hyprland changed */
+#define STATS_REPROBE_INTERVAL 32
+/* Counters are halved past this point so old behaviour fades out */
+#define STATS_DECAY_THRESHOLD 256
+
+typedef struct {
+    uint32_t attempts;
+    uint32_t successes;
+    uint32_t skipped;        /* sessions left out since the last attempt */
+    uint32_t latency_us;     /* exponentially smoothed confirmation latency */
+} StrategyStats;
+
+static StrategyStats s_stats[FOCUS_STRATEGY_COUNT];
+static bool s_loaded = false;
+
+/* Default order and prior latency for strategies without samples */
+static const uint32_t s_prior_latency_us[FOCUS_STRATEGY_COUNT] = {
+    [FOCUS_STRATEGY_ADDRESS]     = 5000,
+    [FOCUS_STRATEGY_RAW_ADDRESS] = 6000,
+    [FOCUS_STRATEGY_CLASS]       = 8000,
+    [FOCUS_STRATEGY_TITLE]       = 9000,
+};
+
+const char *focus_strategy_name(FocusStrategy strategy) {
+    switch (strategy) {
+        case FOCUS_STRATEGY_ADDRESS:     return "address";
+        case FOCUS_STRATEGY_RAW_ADDRESS: return "raw";
+        case FOCUS_STRATEGY_CLASS:       return "class";
+        case FOCUS_STRATEGY_TITLE:       return "title";
+        default:                         return "invalid";
+    }
+}
+
+static int stats_path(char *buf, size_t bufsize) {
+    char dir[384];
+    if (config_get_state_dir(dir, sizeof(dir)) != 0) {
+        return -1;
+    }
+    int ret = snprintf(buf, bufsize, "%s/%s", dir, STATS_FILE_NAME);
+    return (ret > 0 && (size_t)ret < bufsize) ? 0 : -1;
+}
+
+/*
+ * Load stats file: one line per strategy,
+ * "name attempts successes latency_us skipped".
+ */
+static void stats_load(void) {
+    s_loaded = true;
+    memset(s_stats, 0, sizeof(s_stats));
+
+    char path[512];
+    if (stats_path(path, sizeof(path)) != 0) {
+        return;
+    }
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        LOG_DEBUG("[FOCUS_STATS] No stats file at %s", path);
+        return;
+    }
+
+    char name[32];
+    unsigned attempts, successes, latency, skipped;
+    while (fscanf(f, "%31s %u %u %u %u", name, &attempts, &successes, &latency, &skipped) == 5) {
+        for (int i = 0; i < FOCUS_STRATEGY_COUNT; i++) {
+            if (strcmp(name, focus_strategy_name((FocusStrategy)i)) == 0) {
+                s_stats[i].attempts = attempts;
+                s_stats[i].successes = successes <= attempts ? successes : attempts;
+                s_stats[i].latency_us = latency;
+                s_stats[i].skipped = skipped;
+            }
+        }
+    }
+    fclose(f);
+    LOG_DEBUG("[FOCUS_STATS] Loaded stats from %s", path);
+}
+
+static bool strategy_known_failing(const StrategyStats *st) {
+    return st->attempts >= STATS_MIN_ATTEMPTS_FOR_SKIP && st->successes == 0;
+}
+
+/*
+ * Expected cost in microseconds: latency divided by a smoothed success rate.
+ */
+static double strategy_cost(int i) {
+    const StrategyStats *st = &s_stats[i];
+    double latency = st->successes > 0 ? st->latency_us : s_prior_latency_us[i];
+    double rate = (st->successes + 1.0) / (st->attempts + 2.0);
+    return latency / rate;
+}
+
+static bool strategy_targets_address(FocusStrategy strategy) {
+    return strategy == FOCUS_STRATEGY_ADDRESS || strategy == FOCUS_STRATEGY_RAW_ADDRESS;
+}
+
+size_t focus_stats_order(FocusStrategy *out) {
+    if (!s_loaded) {
+        stats_load();
+    }
+
+    size_t n = 0;
+    for (int i = 0; i < FOCUS_STRATEGY_COUNT; i++) {
+        StrategyStats *st = &s_stats[i];
+        if (strategy_known_failing(st) && ++st->skipped < STATS_REPROBE_INTERVAL) {
+            continue;
+        }
+        out[n++] = (FocusStrategy)i;
+    }
+
+    /* Everything failing: fall back to the default order */
+    if (n == 0) {
+        for (int i = 0; i < FOCUS_STRATEGY_COUNT; i++) {
+            out[n++] = (FocusStrategy)i;
+        }
+        return n;
+    }
+
+    /* Only the address forms are ranked by expected cost: class: and
+     * title: can pick another window of the same class or title, so they
+     * stay fallbacks, in enum order, behind every address form */
+    size_t ranked = 0;
+    while (ranked < n && strategy_targets_address(out[ranked])) {
+        ranked++;
+    }
+    for (size_t i = 1; i < ranked; i++) {
+        FocusStrategy key = out[i];
+        double key_cost = strategy_cost(key);
+        size_t j = i;
+        while (j > 0 && strategy_cost(out[j - 1]) > key_cost) {
+            out[j] = out[j - 1];
+            j--;
+        }
+        out[j] = key;
+    }
+    return n;
+}
+
+void focus_stats_record(FocusStrategy strategy, bool success, uint64_t latency_us) {
+    if ((int)strategy < 0 || strategy >= FOCUS_STRATEGY_COUNT) {
+        return;
+    }
+    if (!s_loaded) {
+        stats_load();
+    }
+
+    StrategyStats *st = &s_stats[strategy];
+    st->attempts++;
+    st->skipped = 0;
+    if (success) {
+        if (latency_us > UINT32_MAX) latency_us = UINT32_MAX;
+        st->latency_us = st->successes == 0
+            ? (uint32_t)latency_us
+            : (uint32_t)((st->latency_us * 3ull + latency_us) / 4);
+        st->successes++;
+    }
+    if (st->attempts >= STATS_DECAY_THRESHOLD) {
+        st->attempts /= 2;
+        st->successes /= 2;
+    }
+
+    LOG_DEBUG("[FOCUS_STATS] %s: success=%d latency=%lluus (attempts=%u successes=%u avg=%uus)",
+              focus_strategy_name(strategy), success, (unsigned long long)latency_us,
+              st->attempts, st->successes, st->latency_us);
+}
+
+int focus_stats_save(void) {
+    if (!s_loaded) {
+        return 0;
+    }
+
+    char path[512];
+    char tmp[520];
+    if (stats_path(path, sizeof(path)) != 0) {
+        LOG_DEBUG("[FOCUS_STATS] No state directory; stats not saved");
+        return -1;
+    }
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+
+    FILE *f = fopen(tmp, "w");
+    if (!f) {
+        LOG_WARN("[FOCUS_STATS] Could not write %s", tmp);
+        return -1;
+    }
+    for (int i = 0; i < FOCUS_STRATEGY_COUNT; i++) {
+        fprintf(f, "%s %u %u %u %u\n", focus_strategy_name((FocusStrategy)i),
+                s_stats[i].attempts, s_stats[i].successes, s_stats[i].latency_us,
+                s_stats[i].skipped);
+    }
+    if (fclose(f) != 0 || rename(tmp, path) != 0) {
+        LOG_WARN("[FOCUS_STATS] Could not save stats to %s", path);
+        unlink(tmp);
+        return -1;
+    }
+    return 0;
+}
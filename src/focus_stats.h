@@ -0,0 +1,64 @@
+#pragma once
+/*
+ * focus_stats.h - Per-strategy focus statistics persisted across sessions
+ *
+ * hypr_ipc_focus_client() can reach a window through several dispatcher
+ * forms (address:, raw address, class:, title:). Which ones work, and how
+ * quickly the compositor reacts, depends on the Hyprland version. We keep
+ * attempt/success counters and a smoothed confirmation latency for each
+ * strategy and try the cheapest reliable address form first, skipping
+ * strategies that are known to fail. class: and title: may match another
+ * window, so they are only ever fallbacks after the address forms.
+ *
+ * Statistics are stored in $XDG_STATE_HOME/hyprswitcher/focus-stats.
+ */
+
+#ifndef FOCUS_STATS_H
+#define FOCUS_STATS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum {
+    FOCUS_STRATEGY_ADDRESS = 0,   /* focuswindow address:0x... */
+    FOCUS_STRATEGY_RAW_ADDRESS,   /* focuswindow 0x... */
+    FOCUS_STRATEGY_CLASS,         /* focuswindow class:^...$ */
+    FOCUS_STRATEGY_TITLE,         /* focuswindow title:^...$ */
+    FOCUS_STRATEGY_COUNT
+} FocusStrategy;
+
+/*
+ * Fill `out` with the strategies to try, best first: address forms by
+ * expected cost, then class: and title:. Known-failing strategies are
+ * left out unless every strategy is failing.
+ *
+ * @param out Array of at least FOCUS_STRATEGY_COUNT entries
+ *
+ * Returns:
+ *   Number of strategies written
+ */
+size_t focus_stats_order(FocusStrategy *out);
+
+/*
+ * Record the outcome of one strategy attempt.
+ *
+ * @param strategy   Strategy that was tried
+ * @param success    Whether the target window became active
+ * @param latency_us Time from dispatch to confirmation (ignored on failure)
+ */
+void focus_stats_record(FocusStrategy strategy, bool success, uint64_t latency_us);
+
+/*
+ * Write statistics to disk. Called once per focus operation.
+ *
+ * Returns:
+ *   0:  Saved
+ *   -1: Error (logged)
+ */
+int focus_stats_save(void);
+
+/* Human-readable strategy name (also the key used in the stats file). */
+const char *focus_strategy_name(FocusStrategy strategy);
+
+#endif /* FOCUS_STATS_H */
@@ -0,0 +1,273 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "fork_server.h"
+#include "config.h"
+#include "flight.h"
+#include "input.h"
+#include "logger/logger.h"
+
+#include <errno.h>
+#include <fontconfig/fontconfig.h>
+#include <pango/pango.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+/* How long the server waits for a child to listen before answering anyway */
+#define FORK_READY_TIMEOUT_MS 1000
+/* How long a helper waits for the server's answer */
+#define FORK_REQUEST_TIMEOUT_MS 2000
+
+/* One-byte answers to a helper */
+#define REPLY_STARTED 'S'
+#define REPLY_RUNNING 'M'
+
+static volatile sig_atomic_t s_stop = 0;
+
+static void on_stop_signal(int sig) {
+    (void)sig;
+    s_stop = 1;
+}
+
+static void set_signal(int sig, void (*handler)(int)) {
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = handler;
+    sigemptyset(&sa.sa_mask);
+    sigaction(sig, &sa, NULL);   /* no SA_RESTART: poll() returns on SIGTERM */
+}
+
+/* Wait up to timeout_ms for fd to become readable */
+static bool wait_readable(int fd, int timeout_ms) {
+    struct pollfd pfd = { .fd = fd, .events = POLLIN };
+    int rc;
+    do {
+        rc = poll(&pfd, 1, timeout_ms);
+    } while (rc < 0 && errno == EINTR && !s_stop);
+    return rc > 0;
+}
+
+/* ============================================================================
+ * Warm-up
+ * ============================================================================ */
+
+/*
+ * Load fontconfig's configuration and caches and resolve the configured
+ * font once, so the pages Pango needs are mapped before any fork. Plain
+ * fontconfig calls: Pango's own font map may start a thread to do this.
+ */
+static void warm_fonts(void) {
+    uint64_t t0 = flight_now();
+    if (!FcInit()) {
+        LOG_WARN("[FORK] FcInit() failed; sessions load fonts themselves");
+        return;
+    }
+
+    PangoFontDescription *desc = pango_font_description_from_string(config_get()->font);
+    const char *family = pango_font_description_get_family(desc);
+    FcPattern *pattern = FcPatternCreate();
+    if (family) {
+        FcPatternAddString(pattern, FC_FAMILY, (const FcChar8 *)family);
+    }
+    FcConfigSubstitute(NULL, pattern, FcMatchPattern);
+    FcDefaultSubstitute(pattern);
+
+    FcResult result;
+    FcFontSet *fonts = FcFontSort(NULL, pattern, FcTrue, NULL, &result);
+    LOG_INFO("[FORK] Fontconfig ready: %d fonts for \"%s\" (%.1f ms)",
+             fonts ? fonts->nfont : 0, family ? family : "(default)",
+             (double)(flight_now() - t0) / 1e6);
+    if (fonts) {
+        FcFontSetDestroy(fonts);
+    }
+    FcPatternDestroy(pattern);
+    pango_font_description_free(desc);
+}
+
+static void keymap_cache_path(char *buf, size_t bufsize) {
+    char state_dir[384];
+    buf[0] = '\0';
+    if (config_get_state_dir(state_dir, sizeof(state_dir)) == 0) {
+        snprintf(buf, bufsize, "%s/keymap.xkb", state_dir);
+    }
+}
+
+/* ============================================================================
+ * Server
+ * ============================================================================ */
+
+/* Commands that start a session when no main instance is running */
+static bool starts_session(SwitcherCmdType cmd) {
+    switch (cmd) {
+        case SWITCHER_CMD_TYPE_CYCLE:
+        case SWITCHER_CMD_TYPE_CYCLE_BACKWARD:
+        case SWITCHER_CMD_TYPE_PREPARE:
+        case SWITCHER_CMD_TYPE_SORT_MRU:
+        case SWITCHER_CMD_TYPE_SORT_CLASS:
+        case SWITCHER_CMD_TYPE_SORT_WORKSPACE:
+        case SWITCHER_CMD_TYPE_SORT_MONITOR:
+        case SWITCHER_CMD_TYPE_CLASS:
+        case SWITCHER_CMD_TYPE_CLASS_BACKWARD:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/* EPIPE when the helper timed out and left (SIGPIPE is ignored) */
+static void reply(int client_fd, char byte) {
+    if (write(client_fd, &byte, 1) != 1) {
+        LOG_DEBUG("[FORK] Helper left before the answer");
+    }
+}
+
+/*
+ * Answer one helper. Returns 1 in the forked child, 0 in the server.
+ * Requests are served one at a time, so a second helper only gets its
+ * answer once the first session listens and sees it as running.
+ */
+static int serve_request(int listen_fd, int client_fd,
+                         SwitcherCmdType *cmd_out, int *ready_fd_out) {
+    SwitcherCmdType cmd = SWITCHER_CMD_TYPE_NONE;
+    if (wait_readable(client_fd, 200)) {
+        cmd = switcher_ipc_read_command(client_fd);
+    }
+    if (!starts_session(cmd)) {
+        close(client_fd);   /* the helper handles it without us */
+        return 0;
+    }
+    if (switcher_ipc_socket_exists()) {
+        reply(client_fd, REPLY_RUNNING);
+        close(client_fd);
+        return 0;
+    }
+
+    uint64_t t0 = flight_now();
+    int ready[2];
+    if (pipe(ready) != 0) {
+        LOG_ERROR("[FORK] pipe() failed: %s", strerror(errno));
+        close(client_fd);
+        return 0;
+    }
+
+    /* Anything still buffered would be written again by the child */
+    log_flush();
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(ready[0]);
+        close(client_fd);
+        close(listen_fd);
+        set_signal(SIGTERM, SIG_DFL);
+        set_signal(SIGINT, SIG_DFL);
+        set_signal(SIGCHLD, SIG_DFL);
+        set_signal(SIGPIPE, SIG_DFL);
+        /* Sessions rotate the log on their own; never through a shared fd */
+        log_reopen();
+        *cmd_out = cmd;
+        *ready_fd_out = ready[1];
+        return 1;
+    }
+    close(ready[1]);
+    if (pid < 0) {
+        LOG_ERROR("[FORK] fork() failed: %s", strerror(errno));
+        close(ready[0]);
+        close(client_fd);   /* no answer: the helper starts the session itself */
+        return 0;
+    }
+
+    /* A child that fails before listening closes the pipe without a byte;
+     * one that is merely slow still gets the session */
+    char byte;
+    ssize_t n = wait_readable(ready[0], FORK_READY_TIMEOUT_MS) ? read(ready[0], &byte, 1) : -1;
+    bool listening = n == 1;
+    close(ready[0]);
+    if (n != 0) {
+        reply(client_fd, REPLY_STARTED);
+    }
+    close(client_fd);
+    LOG_INFO("[FORK] Session %d %s after %.1f ms", (int)pid,
+             listening ? "listening" : "not listening yet",
+             (double)(flight_now() - t0) / 1e6);
+    return 0;
+}
+
+int fork_server_run(SwitcherCmdType *cmd_out, int *ready_fd_out) {
+    int probe = switcher_ipc_fork_server_connect();
+    if (probe >= 0) {
+        close(probe);
+        LOG_ERROR("[FORK] A fork server is already running");
+        return -1;
+    }
+    int listen_fd = switcher_ipc_fork_server_listen();
+    if (listen_fd < 0) {
+        return -1;
+    }
+
+    set_signal(SIGTERM, on_stop_signal);
+    set_signal(SIGINT, on_stop_signal);
+    set_signal(SIGCHLD, SIG_IGN);   /* sessions are reaped automatically */
+    set_signal(SIGPIPE, SIG_IGN);   /* a helper that gave up must not end the server */
+
+    char keymap_path[512];
+    keymap_cache_path(keymap_path, sizeof(keymap_path));
+    input_preload_keymap(keymap_path);
+    warm_fonts();
+    LOG_INFO("[FORK] Fork server ready (pid %d)", (int)getpid());
+
+    while (!s_stop) {
+        if (!wait_readable(listen_fd, -1)) {
+            continue;
+        }
+        int client_fd;
+        while (!s_stop && (client_fd = switcher_ipc_accept(listen_fd)) >= 0) {
+            /* The previous session may have brought a new keymap, or
+             * rotated the log away from under our descriptor */
+            input_preload_keymap(keymap_path);
+            log_reopen();
+            if (serve_request(listen_fd, client_fd, cmd_out, ready_fd_out) == 1) {
+                return 1;
+            }
+        }
+    }
+
+    switcher_ipc_fork_server_cleanup(listen_fd);
+    LOG_INFO("[FORK] Fork server exiting");
+    return 0;
+}
+
+void fork_server_ready(int ready_fd) {
+    if (ready_fd < 0) {
+        return;
+    }
+    char byte = 1;
+    if (write(ready_fd, &byte, 1) != 1) {
+        LOG_DEBUG("[FORK] Fork server gone before the session listened");
+    }
+    close(ready_fd);
+}
+
+/* ============================================================================
+ * Helper Side
+ * ============================================================================ */
+
+int fork_server_request(const char *command) {
+    int fd = switcher_ipc_fork_server_connect();
+    if (fd < 0) {
+        return FORK_SERVER_NONE;
+    }
+    if (switcher_ipc_send(fd, command) != 0) {
+        close(fd);
+        return FORK_SERVER_NONE;
+    }
+    char byte = 0;
+    bool answered = wait_readable(fd, FORK_REQUEST_TIMEOUT_MS) && read(fd, &byte, 1) == 1;
+    close(fd);
+    if (!answered) {
+        LOG_WARN("[FORK] Fork server did not start a session");
+        return FORK_SERVER_NONE;
+    }
+    return byte == REPLY_RUNNING ? FORK_SERVER_RUNNING : FORK_SERVER_STARTED;
+}
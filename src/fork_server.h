@@ -0,0 +1,56 @@
+#pragma once
+/*
+ * fork_server.h - Pre-initialized process image for per-session instances
+ *
+ * `hyprswitcher --fork-server` (e.g. from exec-once) loads the config,
+ * probes Hyprland's capabilities, loads fontconfig's configuration and
+ * font caches and compiles the keymap cached by the previous session, then
+ * waits on $XDG_RUNTIME_DIR/hyprswitcher/fork-server. When a helper finds
+ * no main instance it asks the fork server instead of starting one itself:
+ * the server forks, and the child becomes the session's main instance
+ * straight away, with everything above already in memory. It only has to
+ * connect to Wayland and draw; there is no exec, dynamic linking, config
+ * parsing or font discovery per session.
+ *
+ * The server stays single-threaded (fork() only keeps the calling thread),
+ * so the IPC worker and ring watcher threads are only ever started by the
+ * children. Each child is a separate process that exits with its session.
+ *
+ * The server reads the config once; restart it after editing the config.
+ */
+
+#ifndef FORK_SERVER_H
+#define FORK_SERVER_H
+
+#include "switcher_ipc.h"
+
+/* fork_server_request() results */
+#define FORK_SERVER_NONE     (-1)   /* no fork server, or it could not start one */
+#define FORK_SERVER_RUNNING  0      /* a main instance is already up: send it the command */
+#define FORK_SERVER_STARTED  1      /* a forked session took the command */
+
+/*
+ * Serve sessions until SIGTERM or SIGINT. Call after config_load(),
+ * hypr_ipc_connect() and hypr_caps_init(), before any thread is started.
+ *
+ * Returns:
+ *   1 in a forked child: *cmd_out is the session's first command and
+ *     *ready_fd_out must be passed to fork_server_ready() once the main
+ *     instance socket listens
+ *   0 when the server stops, -1 if it could not start (logged)
+ */
+int fork_server_run(SwitcherCmdType *cmd_out, int *ready_fd_out);
+
+/* Tell the server the session owns the main socket (closes fd; -1 is a no-op). */
+void fork_server_ready(int ready_fd);
+
+/*
+ * Hand a helper's command to the fork server (waits for the session to
+ * listen).
+ *
+ * Returns:
+ *   FORK_SERVER_STARTED, FORK_SERVER_RUNNING or FORK_SERVER_NONE
+ */
+int fork_server_request(const char *command);
+
+#endif /* FORK_SERVER_H */
@@ -0,0 +1,181 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "hypr_caps.h"
+#include "ipc.h"
+#include "logger/logger.h"
+
+#include <json-c/json.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/stat.h>
+
+#define CAPS_DIR_NAME    "hyprswitcher"
+#define CAPS_FILE_PREFIX "caps-"
+#define CAPS_FORMAT_VERSION 1
+
+/* Everything assumed available until a probe says otherwise */
+static HyprCaps s_caps = {
+    .tag = "unknown",
+    .events_v2 = true,
+    .window_title_v2 = true,
+    .focus_history = true,
+    .address_prefix = true,
+    .probed = false,
+};
+
+const HyprCaps *hypr_caps_get(void) {
+    return &s_caps;
+}
+
+static bool version_at_least(int major, int minor) {
+    if (s_caps.major != major) return s_caps.major > major;
+    return s_caps.minor >= minor;
+}
+
+/*
+ * Build the cache path, creating the runtime directory if needed.
+ */
+static int caps_cache_path(char *buf, size_t bufsize) {
+    const char *xdg = getenv("XDG_RUNTIME_DIR");
+    const char *sig = getenv("HYPRLAND_INSTANCE_SIGNATURE");
+    if (!xdg || !xdg[0] || !sig || !sig[0] || strchr(sig, '/')) {
+        return -1;
+    }
+
+    char dir[256];
+    int ret = snprintf(dir, sizeof(dir), "%s/%s", xdg, CAPS_DIR_NAME);
+    if (ret < 0 || (size_t)ret >= sizeof(dir)) {
+        return -1;
+    }
+    if (mkdir(dir, 0700) < 0 && errno != EEXIST) {
+        return -1;
+    }
+
+    ret = snprintf(buf, bufsize, "%s/%s%s", dir, CAPS_FILE_PREFIX, sig);
+    return (ret > 0 && (size_t)ret < bufsize) ? 0 : -1;
+}
+
+/*
+ * Cache format: KEY=VALUE lines, same shape as the config file.
+ */
+static int caps_load_cache(const char *path) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        return -1;
+    }
+
+    HyprCaps caps = s_caps;
+    int format = 0;
+    char line[128];
+    while (fgets(line, sizeof(line), f)) {
+        line[strcspn(line, "\n")] = '\0';
+        char *eq = strchr(line, '=');
+        if (!eq) continue;
+        *eq = '\0';
+        const char *key = line;
+        const char *value = eq + 1;
+        bool flag = (strcmp(value, "1") == 0);
+
+        if (strcmp(key, "format") == 0)               format = atoi(value);
+        else if (strcmp(key, "tag") == 0)             snprintf(caps.tag, sizeof(caps.tag), "%s", value);
+        else if (strcmp(key, "version") == 0)         sscanf(value, "%d.%d.%d", &caps.major, &caps.minor, &caps.patch);
+        else if (strcmp(key, "events_v2") == 0)       caps.events_v2 = flag;
+        else if (strcmp(key, "window_title_v2") == 0) caps.window_title_v2 = flag;
+        else if (strcmp(key, "focus_history") == 0)   caps.focus_history = flag;
+        else if (strcmp(key, "address_prefix") == 0)  caps.address_prefix = flag;
+    }
+    fclose(f);
+
+    if (format != CAPS_FORMAT_VERSION) {
+        LOG_DEBUG("[CAPS] Ignoring cache with format %d", format);
+        return -1;
+    }
+    caps.probed = true;
+    s_caps = caps;
+    return 0;
+}
+
+static void caps_save_cache(const char *path) {
+    char tmp[300];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+    FILE *f = fopen(tmp, "w");
+    if (!f) {
+        LOG_DEBUG("[CAPS] Could not write cache %s: %s", tmp, strerror(errno));
+        return;
+    }
+    fprintf(f, "format=%d\n", CAPS_FORMAT_VERSION);
+    fprintf(f, "tag=%s\n", s_caps.tag);
+    fprintf(f, "version=%d.%d.%d\n", s_caps.major, s_caps.minor, s_caps.patch);
+    fprintf(f, "events_v2=%d\n", s_caps.events_v2);
+    fprintf(f, "window_title_v2=%d\n", s_caps.window_title_v2);
+    fprintf(f, "focus_history=%d\n", s_caps.focus_history);
+    fprintf(f, "address_prefix=%d\n", s_caps.address_prefix);
+    if (fclose(f) != 0 || rename(tmp, path) != 0) {
+        unlink(tmp);
+    }
+}
+
+/*
+ * Query j/version and derive version-gated features.
+ * Untagged or unparsable builds keep the permissive defaults.
+ */
+static int caps_probe_version(void) {
+    char *resp = NULL;
+    if (hypr_ipc_send_recv("j/version", &resp) != 0) {
+        return -1;
+    }
+    json_object *obj = json_tokener_parse(resp);
+    free(resp);
+    if (!obj) {
+        return -1;
+    }
+
+    json_object *tag = json_object_object_get(obj, "tag");
+    const char *tag_str = tag ? json_object_get_string(tag) : NULL;
+    if (tag_str) {
+        snprintf(s_caps.tag, sizeof(s_caps.tag), "%s", tag_str);
+    }
+    json_object_put(obj);
+
+    const char *v = s_caps.tag;
+    if (*v == 'v') v++;
+    if (sscanf(v, "%d.%d.%d", &s_caps.major, &s_caps.minor, &s_caps.patch) < 2) {
+        LOG_DEBUG("[CAPS] Unparsable version tag '%s'; assuming current features", s_caps.tag);
+        s_caps.major = s_caps.minor = s_caps.patch = 0;
+        return 0;
+    }
+
+    s_caps.events_v2 = version_at_least(0, 22);
+    s_caps.address_prefix = version_at_least(0, 22);
+    s_caps.focus_history = version_at_least(0, 34);
+    s_caps.window_title_v2 = version_at_least(0, 42);
+    return 0;
+}
+
+int hypr_caps_init(void) {
+    char path[320];
+    bool have_path = (caps_cache_path(path, sizeof(path)) == 0);
+
+    if (have_path && caps_load_cache(path) == 0) {
+        LOG_INFO("[CAPS] Loaded cached capabilities for Hyprland %s", s_caps.tag);
+        return 0;
+    }
+
+    if (caps_probe_version() != 0) {
+        LOG_WARN("[CAPS] Capability probe failed; assuming current Hyprland features");
+        return -1;
+    }
+    s_caps.probed = true;
+
+    LOG_INFO("[CAPS] Probed Hyprland %s: events_v2=%d title_v2=%d focus_history=%d address_prefix=%d",
+             s_caps.tag, s_caps.events_v2, s_caps.window_title_v2, s_caps.focus_history,
+             s_caps.address_prefix);
+
+    if (have_path) {
+        caps_save_cache(path);
+    }
+    return 0;
+}
@@ -0,0 +1,51 @@
+#pragma once
+/*
+ * hypr_caps.h - Hyprland capability probe, cached per instance signature
+ *
+ * Different Hyprland versions differ in which events they emit (v2 events),
+ * whether j/clients carries the focus history and which focuswindow
+ * argument forms work. Instead of discovering this by trial on every call,
+ * the main instance probes `j/version` once and caches
+ * the result in:
+ *   $XDG_RUNTIME_DIR/hyprswitcher/caps-$HYPRLAND_INSTANCE_SIGNATURE
+ *
+ * The runtime directory is cleared on logout, and the signature changes
+ * whenever Hyprland restarts, so a cache entry never outlives its instance.
+ */
+
+#ifndef HYPR_CAPS_H
+#define HYPR_CAPS_H
+
+#include <stdbool.h>
+
+typedef struct {
+    char tag[48];            /* Version tag from j/version (e.g. "v0.45.2") */
+    int major;
+    int minor;
+    int patch;
+    bool events_v2;          /* activewindowv2 / openwindow with address */
+    bool window_title_v2;    /* windowtitlev2>>ADDRESS,TITLE */
+    bool focus_history;      /* j/clients carries focusHistoryID */
+    bool address_prefix;     /* focuswindow address:0x... */
+    bool probed;             /* false = defaults, nothing known */
+} HyprCaps;
+
+/*
+ * Load capabilities from the cache or probe Hyprland and cache the result.
+ * Call once at startup, after hypr_ipc_connect().
+ *
+ * Returns:
+ *   0:  Capabilities known (cached or probed)
+ *   -1: Probe failed; permissive defaults are used
+ */
+int hypr_caps_init(void);
+
+/*
+ * Get the current capabilities (permissive defaults before hypr_caps_init).
+ *
+ * Returns:
+ *   Pointer to static capability set (never NULL)
+ */
+const HyprCaps *hypr_caps_get(void);
+
+#endif /* HYPR_CAPS_H */
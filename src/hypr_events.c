@@ -2,6 +2,7 @@
 
 #include "hypr_events.h"
 #include "logger/logger.h"
+#include "text.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -9,6 +10,8 @@
 #include <unistd.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <poll.h>
+#include <time.h>
 #include <sys/socket.h>
 #include <sys/un.h>
 
@@ -76,7 +79,7 @@ int hypr_events_connect(void) {
 /*
  * Parse a single event line in the format "EVENT>>DATA"
  */
-static bool parse_event_line(const char *line, HyprEvent *event) {
+bool hypr_events_parse_line(const char *line, HyprEvent *event) {
     if (!line || !event) {
         return false;
     }
@@ -107,51 +110,28 @@ static bool parse_event_line(const char *line, HyprEvent *event) {
 
     /* Determine event type and parse data */
     if (strcmp(event_name, "openwindow") == 0) {
-        event->type = HYPR_EVENT_OPEN_WINDOW;
         /* Format: ADDRESS,WORKSPACE_ID,CLASS,TITLE */
         /* Example: 5c4fe19a0,1,kitty,Kitty Terminal */
-        char *data_copy = strdup(data);
-        if (data_copy) {
-            char *saveptr;
-            char *token;
-            int field = 0;
-
-            token = strtok_r(data_copy, ",", &saveptr);
-            while (token && field < 4) {
-                switch (field) {
-                    case 0: /* address */
-                        snprintf(event->address, sizeof(event->address), "0x%s", token);
-                        break;
-                    case 1: /* workspace_id */
-                        event->workspace_id = atoi(token);
-                        break;
-                    case 2: /* class */
-                        strncpy(event->window_class, token, sizeof(event->window_class) - 1);
-                        break;
-                    case 3: /* title - may contain commas, so get rest */
-                        strncpy(event->title, token, sizeof(event->title) - 1);
-                        while ((token = strtok_r(NULL, ",", &saveptr)) != NULL) {
-                            size_t cur_len = strlen(event->title);
-                            size_t remaining = sizeof(event->title) - cur_len - 1;
-
-                            if (remaining > 0) {
-                                event->title[cur_len] = ',';
-                                event->title[cur_len + 1] = '\0';
-                                cur_len += 1;
-                                remaining -= 1;
-                            }
-
-                            strncat(event->title, token, remaining);
-                        }
-                        break;
-                }
-                if (field < 3) {
-                    token = strtok_r(NULL, ",", &saveptr);
-                }
-                field++;
-            }
-            free(data_copy);
+        const char *fields[3];
+        const char *p = data;
+        int field = 0;
+        for (; field < 3; field++) {
+            fields[field] = p;
+            p = strchr(p, ',');
+            if (!p) break;
+            p++;
+        }
+        if (field != 3) {
+            return false;
         }
+        event->type = HYPR_EVENT_OPEN_WINDOW;
+        /* p is the title: the rest of the line, commas included */
+        size_t addr_len = (size_t)(fields[1] - fields[0] - 1);
+        snprintf(event->address, sizeof(event->address), "0x%.*s", (int)addr_len, fields[0]);
+        event->workspace_id = atoi(fields[1]);
+        text_sanitize(event->window_class, sizeof(event->window_class),
+                      fields[2], (size_t)(p - fields[2] - 1));
+        text_sanitize(event->title, sizeof(event->title), p, strlen(p));
         LOG_DEBUG("[HYPR_EVENTS] openwindow: addr=%s ws=%d class=%s title=%s",
                   event->address, event->workspace_id, event->window_class, event->title);
 
@@ -164,38 +144,56 @@ static bool parse_event_line(const char *line, HyprEvent *event) {
     } else if (strcmp(event_name, "activewindow") == 0) {
         event->type = HYPR_EVENT_ACTIVE_WINDOW;
         /* Format: CLASS,TITLE */
-        char *data_copy = strdup(data);
-        if (data_copy) {
-            char *comma = strchr(data_copy, ',');
-            if (comma) {
-                *comma = '\0';
-                strncpy(event->window_class, data_copy, sizeof(event->window_class) - 1);
-                strncpy(event->title, comma + 1, sizeof(event->title) - 1);
-            } else {
-                strncpy(event->window_class, data_copy, sizeof(event->window_class) - 1);
-            }
-            free(data_copy);
+        const char *comma = strchr(data, ',');
+        size_t class_len = comma ? (size_t)(comma - data) : strlen(data);
+        text_sanitize(event->window_class, sizeof(event->window_class), data, class_len);
+        if (comma) {
+            text_sanitize(event->title, sizeof(event->title), comma + 1, strlen(comma + 1));
         }
         LOG_DEBUG("[HYPR_EVENTS] activewindow: class=%s title=%s",
                   event->window_class, event->title);
 
+    } else if (strcmp(event_name, "activewindowv2") == 0) {
+        event->type = HYPR_EVENT_ACTIVE_WINDOW_V2;
+        /* Format: ADDRESS (empty when no window is focused) */
+        if (data[0] != '\0') {
+            snprintf(event->address, sizeof(event->address), "0x%s", data);
+        }
+        LOG_DEBUG("[HYPR_EVENTS] activewindowv2: addr=%s", event->address);
+
     } else if (strcmp(event_name, "movewindow") == 0) {
-        event->type = HYPR_EVENT_MOVE_WINDOW;
         /* Format: ADDRESS,WORKSPACE_NAME */
-        char *data_copy = strdup(data);
-        if (data_copy) {
-            char *comma = strchr(data_copy, ',');
-            if (comma) {
-                *comma = '\0';
-                snprintf(event->address, sizeof(event->address), "0x%s", data_copy);
-                /* Try to parse workspace ID from name */
-                event->workspace_id = atoi(comma + 1);
-            }
-            free(data_copy);
+        const char *comma = strchr(data, ',');
+        if (!comma) {
+            return false;
         }
+        event->type = HYPR_EVENT_MOVE_WINDOW;
+        snprintf(event->address, sizeof(event->address), "0x%.*s",
+                 (int)(comma - data), data);
+        /* Try to parse workspace ID from name */
+        event->workspace_id = atoi(comma + 1);
         LOG_DEBUG("[HYPR_EVENTS] movewindow: addr=%s ws=%d",
                   event->address, event->workspace_id);
 
+    } else if (strcmp(event_name, "windowtitle") == 0) {
+        event->type = HYPR_EVENT_WINDOW_TITLE;
+        /* Format: ADDRESS */
+        snprintf(event->address, sizeof(event->address), "0x%s", data);
+        LOG_DEBUG("[HYPR_EVENTS] windowtitle: addr=%s", event->address);
+
+    } else if (strcmp(event_name, "windowtitlev2") == 0) {
+        /* Format: ADDRESS,TITLE (the title may contain commas) */
+        const char *comma = strchr(data, ',');
+        if (!comma) {
+            return false;
+        }
+        event->type = HYPR_EVENT_WINDOW_TITLE_V2;
+        snprintf(event->address, sizeof(event->address), "0x%.*s",
+                 (int)(comma - data), data);
+        text_sanitize(event->title, sizeof(event->title), comma + 1, strlen(comma + 1));
+        LOG_DEBUG("[HYPR_EVENTS] windowtitlev2: addr=%s title=%s",
+                  event->address, event->title);
+
     } else {
         event->type = HYPR_EVENT_UNKNOWN;
         LOG_DEBUG("[HYPR_EVENTS] Unknown event: %s", event_name);
@@ -218,7 +216,7 @@ bool hypr_events_read(int fd, HyprEvent *event) {
     if (newline) {
         /* Extract the line */
         *newline = '\0';
-        bool parsed = parse_event_line(s_event_buffer, event);
+        bool parsed = hypr_events_parse_line(s_event_buffer, event);
 
         /* Shift buffer to remove processed line */
         size_t line_len = newline - s_event_buffer + 1;
@@ -247,7 +245,7 @@ bool hypr_events_read(int fd, HyprEvent *event) {
             newline = strchr(s_event_buffer, '\n');
             if (newline) {
                 *newline = '\0';
-                bool parsed = parse_event_line(s_event_buffer, event);
+                bool parsed = hypr_events_parse_line(s_event_buffer, event);
 
                 size_t line_len = newline - s_event_buffer + 1;
                 size_t remaining = s_buffer_len - line_len;
@@ -279,6 +277,72 @@ bool hypr_events_pending(void) {
     return (s_buffer_len > 0 && strchr(s_event_buffer, '\n') != NULL);
 }
 
+/*
+ * Discard all events that are already available without blocking.
+ */
+void hypr_events_drain(int fd) {
+    if (fd < 0) {
+        return;
+    }
+
+    HyprEvent event;
+    int drained = 0;
+    while (hypr_events_read(fd, &event) || hypr_events_pending()) {
+        drained++;
+    }
+    if (drained > 0) {
+        LOG_DEBUG("[HYPR_EVENTS] Drained %d stale events", drained);
+    }
+}
+
+static long elapsed_ms_since(const struct timespec *start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) * 1000L +
+           (now.tv_nsec - start->tv_nsec) / 1000000L;
+}
+
+/*
+ * Wait for the next activewindowv2 event.
+ */
+int hypr_events_wait_active(int fd, const char *address, int timeout_ms) {
+    if (fd < 0 || !address) {
+        return -1;
+    }
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (;;) {
+        HyprEvent event;
+        bool got = hypr_events_read(fd, &event);
+        if (got && event.type == HYPR_EVENT_ACTIVE_WINDOW_V2) {
+            if (strcmp(event.address, address) == 0) {
+                return 1;
+            }
+            LOG_DEBUG("[HYPR_EVENTS] Expected %s to become active, got %s",
+                      address, event.address[0] ? event.address : "(none)");
+            return 0;
+        }
+        if (got || hypr_events_pending()) {
+            continue;
+        }
+
+        long remaining = timeout_ms - elapsed_ms_since(&start);
+        if (remaining <= 0) {
+            return -1;
+        }
+        struct pollfd pfd = { .fd = fd, .events = POLLIN };
+        int pr = poll(&pfd, 1, (int)remaining);
+        if (pr < 0 && errno != EINTR) {
+            return -1;
+        }
+        if (pr > 0 && (pfd.revents & (POLLERR | POLLHUP))) {
+            return -1;
+        }
+    }
+}
+
 /*
  * Close the event socket and clean up resources.
  */
@@ -303,6 +367,7 @@ const char *hypr_event_type_name(HyprEventType type) {
         case HYPR_EVENT_CLOSE_WINDOW: return "closewindow";
         case HYPR_EVENT_ACTIVE_WINDOW: return "activewindow";
         case HYPR_EVENT_MOVE_WINDOW:  return "movewindow";
+        case HYPR_EVENT_ACTIVE_WINDOW_V2: return "activewindowv2";
         case HYPR_EVENT_UNKNOWN:      return "unknown";
         default:                      return "invalid";
     }
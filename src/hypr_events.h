@@ -7,7 +7,10 @@
  *   - openwindow    : A new window was opened
  *   - closewindow   : A window was closed
  *   - activewindow  : The active window changed
+ *   - activewindowv2: The active window changed (by address)
  *   - movewindow    : A window was moved to another workspace
+ *   - windowtitle   : A window's title changed (address only, pre-0.42)
+ *   - windowtitlev2 : A window's title changed
  *
  * The event socket is located at:
  *   $XDG_RUNTIME_DIR/hypr/$HYPRLAND_INSTANCE_SIGNATURE/.socket2.sock
@@ -33,6 +36,9 @@ typedef enum {
     HYPR_EVENT_CLOSE_WINDOW,
     HYPR_EVENT_ACTIVE_WINDOW,
     HYPR_EVENT_MOVE_WINDOW,
+    HYPR_EVENT_ACTIVE_WINDOW_V2,
+    HYPR_EVENT_WINDOW_TITLE_V2,
+    HYPR_EVENT_WINDOW_TITLE,
     HYPR_EVENT_UNKNOWN
 } HyprEventType;
 
@@ -68,6 +74,19 @@ int hypr_events_connect(void);
  */
 bool hypr_events_read(int fd, HyprEvent *event);
 
+/*
+ * Parse one event line ("EVENT>>DATA", without the newline). Used by
+ * hypr_events_read() and by callers that buffer the socket themselves.
+ *
+ * @param line  NUL-terminated event line
+ * @param event Output structure, reset before parsing
+ *
+ * Returns:
+ *   true:  A known event was parsed into `event`
+ *   false: Malformed line or an event type this module ignores
+ */
+bool hypr_events_parse_line(const char *line, HyprEvent *event);
+
 /*
  * Check if there are more buffered events to read.
  * Call hypr_events_read() in a loop until this returns false.
@@ -78,6 +97,30 @@ bool hypr_events_read(int fd, HyprEvent *event);
  */
 bool hypr_events_pending(void);
 
+/*
+ * Discard all events that are already available without blocking.
+ * Used before dispatching a command whose effect should be observed.
+ *
+ * @param fd Event socket FD from hypr_events_connect()
+ */
+void hypr_events_drain(int fd);
+
+/*
+ * Wait for the next activewindowv2 event.
+ * Other events read while waiting are discarded, so only call this when
+ * the session is about to end (e.g. confirming the final focus).
+ *
+ * @param fd         Event socket FD from hypr_events_connect()
+ * @param address    Expected window address ("0x..." form)
+ * @param timeout_ms Maximum time to wait
+ *
+ * Returns:
+ *   1:  The expected window became active
+ *   0:  A different window became active
+ *   -1: Timeout or socket error
+ */
+int hypr_events_wait_active(int fd, const char *address, int timeout_ms);
+
 /*
  * Close the event socket and clean up resources.
  *
@@ -0,0 +1,235 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "hypr_worker.h"
+#include "logger/logger.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/eventfd.h>
+
+static pthread_t s_thread;
+static pthread_mutex_t s_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t s_cond = PTHREAD_COND_INITIALIZER;
+static bool s_running = false;
+static bool s_stop = false;
+static int s_event_fd = -1;
+
+/* Request sequence numbers (guarded by s_lock) */
+static uint64_t s_requested = 0;
+static uint64_t s_served = 0;
+static bool s_progressive = false;    /* next query posts an early partial list */
+
+/* Finished snapshot waiting for the main loop (guarded by s_lock) */
+static bool s_ready = false;
+static bool s_partial = false;
+static int s_status = 0;
+static HyprClientInfo *s_clients = NULL;
+static size_t s_client_count = 0;
+
+/* Hand a snapshot to the main loop, replacing one it has not taken yet */
+static void post_locked(HyprClientInfo *list, size_t count, int status, bool partial) {
+    if (s_ready) {
+        /* Superseded before the main loop picked it up */
+        hypr_ipc_free_client_infos(s_clients, s_client_count);
+    }
+    s_clients = list;
+    s_client_count = count;
+    s_status = status;
+    s_partial = partial;
+    s_ready = true;
+
+    uint64_t one = 1;
+    if (write(s_event_fd, &one, sizeof(one)) < 0 && errno != EAGAIN) {
+        LOG_WARN("[WORKER] eventfd write failed: %s", strerror(errno));
+    }
+}
+
+static char *dup_or_null(const char *s) {
+    return s ? strdup(s) : NULL;
+}
+
+/* Progressive query: where the current and previous windows are in the reply */
+typedef struct {
+    int current;    /* index of focusHistoryID 0, or -1 */
+    int previous;   /* index of focusHistoryID 1, or -1 */
+    bool posted;
+} EarlyList;
+
+/*
+ * As soon as the stream has produced both the focused and the previously
+ * focused window, post those two: enough for the first frame and for a
+ * single Alt+Tab, while the rest of the reply is still being read.
+ */
+static void early_progress(const HyprClientInfo *list, size_t count, void *user) {
+    EarlyList *early = user;
+    if (early->posted) {
+        return;
+    }
+    int last = (int)count - 1;
+    if (list[last].focusHistoryID == 0) early->current = last;
+    if (list[last].focusHistoryID == 1) early->previous = last;
+    if (early->current < 0 || early->previous < 0) {
+        return;
+    }
+
+    HyprClientInfo *partial = calloc(2, sizeof(*partial));
+    if (!partial) {
+        return;
+    }
+    const int order[2] = { early->current, early->previous };
+    for (size_t i = 0; i < 2; i++) {
+        const HyprClientInfo *src = &list[order[i]];
+        partial[i] = *src;
+        partial[i].address = dup_or_null(src->address);
+        partial[i].title = dup_or_null(src->title);
+        partial[i].app_class = dup_or_null(src->app_class);
+    }
+    early->posted = true;
+
+    pthread_mutex_lock(&s_lock);
+    post_locked(partial, 2, 0, true);
+    pthread_mutex_unlock(&s_lock);
+    LOG_DEBUG("[WORKER] Posted early list after %zu entries", count);
+}
+
+static void *worker_main(void *arg) {
+    (void)arg;
+
+    pthread_mutex_lock(&s_lock);
+    for (;;) {
+        while (!s_stop && s_requested == s_served) {
+            pthread_cond_wait(&s_cond, &s_lock);
+        }
+        if (s_stop) {
+            break;
+        }
+        uint64_t seq = s_requested;
+        bool progressive = s_progressive;
+        s_progressive = false;
+        pthread_mutex_unlock(&s_lock);
+
+        HyprClientInfo *list = NULL;
+        size_t count = 0;
+        EarlyList early = { .current = -1, .previous = -1, .posted = false };
+        int status = hypr_ipc_get_clients_streamed(&list, &count,
+                                                   progressive ? early_progress : NULL,
+                                                   &early);
+        if (status == 0) {
+            hypr_ipc_sort_clients_by_focus(list, count);
+        }
+
+        pthread_mutex_lock(&s_lock);
+        post_locked(list, count, status, false);
+        s_served = seq;
+    }
+    pthread_mutex_unlock(&s_lock);
+    return NULL;
+}
+
+int hypr_worker_start(void) {
+    if (s_running) {
+        return 0;
+    }
+
+    s_event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (s_event_fd < 0) {
+        LOG_WARN("[WORKER] eventfd() failed: %s", strerror(errno));
+        return -1;
+    }
+
+    s_stop = false;
+    int err = pthread_create(&s_thread, NULL, worker_main, NULL);
+    if (err != 0) {
+        LOG_WARN("[WORKER] pthread_create() failed: %s", strerror(err));
+        close(s_event_fd);
+        s_event_fd = -1;
+        return -1;
+    }
+    s_running = true;
+    LOG_DEBUG("[WORKER] IPC worker started (eventfd=%d)", s_event_fd);
+    return 0;
+}
+
+void hypr_worker_stop(void) {
+    if (!s_running) {
+        return;
+    }
+
+    pthread_mutex_lock(&s_lock);
+    s_stop = true;
+    pthread_cond_signal(&s_cond);
+    pthread_mutex_unlock(&s_lock);
+    pthread_join(s_thread, NULL);
+    s_running = false;
+
+    if (s_ready) {
+        hypr_ipc_free_client_infos(s_clients, s_client_count);
+        s_clients = NULL;
+        s_client_count = 0;
+        s_ready = false;
+    }
+    s_progressive = false;
+    close(s_event_fd);
+    s_event_fd = -1;
+    LOG_DEBUG("[WORKER] IPC worker stopped");
+}
+
+int hypr_worker_event_fd(void) {
+    return s_running ? s_event_fd : -1;
+}
+
+void hypr_worker_request_clients(void) {
+    if (!s_running) {
+        return;
+    }
+    pthread_mutex_lock(&s_lock);
+    s_requested++;
+    pthread_cond_signal(&s_cond);
+    pthread_mutex_unlock(&s_lock);
+}
+
+void hypr_worker_request_initial_clients(void) {
+    if (!s_running) {
+        return;
+    }
+    pthread_mutex_lock(&s_lock);
+    s_requested++;
+    s_progressive = true;
+    pthread_cond_signal(&s_cond);
+    pthread_mutex_unlock(&s_lock);
+}
+
+int hypr_worker_take_clients(HyprClientInfo **list_out, size_t *count_out) {
+    if (!s_running) {
+        return 0;
+    }
+
+    uint64_t drained;
+    if (read(s_event_fd, &drained, sizeof(drained)) < 0 && errno != EAGAIN) {
+        LOG_DEBUG("[WORKER] eventfd read failed: %s", strerror(errno));
+    }
+
+    pthread_mutex_lock(&s_lock);
+    if (!s_ready) {
+        pthread_mutex_unlock(&s_lock);
+        return 0;
+    }
+    int status = s_status;
+    bool partial = s_partial;
+    *list_out = s_clients;
+    *count_out = s_client_count;
+    s_clients = NULL;
+    s_client_count = 0;
+    s_ready = false;
+    pthread_mutex_unlock(&s_lock);
+
+    if (status != 0) {
+        return -1;
+    }
+    return partial ? 2 : 1;
+}
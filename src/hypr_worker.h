@@ -0,0 +1,74 @@
+#pragma once
+/*
+ * hypr_worker.h - Hyprland client queries off the main loop thread
+ *
+ * A large j/clients reply takes a while to read and parse, and the main
+ * loop must keep handling keys in the meantime. The worker thread performs
+ * the query, parsing and focus-history sort, then hands the finished
+ * snapshot to the main loop, which is woken through an eventfd.
+ *
+ * Requests are coalesced: asking again while a query is in flight causes
+ * exactly one more query afterwards, and only the newest snapshot is kept.
+ *
+ * The first list of a session can be requested progressively: the reply is
+ * parsed entry by entry, and once the focused and previously focused
+ * windows have streamed in they are posted as a partial snapshot, followed
+ * by the full list when the reply ends.
+ */
+
+#ifndef HYPR_WORKER_H
+#define HYPR_WORKER_H
+
+#include "ipc.h"
+#include <stddef.h>
+
+/*
+ * Start the worker thread.
+ *
+ * Returns:
+ *   0:  Running
+ *   -1: Could not start (callers query synchronously instead)
+ */
+int hypr_worker_start(void);
+
+/*
+ * Stop the worker thread and free any snapshot not yet taken.
+ * Waits for an in-flight query to finish.
+ */
+void hypr_worker_stop(void);
+
+/*
+ * File descriptor that becomes readable when a snapshot is ready.
+ *
+ * Returns:
+ *   eventfd, or -1 if the worker is not running
+ */
+int hypr_worker_event_fd(void);
+
+/*
+ * Ask for a fresh client list. Never blocks on Hyprland.
+ */
+void hypr_worker_request_clients(void);
+
+/*
+ * Like hypr_worker_request_clients(), but post a partial snapshot (the
+ * focused and the previous window, in that order) as soon as both are
+ * parsed, ahead of the full one.
+ */
+void hypr_worker_request_initial_clients(void);
+
+/*
+ * Take the newest finished snapshot, clearing the event fd.
+ * Ownership of the list passes to the caller
+ * (free with hypr_ipc_free_client_infos).
+ *
+ * Returns:
+ *   2:  Partial snapshot taken (see hypr_worker_request_initial_clients);
+ *       the full one follows
+ *   1:  Snapshot taken (sorted by focus history; may be empty)
+ *   0:  No snapshot ready
+ *   -1: The newest query failed
+ */
+int hypr_worker_take_clients(HyprClientInfo **list_out, size_t *count_out);
+
+#endif /* HYPR_WORKER_H */
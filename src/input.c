@@ -3,10 +3,16 @@
 #include <wayland-client.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
+#include <fcntl.h>
 #include <sys/mman.h>
+#include <sys/stat.h>
 #include <xkbcommon/xkbcommon.h>
 #include <ipc.h>
+#include "flight.h"
 
 /*
  * Minimal keyboard input handling:
@@ -20,10 +26,12 @@
  */
 
 static struct wl_keyboard *g_keyboard = NULL;
+static struct wl_event_queue *g_input_queue = NULL; /* NULL = default queue */
 static bool g_alt_down = false;
 static bool g_shift_down = false;
 static bool g_esc_flag = false;
 static bool g_alt_tab_flag = false;
+static bool g_alt_grave_flag = false;      /* one-shot: Alt+` (same-class cycling) */
 static uint32_t g_last_alt_press_time = 0; /* timestamp of last Alt press (wayland time msec) */
 static uint32_t g_last_key_time = 0;       /* timestamp of last key event */
 static uint32_t g_last_leave_time = 0;     /* synthetic counter for leave events */
@@ -36,6 +44,94 @@ static struct xkb_context *g_xkb_ctx = NULL;
 static struct xkb_keymap  *g_xkb_keymap = NULL;
 static struct xkb_state   *g_xkb_state = NULL;
 
+/* Keymap cache: the last keymap text seen and its compiled form */
+static char g_cache_path[512] = "";
+static char *g_cached_text = NULL;
+static size_t g_cached_len = 0;
+static struct xkb_keymap *g_cached_keymap = NULL;
+static struct stat g_cached_stat;
+
+static bool ensure_xkb_context(void) {
+    if (!g_xkb_ctx) {
+        g_xkb_ctx = xkb_context_new(XKB_CONTEXT_NO_FLAGS);
+    }
+    return g_xkb_ctx != NULL;
+}
+
+static void drop_cached_keymap(void) {
+    if (g_cached_keymap) {
+        xkb_keymap_unref(g_cached_keymap);
+        g_cached_keymap = NULL;
+    }
+    free(g_cached_text);
+    g_cached_text = NULL;
+    g_cached_len = 0;
+}
+
+void input_preload_keymap(const char *path) {
+    if (!path || !path[0]) {
+        return;
+    }
+    snprintf(g_cache_path, sizeof(g_cache_path), "%s", path);
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return;   /* written by the first session */
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0 ||
+        (g_cached_keymap && st.st_ino == g_cached_stat.st_ino &&
+         st.st_mtime == g_cached_stat.st_mtime && st.st_size == g_cached_stat.st_size)) {
+        close(fd);
+        return;
+    }
+
+    char *text = malloc((size_t)st.st_size + 1);
+    ssize_t n = text ? read(fd, text, (size_t)st.st_size) : -1;
+    close(fd);
+    if (n != (ssize_t)st.st_size || !ensure_xkb_context()) {
+        free(text);
+        return;
+    }
+    text[n] = '\0';
+
+    uint64_t t0 = flight_now();
+    struct xkb_keymap *keymap = xkb_keymap_new_from_string(
+        g_xkb_ctx, text, XKB_KEYMAP_FORMAT_TEXT_V1, XKB_KEYMAP_COMPILE_NO_FLAGS);
+    if (!keymap) {
+        LOG_WARN("[INPUT] Cached keymap %s does not compile", path);
+        free(text);
+        return;
+    }
+    drop_cached_keymap();
+    g_cached_text = text;
+    g_cached_len = (size_t)n;
+    g_cached_keymap = keymap;
+    g_cached_stat = st;
+    LOG_INFO("[INPUT] Compiled cached keymap (%zu bytes, %.1f ms)",
+             g_cached_len, (double)(flight_now() - t0) / 1e6);
+}
+
+/* Keep the compositor's keymap for the next start */
+static void save_keymap_text(const char *text, size_t len) {
+    if (!g_cache_path[0]) {
+        return;
+    }
+    char tmp[sizeof(g_cache_path) + 8];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", g_cache_path);
+    int fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    if (fd < 0) {
+        return;
+    }
+    bool ok = write(fd, text, len) == (ssize_t)len;
+    close(fd);
+    if (!ok || rename(tmp, g_cache_path) != 0) {
+        unlink(tmp);
+        return;
+    }
+    LOG_DEBUG("[INPUT] Saved keymap to %s", g_cache_path);
+}
+
 /* Helper: update modifier tracking from xkb state */
 static void update_mods_from_state() {
     if (!g_xkb_state) return;
@@ -73,20 +169,30 @@ static void keyboard_keymap(void *data,
         return;
     }
 
-    if (!g_xkb_ctx) {
-        g_xkb_ctx = xkb_context_new(XKB_CONTEXT_NO_FLAGS);
-        if (!g_xkb_ctx) {
-            munmap(map, size);
-            close(fd);
-            return;
-        }
+    if (!ensure_xkb_context()) {
+        munmap(map, size);
+        close(fd);
+        return;
     }
 
-    struct xkb_keymap *keymap = xkb_keymap_new_from_string(
-        g_xkb_ctx,
-        (const char *)map,
-        XKB_KEYMAP_FORMAT_TEXT_V1,
-        XKB_KEYMAP_COMPILE_NO_FLAGS);
+    /* The same keymap as last time is already compiled (fork server) */
+    const char *text = map;
+    size_t len = size;
+    while (len > 0 && text[len - 1] == '\0') len--;
+    struct xkb_keymap *keymap = NULL;
+    if (g_cached_keymap && len == g_cached_len && memcmp(text, g_cached_text, len) == 0) {
+        keymap = xkb_keymap_ref(g_cached_keymap);
+        LOG_DEBUG("[INPUT] Keymap unchanged; using the precompiled one");
+    } else {
+        keymap = xkb_keymap_new_from_string(
+            g_xkb_ctx,
+            text,
+            XKB_KEYMAP_FORMAT_TEXT_V1,
+            XKB_KEYMAP_COMPILE_NO_FLAGS);
+        if (keymap) {
+            save_keymap_text(text, len);
+        }
+    }
 
     munmap(map, size);
     close(fd);
@@ -167,6 +273,8 @@ static void keyboard_key(void *data, struct wl_keyboard *keyboard, uint32_t seri
     if (pressed) {
         bool is_escape = false;
         bool is_tab = false;
+        /* Matched by position (evdev KEY_GRAVE) so Shift and layouts don't matter */
+        bool is_grave = (key == 41);
         if (sym != XKB_KEY_NoSymbol) {
             is_escape = (sym == XKB_KEY_Escape);
             is_tab    = (sym == XKB_KEY_Tab);
@@ -176,14 +284,23 @@ static void keyboard_key(void *data, struct wl_keyboard *keyboard, uint32_t seri
         }
         if (is_escape) {
             g_esc_flag = true;
+            flight_action_begin(FLIGHT_KEY, key);
             LOG_DEBUG("[INPUT] ESC pressed (sym=%u focus=%d alt_down=%d)", sym, g_has_focus, g_alt_down);
         } else if (is_tab) {
             update_mods_from_state();
             LOG_DEBUG("[INPUT] Tab pressed (sym=%u focus=%d alt_down=%d)", sym, g_has_focus, g_alt_down);
             if (g_alt_down) {
                 g_alt_tab_flag = true;
+                flight_action_begin(FLIGHT_KEY, key);
                 LOG_DEBUG("[INPUT] Alt+Tab chord detected (sym=%u focus=%d)", sym, g_has_focus);
             }
+        } else if (is_grave) {
+            update_mods_from_state();
+            if (g_alt_down) {
+                g_alt_grave_flag = true;
+                flight_action_begin(FLIGHT_KEY, key);
+                LOG_DEBUG("[INPUT] Alt+` chord detected (sym=%u focus=%d)", sym, g_has_focus);
+            }
         } else {
             if (sym != XKB_KEY_NoSymbol) {
                 char name[64] = {0};
@@ -209,6 +326,7 @@ static void keyboard_key(void *data, struct wl_keyboard *keyboard, uint32_t seri
         if (is_alt_release) {
             g_alt_down = false;
             g_alt_release_flag = true;
+            flight_action_begin(FLIGHT_KEY, key);
             LOG_DEBUG("[INPUT] Alt released (sym=%u focus=%d)", sym, g_has_focus);
         }
     }
@@ -256,6 +374,10 @@ static const struct wl_keyboard_listener g_keyboard_listener = {
     .repeat_info = keyboard_repeat_info
 };
 
+void input_set_event_queue(struct wl_event_queue *queue) {
+    g_input_queue = queue;
+}
+
 void input_handle_seat(struct wl_seat *seat) {
     if (!seat) return;
 
@@ -270,6 +392,9 @@ void input_handle_seat(struct wl_seat *seat) {
         LOG_WARN("[INPUT] Failed to get wl_keyboard from seat");
         return;
     }
+    if (g_input_queue) {
+        wl_proxy_set_queue((struct wl_proxy *)g_keyboard, g_input_queue);
+    }
     wl_keyboard_add_listener(g_keyboard, &g_keyboard_listener, NULL);
     LOG_INFO("[INPUT] Keyboard listener attached.");
 }
@@ -326,9 +451,19 @@ bool input_alt_tab_triggered(void) {
     return false;
 }
 
+bool input_alt_grave_triggered(void) {
+    if (g_alt_grave_flag) {
+        g_alt_grave_flag = false;
+        LOG_DEBUG("[INPUT] alt+grave flag consumed");
+        return true;
+    }
+    return false;
+}
+
 void input_clear_flags(void) {
     g_esc_flag = false;
     g_alt_tab_flag = false;
+    g_alt_grave_flag = false;
     g_focus_lost_flag = false;
     g_alt_release_flag = false;
     g_shift_down = false;
@@ -347,6 +482,7 @@ void input_shutdown(void) {
         xkb_keymap_unref(g_xkb_keymap);
         g_xkb_keymap = NULL;
     }
+    drop_cached_keymap();
     if (g_xkb_ctx) {
         xkb_context_unref(g_xkb_ctx);
         g_xkb_ctx = NULL;
@@ -33,6 +33,9 @@
 #include <wayland-client.h>
 #include "wlr-layer-shell-unstable-v1-client-protocol.h"
 
+/* Route keyboard events to a dedicated queue. Call before input_handle_seat(). */
+void input_set_event_queue(struct wl_event_queue *queue);
+
 /* Attach keyboard listener to a seat. Call once when wl_seat is discovered. */
 void input_handle_seat(struct wl_seat *seat);
 
@@ -54,8 +57,19 @@ bool input_escape_pressed(void);
 /* Returns true exactly once per Alt+Tab chord (Alt is down when Tab pressed). */
 bool input_alt_tab_triggered(void);
 
+/* Returns true exactly once per Alt+` chord (the key above Tab, whatever it produces). */
+bool input_alt_grave_triggered(void);
+
 /* Clear both Escape and Alt+Tab flags manually (optional). */
 void input_clear_flags(void);
 
+/*
+ * Compile the keymap cached at path ahead of time, and remember path:
+ * a compositor keymap with the same text then needs no compilation, and
+ * a different one is written back to path. Cheap to call again: the file
+ * is only recompiled when it changed.
+ */
+void input_preload_keymap(const char *path);
+
 /* Release resources (keyboard object) and clear internal state. */
 void input_shutdown(void);
\ No newline at end of file
@@ -6,12 +6,19 @@
 #include <json-c/json.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <unistd.h>
 #include <string.h>
 #include <poll.h>
 #include <fcntl.h>
 #include <errno.h>
+#include <time.h>
 #include <logger/logger.h>
+#include "hypr_events.h"
+#include "focus_stats.h"
+#include "hypr_caps.h"
+#include "text.h"
+#include "flight.h"
 
 static int hypr_open_socket(void) {
     const char *xdg = getenv("XDG_RUNTIME_DIR");
@@ -43,9 +50,18 @@ static int hypr_open_socket(void) {
     return fd;
 }
 
-int hypr_ipc_send_recv(const char *cmd, char **out_json) {
-    if (!cmd || !out_json) return -1;
-
+/*
+ * Reply consumer for query_stream(): called with each chunk as it is read.
+ * Returns 1 once the reply is complete, 0 for more data, -1 on error.
+ */
+typedef int (*ReplySink)(const char *data, size_t len, void *user);
+
+/*
+ * Send a request and feed the reply to `sink` as it arrives.
+ * Returns 0 once the sink reports completion, -1 on error.
+ */
+static int query_stream(const char *cmd, ReplySink sink, void *user, size_t *bytes_out) {
+    *bytes_out = 0;
     int fd = hypr_open_socket();
     if (fd < 0) return -1;
 
@@ -64,81 +80,103 @@ int hypr_ipc_send_recv(const char *cmd, char **out_json) {
 
     struct pollfd pfd = { .fd = fd, .events = POLLIN };
     int timeout_ms = 3000;
-
-    /* Incremental JSON parsing: stop as soon as a full JSON document is parsed */
-    json_tokener *tok = json_tokener_new();
-    if (!tok) {
-        close(fd);
-        return -1;
-    }
-    json_object *obj = NULL;
+    int rc = -1;
 
     for (;;) {
         int pr = poll(&pfd, 1, timeout_ms);
         if (pr < 0) {
             if (errno == EINTR) continue;
             LOG_DEBUG("[IPC] poll() failed\n");
-            json_tokener_free(tok);
-            close(fd);
-            return -1;
+            goto out;
         } else if (pr == 0) {
             LOG_DEBUG("[IPC] read timeout\n");
-            json_tokener_free(tok);
-            close(fd);
-            return -1;
+            goto out;
         }
 
         for (;;) {
             char tmp[4096];
             ssize_t r = read(fd, tmp, sizeof(tmp));
             if (r > 0) {
-                obj = json_tokener_parse_ex(tok, tmp, (int)r);
-                enum json_tokener_error jerr = json_tokener_get_error(tok);
-                if (obj && jerr == json_tokener_success) {
-                    /* We have a complete JSON object; stop reading */
-                    goto got_json;
-                }
-                if (jerr == json_tokener_continue) {
-                    /* Need more data; try reading again without polling */
-                    continue;
-                }
-                if (jerr != json_tokener_success) {
-                    LOG_DEBUG("[IPC] JSON parse error: %s\n", json_tokener_error_desc(jerr));
-                    json_tokener_free(tok);
-                    close(fd);
-                    return -1;
+                *bytes_out += (size_t)r;
+                int sr = sink(tmp, (size_t)r, user);
+                if (sr != 0) {
+                    /* Complete (stop reading) or malformed */
+                    rc = sr > 0 ? 0 : -1;
+                    goto out;
                 }
+                /* Need more data; try reading again without polling */
             } else if (r == 0) {
-                /* EOF reached before full JSON parsed */
-                break;
-            } else {
-                if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                    /* Back to poll for more data */
-                    break;
-                } else if (errno == EINTR) {
-                    continue;
-                } else {
-                    LOG_DEBUG("[IPC] read() failed\n");
-                    json_tokener_free(tok);
-                    close(fd);
-                    return -1;
-                }
+                LOG_DEBUG("[IPC] EOF before the reply was complete\n");
+                goto out;
+            } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;   /* back to poll for more data */
+            } else if (errno != EINTR) {
+                LOG_DEBUG("[IPC] read() failed\n");
+                goto out;
             }
         }
-        /* loop to poll again */
     }
 
-got_json:
+out:
     close(fd);
-    const char *js = json_object_to_json_string_ext(obj, JSON_C_TO_STRING_PLAIN);
-    if (!js) {
-        json_object_put(obj);
-        json_tokener_free(tok);
-        return -1;
+    return rc;
+}
+
+/* Incremental JSON parsing: complete as soon as one full document is parsed */
+typedef struct {
+    json_tokener *tok;
+    json_object *obj;
+} JsonSink;
+
+static int json_sink(const char *data, size_t len, void *user) {
+    JsonSink *js = user;
+    js->obj = json_tokener_parse_ex(js->tok, data, (int)len);
+    enum json_tokener_error jerr = json_tokener_get_error(js->tok);
+    if (js->obj && jerr == json_tokener_success) {
+        return 1;
+    }
+    if (jerr == json_tokener_continue) {
+        return 0;
     }
-    char *dup = strdup(js);
+    LOG_DEBUG("[IPC] JSON parse error: %s\n", json_tokener_error_desc(jerr));
+    return -1;
+}
+
+/*
+ * Send a request and parse the JSON reply incrementally as it arrives.
+ * Returns the parsed document (caller puts it) or NULL on error.
+ */
+static json_object *query_json(const char *cmd, size_t *bytes_out) {
+    JsonSink js = { .tok = json_tokener_new(), .obj = NULL };
+    if (!js.tok) {
+        *bytes_out = 0;
+        return NULL;
+    }
+    if (query_stream(cmd, json_sink, &js, bytes_out) != 0 && js.obj) {
+        json_object_put(js.obj);
+        js.obj = NULL;
+    }
+    json_tokener_free(js.tok);
+    return js.obj;
+}
+
+/* query_json() with the request recorded as a flight recorder span */
+static json_object *query_json_recorded(const char *cmd) {
+    uint64_t start = flight_now();
+    size_t bytes = 0;
+    json_object *obj = query_json(cmd, &bytes);
+    flight_span(FLIGHT_IPC, start, obj ? (int64_t)bytes : -1);
+    return obj;
+}
+
+int hypr_ipc_send_recv(const char *cmd, char **out_json) {
+    if (!cmd || !out_json) return -1;
+
+    json_object *obj = query_json_recorded(cmd);
+    if (!obj) return -1;
+    const char *js = json_object_to_json_string_ext(obj, JSON_C_TO_STRING_PLAIN);
+    char *dup = js ? strdup(js) : NULL;
     json_object_put(obj);
-    json_tokener_free(tok);
     if (!dup) return -1;
     *out_json = dup;
     return 0;
@@ -176,6 +214,20 @@ static char *dup_json_string_field(json_object *obj, const char *key) {
     return s ? strdup(s) : NULL;
 }
 
+/* Like dup_json_string_field(), normalized for display (see text.h) */
+static char *dup_json_text_field(json_object *obj, const char *key) {
+    if (!obj || !key) return NULL;
+    json_object *v = json_object_object_get(obj, key);
+    if (!v) return NULL;
+    const char *s = json_object_get_string(v);
+    if (!s) return NULL;
+    char buf[TEXT_MAX_BYTES + 1];
+    size_t len = text_sanitize(buf, sizeof(buf), s, (size_t)json_object_get_string_len(v));
+    char *copy = malloc(len + 1);
+    if (copy) memcpy(copy, buf, len + 1);
+    return copy;
+}
+
 static int get_workspace_id_from_client(json_object *c) {
     int ws_id = -1;
     if (!c) return -1;
@@ -204,23 +256,54 @@ void hypr_ipc_free_client_info(HyprClientInfo *info) {
     info->app_class = NULL;
 }
 
+/* Fill `info` from one j/clients entry; false if it is not an object */
+static bool client_from_json(json_object *c, HyprClientInfo *out) {
+    if (!c || !json_object_is_type(c, json_type_object)) return false;
+
+    HyprClientInfo info;
+    memset(&info, 0, sizeof(info));
+    info.workspace_id = get_workspace_id_from_client(c);
+    info.pid = -1;
+    info.monitor_id = -1;
+    info.focusHistoryID = -1;
+    info.focused = false;
+
+    json_object *mon_obj = json_object_object_get(c, "monitor");
+    if (mon_obj && json_object_is_type(mon_obj, json_type_int))
+        info.monitor_id = json_object_get_int(mon_obj);
+
+    json_object *pid_obj = json_object_object_get(c, "pid");
+    if (pid_obj && json_object_is_type(pid_obj, json_type_int))
+        info.pid = json_object_get_int(pid_obj);
+
+    json_object *fh_obj = json_object_object_get(c, "focusHistoryID");
+    if (fh_obj && json_object_is_type(fh_obj, json_type_int)) {
+        info.focusHistoryID = json_object_get_int(fh_obj);
+        if (info.focusHistoryID == 0)
+            info.focused = true;
+    }
+
+    info.address = dup_json_string_field(c, "address");
+    info.title   = dup_json_text_field(c, "title");
+    if (!info.title || info.title[0] == '\0') {
+        free(info.title);
+        info.title = strdup("(untitled)");
+    }
+    info.app_class = dup_json_text_field(c, "class");
+    if (!info.app_class)
+        info.app_class = dup_json_text_field(c, "initialClass");
+
+    *out = info;
+    return true;
+}
+
 /* Return a heap-allocated array of HyprClientInfo for all clients.
    Each entry contains: address, title, app_class, workspace_id, pid, focusHistoryID,
    and focused (true if focusHistoryID == 0).
    Caller must free with hypr_ipc_free_client_infos.
    Returns 0 on success (even if zero clients), -1 on error. */
-int hypr_ipc_get_clients_basic(HyprClientInfo **list_out, size_t *count_out) {
-    if (!list_out || !count_out) return -1;
-    *list_out = NULL;
-    *count_out = 0;
-
-    char *resp = NULL;
-    if (hypr_ipc_send_recv("j/clients", &resp) != 0) {
-        return -1;
-    }
-
-    json_object *arr = json_tokener_parse(resp);
-    free(resp);
+/* Convert a parsed j/clients array (consumed) into a HyprClientInfo list */
+static int clients_from_json(json_object *arr, HyprClientInfo **list_out, size_t *count_out) {
     if (!arr || !json_object_is_type(arr, json_type_array)) {
         if (arr) json_object_put(arr);
         return -1;
@@ -240,38 +323,9 @@ int hypr_ipc_get_clients_basic(HyprClientInfo **list_out, size_t *count_out) {
 
     size_t n = 0;
     for (int i = 0; i < len; i++) {
-        json_object *c = json_object_array_get_idx(arr, i);
-        if (!c || !json_object_is_type(c, json_type_object)) continue;
-
-        HyprClientInfo info;
-        memset(&info, 0, sizeof(info));
-        info.workspace_id = get_workspace_id_from_client(c);
-        info.pid = -1;
-        info.focusHistoryID = -1;
-        info.focused = false;
-
-        json_object *pid_obj = json_object_object_get(c, "pid");
-        if (pid_obj && json_object_is_type(pid_obj, json_type_int))
-            info.pid = json_object_get_int(pid_obj);
-
-        json_object *fh_obj = json_object_object_get(c, "focusHistoryID");
-        if (fh_obj && json_object_is_type(fh_obj, json_type_int)) {
-            info.focusHistoryID = json_object_get_int(fh_obj);
-            if (info.focusHistoryID == 0)
-                info.focused = true;
-        }
-
-        info.address = dup_json_string_field(c, "address");
-        info.title   = dup_json_string_field(c, "title");
-        if (!info.title || info.title[0] == '\0') {
-            free(info.title);
-            info.title = strdup("(untitled)");
+        if (client_from_json(json_object_array_get_idx(arr, i), &list[n])) {
+            n++;
         }
-        info.app_class = dup_json_string_field(c, "class");
-        if (!info.app_class)
-            info.app_class = dup_json_string_field(c, "initialClass");
-
-        list[n++] = info;
     }
 
     json_object_put(arr);
@@ -286,6 +340,190 @@ int hypr_ipc_get_clients_basic(HyprClientInfo **list_out, size_t *count_out) {
     return 0;
 }
 
+/*
+ * j/clients reply split into array entries as it streams in. Each entry is
+ * parsed on its own as soon as its closing brace arrives, so the document
+ * is never held as one tree and callers see windows before the reply ends.
+ */
+typedef struct {
+    bool started;             /* '[' seen */
+    int depth;                /* Nesting inside the current entry (0 = between entries) */
+    bool in_string;
+    bool escape;
+    char *entry;              /* Bytes of the current entry */
+    size_t entry_len;
+    size_t entry_cap;
+    json_tokener *tok;
+    HyprClientInfo *list;
+    size_t count;
+    size_t cap;
+    HyprClientsProgress progress;
+    HyprClientFilter keep;
+    void *user;
+} ClientStream;
+
+static bool stream_append(ClientStream *cs, const char *data, size_t len) {
+    if (cs->entry_len + len + 1 > cs->entry_cap) {
+        size_t cap = cs->entry_cap ? cs->entry_cap : 1024;
+        while (cap < cs->entry_len + len + 1) cap *= 2;
+        char *grown = realloc(cs->entry, cap);
+        if (!grown) return false;
+        cs->entry = grown;
+        cs->entry_cap = cap;
+    }
+    memcpy(cs->entry + cs->entry_len, data, len);
+    cs->entry_len += len;
+    return true;
+}
+
+/* Parse the buffered entry and append it to the list */
+static bool stream_finish_entry(ClientStream *cs) {
+    json_tokener_reset(cs->tok);
+    json_object *c = json_tokener_parse_ex(cs->tok, cs->entry, (int)cs->entry_len);
+    cs->entry_len = 0;
+    if (!c) {
+        LOG_DEBUG("[IPC] Client entry parse error: %s\n",
+                  json_tokener_error_desc(json_tokener_get_error(cs->tok)));
+        return false;
+    }
+
+    if (cs->count == cs->cap) {
+        size_t cap = cs->cap ? cs->cap * 2 : 32;
+        HyprClientInfo *grown = realloc(cs->list, cap * sizeof(*grown));
+        if (!grown) {
+            json_object_put(c);
+            return false;
+        }
+        cs->list = grown;
+        cs->cap = cap;
+    }
+    bool added = client_from_json(c, &cs->list[cs->count]);
+    json_object_put(c);
+    if (added && cs->keep && !cs->keep(&cs->list[cs->count], cs->user)) {
+        hypr_ipc_free_client_info(&cs->list[cs->count]);
+        added = false;
+    }
+    if (added) {
+        cs->count++;
+        if (cs->progress) {
+            cs->progress(cs->list, cs->count, cs->user);
+        }
+    }
+    return true;
+}
+
+static int client_stream_sink(const char *data, size_t len, void *user) {
+    ClientStream *cs = user;
+    size_t run = cs->depth > 0 ? 0 : SIZE_MAX;   /* start of entry bytes in this chunk */
+
+    for (size_t i = 0; i < len; i++) {
+        char ch = data[i];
+        if (!cs->started) {
+            if (ch == '[') cs->started = true;
+            else if (ch != ' ' && ch != '\n' && ch != '\r' && ch != '\t') return -1;
+            continue;
+        }
+        if (cs->depth == 0) {
+            if (ch == '{') {
+                run = i;
+                cs->depth = 1;
+            } else if (ch == ']') {
+                return 1;
+            } else if (ch != ',' && ch != ' ' && ch != '\n' && ch != '\r' && ch != '\t') {
+                return -1;
+            }
+            continue;
+        }
+
+        if (cs->in_string) {
+            if (cs->escape) cs->escape = false;
+            else if (ch == '\\') cs->escape = true;
+            else if (ch == '"') cs->in_string = false;
+        } else if (ch == '"') {
+            cs->in_string = true;
+        } else if (ch == '{' || ch == '[') {
+            cs->depth++;
+        } else if ((ch == '}' || ch == ']') && --cs->depth == 0) {
+            if (!stream_append(cs, data + run, i + 1 - run) || !stream_finish_entry(cs)) {
+                return -1;
+            }
+            run = SIZE_MAX;
+        }
+    }
+
+    if (run != SIZE_MAX && !stream_append(cs, data + run, len - run)) {
+        return -1;
+    }
+    return 0;
+}
+
+static int get_clients(HyprClientInfo **list_out, size_t *count_out,
+                       HyprClientsProgress progress, HyprClientFilter keep, void *user) {
+    if (!list_out || !count_out) return -1;
+    *list_out = NULL;
+    *count_out = 0;
+
+    ClientStream cs;
+    memset(&cs, 0, sizeof(cs));
+    cs.progress = progress;
+    cs.keep = keep;
+    cs.user = user;
+    cs.tok = json_tokener_new();
+    if (!cs.tok) return -1;
+
+    uint64_t start = flight_now();
+    size_t bytes = 0;
+    int rc = query_stream("j/clients", client_stream_sink, &cs, &bytes);
+    flight_span(FLIGHT_IPC, start, rc == 0 ? (int64_t)bytes : -1);
+
+    json_tokener_free(cs.tok);
+    free(cs.entry);
+    if (rc != 0) {
+        hypr_ipc_free_client_infos(cs.list, cs.count);
+        return -1;
+    }
+    if (cs.count == 0) {
+        free(cs.list);
+        return 0; /* success, empty list */
+    }
+    *list_out = cs.list;
+    *count_out = cs.count;
+    return 0;
+}
+
+int hypr_ipc_get_clients_streamed(HyprClientInfo **list_out, size_t *count_out,
+                                  HyprClientsProgress progress, void *user) {
+    return get_clients(list_out, count_out, progress, NULL, user);
+}
+
+int hypr_ipc_get_clients_matching(HyprClientInfo **list_out, size_t *count_out,
+                                  HyprClientFilter keep, void *user) {
+    return get_clients(list_out, count_out, NULL, keep, user);
+}
+
+int hypr_ipc_get_clients_basic(HyprClientInfo **list_out, size_t *count_out) {
+    return get_clients(list_out, count_out, NULL, NULL, NULL);
+}
+
+int hypr_ipc_parse_clients(const char *json, size_t len,
+                           HyprClientInfo **list_out, size_t *count_out) {
+    if (!json || !list_out || !count_out || len > INT32_MAX) return -1;
+    *list_out = NULL;
+    *count_out = 0;
+
+    json_tokener *tok = json_tokener_new();
+    if (!tok) return -1;
+    json_object *arr = json_tokener_parse_ex(tok, json, (int)len);
+    enum json_tokener_error jerr = json_tokener_get_error(tok);
+    json_tokener_free(tok);
+    if (jerr != json_tokener_success) {
+        LOG_DEBUG("[IPC] Client list parse error: %s", json_tokener_error_desc(jerr));
+        if (arr) json_object_put(arr);
+        return -1;
+    }
+    return clients_from_json(arr, list_out, count_out);
+}
+
 /* Free an array produced by hypr_ipc_get_clients_basic */
 void hypr_ipc_free_client_infos(HyprClientInfo *infos, size_t count) {
     if (!infos) return;
@@ -316,6 +554,12 @@ static int compare_by_focus_history(const void *a, const void *b) {
 /* Sort clients by focus history (most recently focused first) */
 void hypr_ipc_sort_clients_by_focus(HyprClientInfo *clients, size_t count) {
     if (!clients || count < 2) return;
+    /* Without focusHistoryID every entry compares equal and qsort() may
+     * shuffle them; keep Hyprland's own order instead */
+    if (!hypr_caps_get()->focus_history) {
+        LOG_DEBUG("[IPC] No focus history on this Hyprland; keeping j/clients order");
+        return;
+    }
     qsort(clients, count, sizeof(HyprClientInfo), compare_by_focus_history);
     LOG_DEBUG("[IPC] Sorted %zu clients by focus history", count);
 }
@@ -323,10 +567,9 @@ void hypr_ipc_sort_clients_by_focus(HyprClientInfo *clients, size_t count) {
 /* ================= Multi-strategy focus (address, class, title) =================
    Hyprland sometimes requires explicit prefixes (address:, class:, title:) or treats
    the argument as a regex. We attempt several patterns until one succeeds.
-   Success heuristic: response does NOT contain "No such window found".
 */
 
-int hypr_ipc_send_command_capture(const char *cmd, char *resp, size_t resp_len) {
+static int send_command(const char *cmd, char *resp, size_t resp_len) {
     int fd = hypr_open_socket();
     if (fd < 0) {
         LOG_WARN("[IPC] send_command_capture: socket open failed for '%s'", cmd);
@@ -361,6 +604,60 @@ int hypr_ipc_send_command_capture(const char *cmd, char *resp, size_t resp_len)
     return 0;
 }
 
+int hypr_ipc_send_command_capture(const char *cmd, char *resp, size_t resp_len) {
+    uint64_t start = flight_now();
+    int ret = send_command(cmd, resp, resp_len);
+    flight_span(FLIGHT_IPC, start, (ret == 0 && resp && resp_len) ? (int64_t)strlen(resp) : ret);
+    return ret;
+}
+
+int hypr_ipc_focus_last(void) {
+    char resp[64];
+    if (hypr_ipc_send_command_capture("dispatch focuscurrentorlast", resp, sizeof(resp)) != 0) {
+        return -1;
+    }
+    if (strncmp(resp, "ok", 2) != 0) {
+        LOG_WARN("[IPC] focuscurrentorlast rejected: %s", resp[0] ? resp : "(no reply)");
+        return -1;
+    }
+    return 0;
+}
+
+/* Send "dispatch <args>" and check that Hyprland answered "ok" */
+static int dispatch_checked(const char *what, const char *fmt, const char *arg) {
+    size_t len = strlen(fmt) + strlen(arg) + 1;
+    char *cmd = malloc(len);
+    if (!cmd) return -1;
+    snprintf(cmd, len, fmt, arg);
+
+    char resp[128];
+    int rc = hypr_ipc_send_command_capture(cmd, resp, sizeof(resp));
+    free(cmd);
+    if (rc != 0) {
+        return -1;
+    }
+    if (strncmp(resp, "ok", 2) != 0) {
+        LOG_WARN("[IPC] %s rejected: %s", what, resp[0] ? resp : "(no reply)");
+        return -1;
+    }
+    return 0;
+}
+
+int hypr_ipc_dispatch_focus(const char *address) {
+    if (!address) return -1;
+    uint64_t start = flight_now();
+    int rc = dispatch_checked("focuswindow", hypr_caps_get()->address_prefix
+                              ? "dispatch focuswindow address:%s"
+                              : "dispatch focuswindow %s", address);
+    flight_span(FLIGHT_FOCUS, start, rc);
+    return rc;
+}
+
+int hypr_ipc_dispatch_exec(const char *command) {
+    if (!command || !command[0]) return -1;
+    return dispatch_checked("exec", "dispatch exec %s", command);
+}
+
 /* Escape regex special chars for literal match; produce ^...$ */
 static void hypr_escape_regex(const char *in, char *out, size_t out_len) {
     if (!out || out_len == 0) return;
@@ -394,96 +691,291 @@ static int validate_address_multi(const char *address) {
     return 0;
 }
 
-/* Attempt focusing by address only (address: prefix then raw). Returns 0 if any succeeds. */
-int hypr_ipc_focus_address(const char *address) {
-    LOG_DEBUG("[IPC] multi-focus address attempt address='%s'", address ? address : "(null)");
-    if (validate_address_multi(address) != 0) {
-        LOG_WARN("[IPC] Invalid address format '%s'", address ? address : "(null)");
+/* ================= Confirmed, statistics-ordered focus =================
+   Only the address form supported by the probed Hyprland version is tried
+   (see hypr_caps.h). Each strategy dispatches one focuswindow form. A "No such window found"
+   reply is an immediate failure; otherwise success is confirmed by the
+   activewindowv2 event for the target address on the event socket. If no
+   event socket is registered, the reply text is all we have to go on. */
+
+/* Time to wait for activewindowv2 before asking j/activewindow directly */
+#define FOCUS_CONFIRM_TIMEOUT_MS 150
+
+static int s_event_fd = -1;
+
+void hypr_ipc_set_event_fd(int fd) {
+    s_event_fd = fd;
+}
+
+static uint64_t monotonic_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ull + (uint64_t)ts.tv_nsec / 1000ull;
+}
+
+/* Ask Hyprland which window is active (used when no event arrives, e.g. the
+   target was already focused). Returns 1 if it is `address`, 0 otherwise. */
+static int active_window_is(const char *address) {
+    char *resp = NULL;
+    if (hypr_ipc_send_recv("j/activewindow", &resp) != 0) {
+        return 0;
+    }
+    int match = 0;
+    json_object *obj = json_tokener_parse(resp);
+    free(resp);
+    if (obj) {
+        json_object *addr = json_object_object_get(obj, "address");
+        const char *s = addr ? json_object_get_string(addr) : NULL;
+        match = (s && strcmp(s, address) == 0);
+        json_object_put(obj);
+    }
+    return match;
+}
+
+/* Build the dispatch command for a strategy. Returns -1 if not applicable. */
+static int focus_build_command(FocusStrategy strategy, const HyprClientInfo *client,
+                               char *cmd, size_t cmd_len) {
+    char escaped[256];
+    switch (strategy) {
+        case FOCUS_STRATEGY_ADDRESS:
+            if (validate_address_multi(client->address) != 0) return -1;
+            snprintf(cmd, cmd_len, "dispatch focuswindow address:%s", client->address);
+            return 0;
+        case FOCUS_STRATEGY_RAW_ADDRESS:
+            if (validate_address_multi(client->address) != 0) return -1;
+            snprintf(cmd, cmd_len, "dispatch focuswindow %s", client->address);
+            return 0;
+        case FOCUS_STRATEGY_CLASS:
+            if (!client->app_class || !client->app_class[0]) return -1;
+            hypr_escape_regex(client->app_class, escaped, sizeof escaped);
+            snprintf(cmd, cmd_len, "dispatch focuswindow class:%s", escaped);
+            return 0;
+        case FOCUS_STRATEGY_TITLE:
+            if (!client->title || !client->title[0]) return -1;
+            hypr_escape_regex(client->title, escaped, sizeof escaped);
+            snprintf(cmd, cmd_len, "dispatch focuswindow title:%s", escaped);
+            return 0;
+        default:
+            return -1;
+    }
+}
+
+/* Dispatch one strategy. Returns 1 if Hyprland accepted it, 0 on failure,
+   -1 if the strategy does not apply to this client. *can_confirm tells
+   whether the outcome can be checked on the event socket. */
+static int focus_dispatch(FocusStrategy strategy, const HyprClientInfo *client,
+                          bool *can_confirm) {
+    char cmd[320];
+    if (focus_build_command(strategy, client, cmd, sizeof cmd) != 0) {
         return -1;
     }
 
+    *can_confirm = (s_event_fd >= 0 && hypr_caps_get()->events_v2 &&
+                    validate_address_multi(client->address) == 0);
+    if (*can_confirm) {
+        hypr_events_drain(s_event_fd);
+    }
+
     char resp[256];
-    int overall_rc = -1;
-
-    /* Try with address: prefix */
-    {
-        char cmd[160];
-        snprintf(cmd, sizeof(cmd), "dispatch focuswindow address:%s", address);
-        if (hypr_ipc_send_command_capture(cmd, resp, sizeof resp) == 0) {
-            if (resp[0] == '\0' || !strstr(resp, "No such window found")) {
-                LOG_INFO("[IPC] Focus success (address: prefix) '%s'", address);
-                return 0;
-            }
-            LOG_DEBUG("[IPC] address: attempt failed response='%s'", resp);
-        }
+    LOG_DEBUG("[IPC] %s attempt cmd='%s'", focus_strategy_name(strategy), cmd);
+    if (hypr_ipc_send_command_capture(cmd, resp, sizeof resp) != 0) {
+        return 0;
+    }
+    if (resp[0] != '\0' && strstr(resp, "No such window found")) {
+        LOG_DEBUG("[IPC] %s attempt failed response='%s'", focus_strategy_name(strategy), resp);
+        return 0;
     }
+    return 1;
+}
 
-    /* Try raw address */
-    {
-        char cmd[160];
-        snprintf(cmd, sizeof(cmd), "dispatch focuswindow %s", address);
-        if (hypr_ipc_send_command_capture(cmd, resp, sizeof resp) == 0) {
-            if (resp[0] == '\0' || !strstr(resp, "No such window found")) {
-                LOG_INFO("[IPC] Focus success (raw address) '%s'", address);
-                return 0;
-            }
-            LOG_DEBUG("[IPC] raw address attempt failed response='%s'", resp);
+/* Whether an accepted dispatch focused the client. Hyprland handles a
+   dispatch before replying, so j/activewindow normally has the answer at
+   once (and is the only answer when the target was active all along);
+   the event wait only covers focus applied after the reply. */
+static bool focus_confirm(const HyprClientInfo *client, bool can_confirm) {
+    if (!can_confirm) {
+        return true;   /* the reply text is all we have to go on */
+    }
+    if (active_window_is(client->address)) {
+        return true;
+    }
+    int rc = hypr_events_wait_active(s_event_fd, client->address, FOCUS_CONFIRM_TIMEOUT_MS);
+    if (rc < 0) {
+        rc = active_window_is(client->address);
+    }
+    return rc == 1;
+}
+
+/* Dispatch and confirm one strategy, recording its statistics. Returns 1 on
+   confirmed focus, 0 on failure, -1 if the strategy does not apply. */
+static int focus_try_strategy(FocusStrategy strategy, const HyprClientInfo *client) {
+    bool can_confirm;
+    uint64_t t0 = monotonic_us();
+    int rc = focus_dispatch(strategy, client, &can_confirm);
+    if (rc <= 0) {
+        if (rc == 0) {
+            focus_stats_record(strategy, false, 0);
         }
+        return rc;
     }
 
-    LOG_WARN("[IPC] Focus by address failed '%s'", address);
-    return overall_rc;
+    bool success = focus_confirm(client, can_confirm);
+    uint64_t latency = monotonic_us() - t0;
+    focus_stats_record(strategy, success, latency);
+    if (success) {
+        LOG_INFO("[IPC] Focus success (%s) '%s' in %lluus", focus_strategy_name(strategy),
+                 client->address ? client->address : "(null)", (unsigned long long)latency);
+        return 1;
+    }
+    LOG_DEBUG("[IPC] %s attempt not confirmed", focus_strategy_name(strategy));
+    return 0;
 }
 
-/* Full multi-strategy: address, class, title */
-int hypr_ipc_focus_client(const HyprClientInfo *client) {
-    LOG_DEBUG("[IPC] multi-focus client ptr=%p", (void*)client);
-    if (!client) {
-        LOG_WARN("[IPC] focus_client: NULL client");
-        return -1;
+/* Whether the probed Hyprland version accepts this strategy's argument form */
+static bool focus_strategy_supported(FocusStrategy strategy) {
+    const HyprCaps *caps = hypr_caps_get();
+    if (!caps->probed) {
+        return true;
     }
+    switch (strategy) {
+        case FOCUS_STRATEGY_ADDRESS:     return caps->address_prefix;
+        case FOCUS_STRATEGY_RAW_ADDRESS: return !caps->address_prefix;
+        default:                         return true;
+    }
+}
 
-    /* 1. Address attempts */
-    if (client->address) {
-        if (hypr_ipc_focus_address(client->address) == 0) {
-            return 0;
-        }
+static bool focus_strategy_allowed(FocusStrategy strategy, bool address_only) {
+    if (!focus_strategy_supported(strategy)) {
+        return false;
     }
+    return !address_only || strategy == FOCUS_STRATEGY_ADDRESS ||
+           strategy == FOCUS_STRATEGY_RAW_ADDRESS;
+}
 
-    char resp[256];
+/* An accepted dispatch whose confirmation is left to hypr_ipc_focus_confirm() */
+static struct {
+    bool active;
+    bool can_confirm;
+    bool address_only;
+    FocusStrategy order[FOCUS_STRATEGY_COUNT];
+    size_t count;
+    size_t index;            /* order[index] was dispatched */
+    uint64_t dispatch_us;    /* Dispatch round trip, for the statistics */
+    HyprClientInfo client;   /* Owned copies of the strings */
+} s_focus_pending;
+
+static void focus_pending_clear(void) {
+    free(s_focus_pending.client.address);
+    free(s_focus_pending.client.app_class);
+    free(s_focus_pending.client.title);
+    memset(&s_focus_pending, 0, sizeof(s_focus_pending));
+}
 
-    /* 2. Class attempt (escaped) */
-    if (client->app_class && client->app_class[0]) {
-        char escaped[256];
-        hypr_escape_regex(client->app_class, escaped, sizeof escaped);
-        char cmd[320];
-        snprintf(cmd, sizeof(cmd), "dispatch focuswindow class:%s", escaped);
-        LOG_DEBUG("[IPC] class attempt cmd='%s'", cmd);
-        if (hypr_ipc_send_command_capture(cmd, resp, sizeof resp) == 0) {
-            if (resp[0] == '\0' || !strstr(resp, "No such window found")) {
-                LOG_INFO("[IPC] Focus success (class) '%s'", client->app_class);
-                return 0;
-            }
-            LOG_DEBUG("[IPC] class attempt failed response='%s'", resp);
+/* Run strategies in statistics order; address_only limits to address forms.
+   The first accepted dispatch counts as success; it is confirmed later. */
+static int focus_with_strategies(const HyprClientInfo *client, bool address_only) {
+    hypr_ipc_focus_confirm();   /* an earlier focus still unconfirmed */
+
+    FocusStrategy order[FOCUS_STRATEGY_COUNT];
+    size_t n = focus_stats_order(order);
+
+    for (size_t i = 0; i < n; i++) {
+        if (!focus_strategy_allowed(order[i], address_only)) {
+            continue;
         }
+        bool can_confirm;
+        uint64_t t0 = monotonic_us();
+        int rc = focus_dispatch(order[i], client, &can_confirm);
+        if (rc == 0) {
+            focus_stats_record(order[i], false, 0);
+        }
+        if (rc != 1) {
+            continue;
+        }
+
+        s_focus_pending.active = true;
+        s_focus_pending.can_confirm = can_confirm;
+        s_focus_pending.address_only = address_only;
+        memcpy(s_focus_pending.order, order, sizeof(order));
+        s_focus_pending.count = n;
+        s_focus_pending.index = i;
+        s_focus_pending.dispatch_us = monotonic_us() - t0;
+        s_focus_pending.client.address = client->address ? strdup(client->address) : NULL;
+        s_focus_pending.client.app_class = client->app_class ? strdup(client->app_class) : NULL;
+        s_focus_pending.client.title = client->title ? strdup(client->title) : NULL;
+        LOG_DEBUG("[IPC] %s dispatch accepted in %lluus; confirming later",
+                  focus_strategy_name(order[i]), (unsigned long long)s_focus_pending.dispatch_us);
+        return 0;
     }
 
-    /* 3. Title attempt (escaped) */
-    if (client->title && client->title[0]) {
-        char escaped[256];
-        hypr_escape_regex(client->title, escaped, sizeof escaped);
-        char cmd[320];
-        snprintf(cmd, sizeof(cmd), "dispatch focuswindow title:%s", escaped);
-        LOG_DEBUG("[IPC] title attempt cmd='%s'", cmd);
-        if (hypr_ipc_send_command_capture(cmd, resp, sizeof resp) == 0) {
-            if (resp[0] == '\0' || !strstr(resp, "No such window found")) {
-                LOG_INFO("[IPC] Focus success (title) '%s'", client->title);
-                return 0;
+    focus_stats_save();
+    return -1;
+}
+
+void hypr_ipc_focus_confirm(void) {
+    if (!s_focus_pending.active) {
+        return;
+    }
+    const HyprClientInfo *client = &s_focus_pending.client;
+    FocusStrategy strategy = s_focus_pending.order[s_focus_pending.index];
+
+    uint64_t t0 = monotonic_us();
+    bool success = focus_confirm(client, s_focus_pending.can_confirm);
+    uint64_t latency = s_focus_pending.dispatch_us + (monotonic_us() - t0);
+    focus_stats_record(strategy, success, latency);
+
+    if (success) {
+        LOG_INFO("[IPC] Focus success (%s) '%s' in %lluus", focus_strategy_name(strategy),
+                 client->address ? client->address : "(null)", (unsigned long long)latency);
+    } else {
+        /* The accepted form did not take: fall back to the others, now
+         * confirming each before moving on */
+        LOG_WARN("[IPC] %s focus not confirmed; trying the remaining strategies",
+                 focus_strategy_name(strategy));
+        for (size_t i = s_focus_pending.index + 1; i < s_focus_pending.count; i++) {
+            FocusStrategy next = s_focus_pending.order[i];
+            if (focus_strategy_allowed(next, s_focus_pending.address_only) &&
+                focus_try_strategy(next, client) == 1) {
+                break;
             }
-            LOG_DEBUG("[IPC] title attempt failed response='%s'", resp);
         }
     }
 
+    focus_stats_save();
+    focus_pending_clear();
+}
+
+/* Attempt focusing by address only (address: prefix and raw). Returns 0 if any succeeds. */
+int hypr_ipc_focus_address(const char *address) {
+    LOG_DEBUG("[IPC] multi-focus address attempt address='%s'", address ? address : "(null)");
+    if (validate_address_multi(address) != 0) {
+        LOG_WARN("[IPC] Invalid address format '%s'", address ? address : "(null)");
+        return -1;
+    }
+
+    HyprClientInfo client;
+    memset(&client, 0, sizeof(client));
+    client.address = (char *)address;
+
+    if (focus_with_strategies(&client, true) == 0) {
+        return 0;
+    }
+    LOG_WARN("[IPC] Focus by address failed '%s'", address);
+    return -1;
+}
+
+/* Full multi-strategy: address, raw, class, title in statistics order */
+int hypr_ipc_focus_client(const HyprClientInfo *client) {
+    LOG_DEBUG("[IPC] multi-focus client ptr=%p", (void*)client);
+    if (!client) {
+        LOG_WARN("[IPC] focus_client: NULL client");
+        return -1;
+    }
+
+    if (focus_with_strategies(client, false) == 0) {
+        return 0;
+    }
+
     LOG_WARN("[IPC] All focus attempts failed (address=%s class=%s title=%s)",
              client->address ? client->address : "(null)",
              client->app_class ? client->app_class : "(null)",
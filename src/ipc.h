@@ -17,6 +17,7 @@ typedef struct HyprClientInfo {
     char *title;
     char *app_class;
     int  workspace_id;
+    int  monitor_id;     /* Hyprland monitor id; -1 if unknown */
     int  pid;
     bool focused;
     int  focusHistoryID; /* 0 means currently focused; -1 or >0 otherwise */
@@ -34,6 +35,31 @@ void hypr_ipc_free_client_info(HyprClientInfo *info);
    Returns 0 on success and sets list_out/count_out; caller must free with hypr_ipc_free_client_infos. */
 int hypr_ipc_get_clients_basic(HyprClientInfo **list_out, size_t *count_out);
 
+/* Called with the entries parsed so far (reply order) after each new one. */
+typedef void (*HyprClientsProgress)(const HyprClientInfo *list, size_t count, void *user);
+
+/* hypr_ipc_get_clients_basic() that parses entries as the reply arrives and reports
+   each one to `progress` (may be NULL), so callers can act on the first windows
+   before a long reply has been read. The list passed to `progress` is owned by
+   the stream; copy what you keep. Returns 0 on success, -1 on error. */
+int hypr_ipc_get_clients_streamed(HyprClientInfo **list_out, size_t *count_out,
+                                  HyprClientsProgress progress, void *user);
+
+/* Called with each parsed client; return false to drop it. */
+typedef bool (*HyprClientFilter)(const HyprClientInfo *client, void *user);
+
+/* hypr_ipc_get_clients_streamed() that only keeps the clients `keep` accepts.
+   The others are freed as soon as they are parsed, so a lookup holds only its
+   matches. Returns 0 on success (list may be empty), -1 on error. */
+int hypr_ipc_get_clients_matching(HyprClientInfo **list_out, size_t *count_out,
+                                  HyprClientFilter keep, void *user);
+
+/* Parse a j/clients reply already in memory (len bytes, NUL not required) into the same
+   list hypr_ipc_get_clients_basic returns. Returns 0 on success (list may be empty),
+   -1 on malformed JSON or allocation failure. */
+int hypr_ipc_parse_clients(const char *json, size_t len,
+                           HyprClientInfo **list_out, size_t *count_out);
+
 /* Free an array of HyprClientInfo structs allocated by hypr_ipc_get_clients_basic. */
 void hypr_ipc_free_client_infos(HyprClientInfo *infos, size_t count);
 
@@ -42,17 +68,41 @@ void hypr_ipc_free_client_infos(HyprClientInfo *infos, size_t count);
    Windows with focusHistoryID -1 (unknown) are placed at the end. */
 void hypr_ipc_sort_clients_by_focus(HyprClientInfo *clients, size_t count);
 
-/* Focus a client by multi-strategy:
-   1) Try focusing by address (with "address:" prefix, then raw).
-   2) Try focusing by class (escaped).
-   3) Try focusing by title (escaped).
-   Returns 0 on success, -1 on failure. */
+/* Focus a client by multi-strategy: address: prefix, raw address, class (escaped)
+   and title (escaped). Strategies are tried cheapest-reliable first according to
+   persisted statistics (see focus_stats.h); known-failing ones are skipped.
+   Returns 0 once Hyprland accepts a dispatch, -1 if none was accepted.
+   Whether it took effect is checked by hypr_ipc_focus_confirm(). */
 int hypr_ipc_focus_client(const HyprClientInfo *client);
 
-/* Focus a client by its address only (with "address:" prefix, then raw).
+/* Focus a client by its address only (address: prefix and raw forms).
    Returns 0 on success, -1 on failure. */
 int hypr_ipc_focus_address(const char *address);
 
+/* Focus the previously focused window with one dispatch (focuscurrentorlast),
+   without listing clients. Returns 0 if Hyprland accepted it, -1 otherwise. */
+int hypr_ipc_focus_last(void);
+
+/* Focus a window with a single focuswindow dispatch in the form hypr_caps
+   reports, without fallbacks or event confirmation (for one-shot callers).
+   Returns 0 if Hyprland accepted it, -1 otherwise. */
+int hypr_ipc_dispatch_focus(const char *address);
+
+/* Start a shell command through Hyprland (dispatch exec), so it inherits the
+   compositor's environment and rules. Returns 0 if accepted, -1 otherwise. */
+int hypr_ipc_dispatch_exec(const char *command);
+
+/* Confirm the last accepted focus dispatch: j/activewindow, else the
+   activewindowv2 event (when an event socket is registered via
+   hypr_ipc_set_event_fd()). Records the strategy statistics and, if the
+   focus did not take, tries the remaining strategies. Call once the overlay
+   is gone; a no-op if nothing is pending. */
+void hypr_ipc_focus_confirm(void);
+
+/* Register the Hyprland event socket used to confirm focus changes
+   (-1 to disable confirmation and rely on dispatcher replies). */
+void hypr_ipc_set_event_fd(int fd);
+
 /* ================= Internal IPC command sending/receiving ================= */
 /* Send a command and capture the response into a heap-allocated string.
    On success returns 0 and sets *response_out (caller must free).
@@ -0,0 +1,450 @@
+#define _POSIX_C_SOURCE 200809L
+
+/*
+ * libhyprswitcher.c - Public C API over ipc.c, hypr_events.c and client_model.c
+ *
+ * This file only adapts types and allocation; parsing and ordering are the
+ * same code the switcher itself runs.
+ */
+
+#include "hyprswitcher.h"
+#include "client_model.h"
+#include "hypr_events.h"
+#include "ipc.h"
+#include "logger/logger.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define EVENTS_BUFFER_SIZE 4096
+
+_Static_assert((int)HS_ORDER_MONITOR == (int)SORT_ORDER_MONITOR &&
+               (int)HS_ORDER_CLASS == (int)SORT_ORDER_CLASS &&
+               (int)HS_ORDER_WORKSPACE == (int)SORT_ORDER_WORKSPACE,
+               "hs_order must mirror SortOrder");
+
+struct hs_snapshot {
+    hs_allocator allocator;
+    size_t count;
+    hs_client clients[];       /* Followed by the strings they point to */
+};
+
+struct hs_events {
+    hs_allocator allocator;
+    int fd;
+    size_t len;
+    char buffer[EVENTS_BUFFER_SIZE];
+};
+
+struct hs_model {
+    hs_allocator allocator;
+    ClientModel *model;
+    hs_client row;             /* Storage behind hs_model_at() */
+};
+
+/* ============================================================================
+ * Setup
+ * ============================================================================ */
+
+static pthread_once_t s_init_once = PTHREAD_ONCE_INIT;
+
+static void library_init(void) {
+    /* Quiet unless HYPRSWITCHER_LOG asks otherwise (log_init honours it);
+     * the host's stdout is not ours to write to */
+    log_init(NULL, (LogLevel)(LOG_ERROR + 1));
+    log_set_console(LOG_CONSOLE_STDERR);
+}
+
+static void *default_alloc(void *ctx, size_t size) {
+    (void)ctx;
+    return malloc(size);
+}
+
+static void default_free(void *ctx, void *ptr) {
+    (void)ctx;
+    free(ptr);
+}
+
+static hs_allocator resolve_allocator(const hs_allocator *allocator) {
+    pthread_once(&s_init_once, library_init);
+    if (allocator && allocator->alloc && allocator->free) {
+        return *allocator;
+    }
+    return (hs_allocator){ default_alloc, default_free, NULL };
+}
+
+int hs_api_version(void) {
+    return HYPRSWITCHER_API_VERSION;
+}
+
+/* ============================================================================
+ * Snapshots
+ * ============================================================================ */
+
+static size_t string_size(const char *s) {
+    return s ? strlen(s) + 1 : 1;
+}
+
+static const char *copy_string(char **cursor, const char *s) {
+    char *dst = *cursor;
+    size_t n = string_size(s);
+    if (s) {
+        memcpy(dst, s, n);
+    } else {
+        dst[0] = '\0';
+    }
+    *cursor += n;
+    return dst;
+}
+
+/* Pack a client list into one allocation; frees the list */
+static hs_snapshot *snapshot_from_list(HyprClientInfo *list, size_t count,
+                                       const hs_allocator *allocator) {
+    hypr_ipc_sort_clients_by_focus(list, count);
+
+    /* Windows without an address cannot be focused or matched; drop them */
+    size_t kept = 0;
+    size_t strings = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (list[i].address) {
+            kept++;
+            strings += string_size(list[i].address) + string_size(list[i].app_class) +
+                       string_size(list[i].title);
+        }
+    }
+
+    hs_snapshot *snap = NULL;
+    if (kept <= (SIZE_MAX - sizeof(*snap) - strings) / sizeof(hs_client)) {
+        snap = allocator->alloc(allocator->ctx,
+                                sizeof(*snap) + kept * sizeof(hs_client) + strings);
+    }
+    if (!snap) {
+        LOG_ERROR("[LIB] Out of memory packing %zu clients", kept);
+        hypr_ipc_free_client_infos(list, count);
+        return NULL;
+    }
+    snap->allocator = *allocator;
+    snap->count = kept;
+
+    char *cursor = (char *)&snap->clients[kept];
+    hs_client *c = snap->clients;
+    for (size_t i = 0; i < count; i++) {
+        const HyprClientInfo *info = &list[i];
+        if (!info->address) {
+            continue;
+        }
+        c->address = copy_string(&cursor, info->address);
+        c->app_class = copy_string(&cursor, info->app_class);
+        c->title = copy_string(&cursor, info->title);
+        c->workspace_id = info->workspace_id;
+        c->monitor_id = info->monitor_id;
+        c->pid = info->pid;
+        c->focus_history_id = info->focusHistoryID;
+        c->focused = info->focused;
+        c++;
+    }
+    hypr_ipc_free_client_infos(list, count);
+    return snap;
+}
+
+hs_snapshot *hs_snapshot_query(const hs_allocator *allocator) {
+    hs_allocator a = resolve_allocator(allocator);
+    HyprClientInfo *list = NULL;
+    size_t count = 0;
+    if (hypr_ipc_get_clients_basic(&list, &count) != 0) {
+        return NULL;
+    }
+    return snapshot_from_list(list, count, &a);
+}
+
+hs_snapshot *hs_snapshot_parse(const char *json, size_t len, const hs_allocator *allocator) {
+    hs_allocator a = resolve_allocator(allocator);
+    HyprClientInfo *list = NULL;
+    size_t count = 0;
+    if (hypr_ipc_parse_clients(json, len, &list, &count) != 0) {
+        return NULL;
+    }
+    return snapshot_from_list(list, count, &a);
+}
+
+size_t hs_snapshot_count(const hs_snapshot *snapshot) {
+    return snapshot ? snapshot->count : 0;
+}
+
+const hs_client *hs_snapshot_at(const hs_snapshot *snapshot, size_t index) {
+    if (!snapshot || index >= snapshot->count) {
+        return NULL;
+    }
+    return &snapshot->clients[index];
+}
+
+void hs_snapshot_free(hs_snapshot *snapshot) {
+    if (snapshot) {
+        snapshot->allocator.free(snapshot->allocator.ctx, snapshot);
+    }
+}
+
+/* ============================================================================
+ * Events
+ * ============================================================================ */
+
+static bool convert_event(const HyprEvent *in, hs_event *out) {
+    switch (in->type) {
+        case HYPR_EVENT_OPEN_WINDOW:      out->type = HS_EVENT_OPEN_WINDOW; break;
+        case HYPR_EVENT_CLOSE_WINDOW:     out->type = HS_EVENT_CLOSE_WINDOW; break;
+        case HYPR_EVENT_ACTIVE_WINDOW:    out->type = HS_EVENT_ACTIVE_WINDOW; break;
+        case HYPR_EVENT_MOVE_WINDOW:      out->type = HS_EVENT_MOVE_WINDOW; break;
+        case HYPR_EVENT_ACTIVE_WINDOW_V2: out->type = HS_EVENT_ACTIVE_WINDOW_V2; break;
+        case HYPR_EVENT_WINDOW_TITLE_V2:  out->type = HS_EVENT_WINDOW_TITLE_V2; break;
+        default:
+            return false;
+    }
+    memcpy(out->address, in->address, sizeof(out->address));
+    memcpy(out->window_class, in->window_class, sizeof(out->window_class));
+    memcpy(out->title, in->title, sizeof(out->title));
+    out->workspace_id = in->workspace_id;
+    /* movewindow carries a name; atoi() yields 0 for named workspaces */
+    if (out->type == HS_EVENT_MOVE_WINDOW && out->workspace_id <= 0) {
+        out->workspace_id = -1;
+    }
+    return true;
+}
+
+bool hs_event_parse_line(const char *line, hs_event *event) {
+    pthread_once(&s_init_once, library_init);
+    if (!event) {
+        return false;
+    }
+    HyprEvent parsed;
+    memset(event, 0, sizeof(*event));
+    event->workspace_id = -1;
+    return hypr_events_parse_line(line, &parsed) && convert_event(&parsed, event);
+}
+
+hs_events *hs_events_connect(const hs_allocator *allocator) {
+    hs_allocator a = resolve_allocator(allocator);
+    hs_events *events = a.alloc(a.ctx, sizeof(*events));
+    if (!events) {
+        return NULL;
+    }
+    events->allocator = a;
+    events->len = 0;
+    events->fd = hypr_events_connect();
+    if (events->fd < 0) {
+        a.free(a.ctx, events);
+        return NULL;
+    }
+    return events;
+}
+
+int hs_events_fd(const hs_events *events) {
+    return events ? events->fd : -1;
+}
+
+int hs_events_read(hs_events *events, hs_event *event) {
+    if (!events || !event) {
+        return -1;
+    }
+    for (;;) {
+        char *newline = memchr(events->buffer, '\n', events->len);
+        if (newline) {
+            *newline = '\0';
+            bool parsed = hs_event_parse_line(events->buffer, event);
+            size_t consumed = (size_t)(newline - events->buffer) + 1;
+            events->len -= consumed;
+            memmove(events->buffer, newline + 1, events->len);
+            if (parsed) {
+                return 1;
+            }
+            continue;
+        }
+
+        if (events->len == sizeof(events->buffer) - 1) {
+            /* A line longer than the buffer: drop it, resync at the next newline */
+            LOG_WARN("[LIB] Discarding oversized event line");
+            events->len = 0;
+        }
+        ssize_t n = read(events->fd, events->buffer + events->len,
+                         sizeof(events->buffer) - 1 - events->len);
+        if (n > 0) {
+            events->len += (size_t)n;
+        } else if (n == 0) {
+            return -1;
+        } else if (errno == EINTR) {
+            continue;
+        } else {
+            return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+        }
+    }
+}
+
+void hs_events_disconnect(hs_events *events) {
+    if (!events) {
+        return;
+    }
+    hypr_events_disconnect(events->fd);
+    events->allocator.free(events->allocator.ctx, events);
+}
+
+/* ============================================================================
+ * Model
+ * ============================================================================ */
+
+static void fill_client(hs_client *out, const HyprClientInfo *info) {
+    out->address = info->address;
+    out->app_class = info->app_class ? info->app_class : "";
+    out->title = info->title ? info->title : "";
+    out->workspace_id = info->workspace_id;
+    out->monitor_id = info->monitor_id;
+    out->pid = info->pid;
+    out->focus_history_id = info->focusHistoryID;
+    out->focused = info->focused;
+}
+
+hs_model *hs_model_new(const hs_allocator *allocator) {
+    hs_allocator a = resolve_allocator(allocator);
+    hs_model *model = a.alloc(a.ctx, sizeof(*model));
+    if (!model) {
+        return NULL;
+    }
+    memset(model, 0, sizeof(*model));
+    model->allocator = a;
+    model->model = client_model_new();
+    if (!model->model) {
+        a.free(a.ctx, model);
+        return NULL;
+    }
+    return model;
+}
+
+void hs_model_free(hs_model *model) {
+    if (!model) {
+        return;
+    }
+    client_model_free(model->model);
+    model->allocator.free(model->allocator.ctx, model);
+}
+
+int hs_model_apply_snapshot(hs_model *model, const hs_snapshot *snapshot) {
+    if (!model || !snapshot) {
+        return -1;
+    }
+    size_t count = snapshot->count;
+    HyprClientInfo *list = count > 0 ? calloc(count, sizeof(*list)) : NULL;
+    if (count > 0 && !list) {
+        return -1;
+    }
+    for (size_t i = 0; i < count; i++) {
+        const hs_client *c = &snapshot->clients[i];
+        HyprClientInfo *info = &list[i];
+        info->address = strdup(c->address);
+        info->app_class = strdup(c->app_class);
+        info->title = strdup(c->title);
+        info->workspace_id = c->workspace_id;
+        info->monitor_id = c->monitor_id;
+        info->pid = c->pid;
+        info->focusHistoryID = c->focus_history_id;
+        info->focused = c->focused;
+        if (!info->address || !info->app_class || !info->title) {
+            LOG_ERROR("[LIB] Out of memory copying snapshot");
+            hypr_ipc_free_client_infos(list, count);
+            return -1;
+        }
+    }
+    /* Snapshots are already most recent first, as the model expects */
+    client_model_sync(model->model, list, count);
+    return 0;
+}
+
+int hs_model_apply_event(hs_model *model, const hs_event *event) {
+    if (!model || !event) {
+        return -1;
+    }
+    switch (event->type) {
+        case HS_EVENT_OPEN_WINDOW:
+            if (client_model_index_of(model->model, event->address) >= 0) {
+                return 0;
+            }
+            return client_model_insert(model->model, event->address, event->window_class,
+                                       event->title, event->workspace_id) ? 1 : -1;
+        case HS_EVENT_CLOSE_WINDOW:
+            return client_model_remove(model->model, event->address) ? 1 : 0;
+        case HS_EVENT_ACTIVE_WINDOW_V2:
+            return client_model_touch(model->model, event->address) ? 1 : 0;
+        case HS_EVENT_MOVE_WINDOW:
+            if (event->workspace_id < 0) {
+                return client_model_index_of(model->model, event->address) >= 0 ? -1 : 0;
+            }
+            return client_model_move(model->model, event->address, event->workspace_id) ? 1 : 0;
+        case HS_EVENT_WINDOW_TITLE_V2:
+            return client_model_set_title(model->model, event->address, event->title) ? 1 : 0;
+        default:
+            return 0;
+    }
+}
+
+bool hs_model_insert(hs_model *model, const char *address, const char *app_class,
+                     const char *title, int workspace_id) {
+    return model && client_model_insert(model->model, address, app_class, title, workspace_id);
+}
+
+bool hs_model_remove(hs_model *model, const char *address) {
+    return model && client_model_remove(model->model, address);
+}
+
+bool hs_model_touch(hs_model *model, const char *address) {
+    return model && client_model_touch(model->model, address);
+}
+
+bool hs_model_move(hs_model *model, const char *address, int workspace_id) {
+    return model && client_model_move(model->model, address, workspace_id);
+}
+
+bool hs_model_set_title(hs_model *model, const char *address, const char *title) {
+    return model && client_model_set_title(model->model, address, title);
+}
+
+int hs_model_set_order(hs_model *model, hs_order order) {
+    if (!model || (int)order < 0 || (int)order >= SORT_ORDER_COUNT) {
+        return -1;
+    }
+    client_model_set_order(model->model, (SortOrder)order);
+    return 0;
+}
+
+hs_order hs_model_get_order(const hs_model *model) {
+    return model ? (hs_order)client_model_get_order(model->model) : HS_ORDER_MRU;
+}
+
+size_t hs_model_count(const hs_model *model) {
+    return model ? client_model_count(model->model) : 0;
+}
+
+const hs_client *hs_model_at(hs_model *model, size_t index) {
+    const HyprClientInfo *info = model ? client_model_at(model->model, index) : NULL;
+    if (!info) {
+        return NULL;
+    }
+    fill_client(&model->row, info);
+    return &model->row;
+}
+
+size_t hs_model_rows(const hs_model *model, size_t first, hs_client *out, size_t max) {
+    if (!model || !out) {
+        return 0;
+    }
+    size_t n = 0;
+    const HyprClientInfo *info;
+    while (n < max && (info = client_model_at(model->model, first + n)) != NULL) {
+        fill_client(&out[n++], info);
+    }
+    return n;
+}
+
+int hs_model_index_of(const hs_model *model, const char *address) {
+    return model ? client_model_index_of(model->model, address) : -1;
+}
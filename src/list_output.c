@@ -0,0 +1,244 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "list_output.h"
+#include "client_model.h"
+#include "config.h"
+#include "ipc.h"
+#include "logger/logger.h"
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+
+static const char *const format_names[LIST_FORMAT_COUNT] = {
+    [LIST_FORMAT_TSV]  = "tsv",
+    [LIST_FORMAT_JSON] = "json",
+    [LIST_FORMAT_BIN]  = "bin",
+};
+
+bool list_output_parse_format(const char *name, ListFormat *out) {
+    if (!name) {
+        return false;
+    }
+    for (int i = 0; i < LIST_FORMAT_COUNT; i++) {
+        if (strcasecmp(name, format_names[i]) == 0) {
+            *out = (ListFormat)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+/* ============================================================================
+ * Output Buffer
+ * ============================================================================ */
+
+typedef struct {
+    char *data;
+    size_t len;
+    size_t cap;
+    bool failed;
+} OutBuf;
+
+static char *out_reserve(OutBuf *out, size_t n) {
+    if (out->failed) {
+        return NULL;
+    }
+    if (out->len + n > out->cap) {
+        size_t cap = out->cap ? out->cap : 4096;
+        while (cap < out->len + n) cap *= 2;
+        char *grown = realloc(out->data, cap);
+        if (!grown) {
+            out->failed = true;
+            return NULL;
+        }
+        out->data = grown;
+        out->cap = cap;
+    }
+    char *p = out->data + out->len;
+    out->len += n;
+    return p;
+}
+
+static void out_bytes(OutBuf *out, const void *data, size_t n) {
+    char *p = out_reserve(out, n);
+    if (p) {
+        memcpy(p, data, n);
+    }
+}
+
+static void out_str(OutBuf *out, const char *s) {
+    out_bytes(out, s, strlen(s));
+}
+
+static void out_int(OutBuf *out, int value) {
+    char num[16];
+    int n = snprintf(num, sizeof(num), "%d", value);
+    out_bytes(out, num, (size_t)n);
+}
+
+/* ============================================================================
+ * Formats
+ * ============================================================================ */
+
+/* TSV field: tabs and line breaks would split the row */
+static void out_tsv_field(OutBuf *out, const char *s) {
+    size_t start = out->len;
+    out_str(out, s);
+    if (out->failed) {
+        return;
+    }
+    for (size_t i = start; i < out->len; i++) {
+        if (out->data[i] == '\t' || out->data[i] == '\n' || out->data[i] == '\r') {
+            out->data[i] = ' ';
+        }
+    }
+}
+
+static void out_json_string(OutBuf *out, const char *s) {
+    out_bytes(out, "\"", 1);
+    for (const unsigned char *p = (const unsigned char *)s; *p; p++) {
+        if (*p == '"' || *p == '\\') {
+            char esc[2] = { '\\', (char)*p };
+            out_bytes(out, esc, 2);
+        } else if (*p < 0x20) {
+            char esc[8];
+            snprintf(esc, sizeof(esc), "\\u%04x", *p);
+            out_bytes(out, esc, 6);
+        } else {
+            out_bytes(out, p, 1);
+        }
+    }
+    out_bytes(out, "\"", 1);
+}
+
+static void out_bin_string(OutBuf *out, const char *s) {
+    size_t n = strlen(s);
+    uint16_t len = n > UINT16_MAX ? UINT16_MAX : (uint16_t)n;
+    out_bytes(out, &len, sizeof(len));
+    out_bytes(out, s, len);
+}
+
+static void format_tsv(OutBuf *out, const ModelRow *row) {
+    out_tsv_field(out, row->address);
+    out_bytes(out, "\t", 1);
+    out_int(out, row->workspace_id);
+    out_bytes(out, "\t", 1);
+    out_int(out, row->monitor_id);
+    out_str(out, row->focused ? "\t1\t" : "\t0\t");
+    out_tsv_field(out, row->app_class);
+    out_bytes(out, "\t", 1);
+    out_tsv_field(out, row->title);
+    out_bytes(out, "\n", 1);
+}
+
+static void format_json(OutBuf *out, const ModelRow *row, bool first) {
+    out_str(out, first ? "\n  {\"address\": " : ",\n  {\"address\": ");
+    out_json_string(out, row->address);
+    out_str(out, ", \"class\": ");
+    out_json_string(out, row->app_class);
+    out_str(out, ", \"title\": ");
+    out_json_string(out, row->title);
+    out_str(out, ", \"workspace\": ");
+    out_int(out, row->workspace_id);
+    out_str(out, ", \"monitor\": ");
+    out_int(out, row->monitor_id);
+    out_str(out, row->focused ? ", \"focused\": true}" : ", \"focused\": false}");
+}
+
+static void format_bin(OutBuf *out, const ModelRow *row) {
+    int32_t ids[2] = { row->workspace_id, row->monitor_id };
+    uint8_t focused = row->focused ? 1 : 0;
+    out_bytes(out, ids, sizeof(ids));
+    out_bytes(out, &focused, 1);
+    out_bin_string(out, row->address);
+    out_bin_string(out, row->app_class);
+    out_bin_string(out, row->title);
+}
+
+char *list_output_format(const ModelSnapshot *snap, ListFormat format, size_t *len_out) {
+    OutBuf out = { 0 };
+    size_t count = snap ? snap->count : 0;
+
+    if (format == LIST_FORMAT_JSON) {
+        out_bytes(&out, "[", 1);
+    } else if (format == LIST_FORMAT_BIN) {
+        uint32_t n = (uint32_t)count;
+        out_bytes(&out, "HSL1", 4);
+        out_bytes(&out, &n, sizeof(n));
+    }
+    for (size_t i = 0; i < count; i++) {
+        switch (format) {
+            case LIST_FORMAT_JSON: format_json(&out, &snap->rows[i], i == 0); break;
+            case LIST_FORMAT_BIN:  format_bin(&out, &snap->rows[i]); break;
+            default:               format_tsv(&out, &snap->rows[i]); break;
+        }
+    }
+    if (format == LIST_FORMAT_JSON) {
+        out_str(&out, count > 0 ? "\n]\n" : "]\n");
+    }
+    /* Never hand out NULL for an empty TSV list */
+    out_reserve(&out, 1);
+
+    if (out.failed) {
+        LOG_ERROR("[LIST] Out of memory formatting %zu windows", count);
+        free(out.data);
+        return NULL;
+    }
+    *len_out = out.len - 1;
+    return out.data;
+}
+
+/* ============================================================================
+ * Headless Listing
+ * ============================================================================ */
+
+static int write_all(int fd, const char *buf, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, buf, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        buf += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+int list_output_headless(ListFormat format, int out_fd) {
+    HyprClientInfo *list = NULL;
+    size_t count = 0;
+    if (hypr_ipc_get_clients_basic(&list, &count) != 0) {
+        LOG_ERROR("[LIST] Failed to list clients");
+        return -1;
+    }
+    hypr_ipc_sort_clients_by_focus(list, count);
+
+    /* Same model and snapshot the overlay draws from, so the order matches */
+    ClientModel *model = client_model_new();
+    if (!model) {
+        hypr_ipc_free_client_infos(list, count);
+        return -1;
+    }
+    client_model_sync(model, list, count);
+    client_model_set_order(model, config_get()->sort_order);
+    model_snapshot_publish(model);
+
+    const ModelSnapshot *snap = model_snapshot_acquire();
+    size_t len = 0;
+    char *buf = list_output_format(snap, format, &len);
+    LOG_DEBUG("[LIST] %zu windows as %s (%zu bytes)", snap ? snap->count : 0,
+              format_names[format], len);
+    model_snapshot_release(snap);
+    model_snapshot_shutdown();
+    client_model_free(model);
+
+    int rc = buf ? write_all(out_fd, buf, len) : -1;
+    free(buf);
+    return rc;
+}
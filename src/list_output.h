@@ -0,0 +1,61 @@
+#pragma once
+/*
+ * list_output.h - Window list for scripts (`hyprswitcher --list`)
+ *
+ * Prints the windows in the order the switcher would show them. A running
+ * main instance answers a LIST_<FORMAT> command from its published model
+ * snapshot; without one, `--list` makes a single streaming j/clients
+ * request and sorts it through a ClientModel itself. Neither path touches
+ * Wayland or Pango.
+ *
+ * Formats, one window per row, in the configured sort order:
+ *
+ *   tsv   address, workspace, monitor, focused (0/1), class, title,
+ *         separated by tabs; tabs and newlines inside fields become spaces
+ *   json  [{"address", "class", "title", "workspace", "monitor", "focused"}]
+ *   bin   "HSL1", u32 count, then per row: i32 workspace, i32 monitor,
+ *         u8 focused and address, class, title as u16 length + bytes
+ *         (native byte order, no terminators)
+ */
+
+#ifndef LIST_OUTPUT_H
+#define LIST_OUTPUT_H
+
+#include "model_snapshot.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef enum {
+    LIST_FORMAT_TSV = 0,
+    LIST_FORMAT_JSON,
+    LIST_FORMAT_BIN,
+    LIST_FORMAT_COUNT
+} ListFormat;
+
+/*
+ * Parse "tsv", "json" or "bin".
+ *
+ * Returns:
+ *   true if recognized (*out set)
+ */
+bool list_output_parse_format(const char *name, ListFormat *out);
+
+/*
+ * Serialize a snapshot (NULL = empty list).
+ *
+ * Returns:
+ *   Heap buffer of *len_out bytes (caller frees), or NULL on allocation
+ *   failure
+ */
+char *list_output_format(const ModelSnapshot *snap, ListFormat format, size_t *len_out);
+
+/*
+ * Fetch the window list from Hyprland (one streaming j/clients request),
+ * order it like the switcher and write it to out_fd.
+ *
+ * Returns:
+ *   0 on success, -1 if Hyprland could not be queried or writing failed
+ */
+int list_output_headless(ListFormat format, int out_fd);
+
+#endif /* LIST_OUTPUT_H */
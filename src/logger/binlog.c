@@ -0,0 +1,114 @@
+#include "binlog.h"
+#include <string.h>
+
+int binlog_parse_spec(const char *p, BinlogSpec *spec) {
+    memset(spec, 0, sizeof(*spec));
+    const char *start = p;
+    p++;  // skip '%'
+
+    if (*p == '%') {
+        spec->len = 2;
+        spec->conv = '%';
+        spec->type = BINLOG_ARG_NONE;
+        return 0;
+    }
+
+    // Flags
+    while (*p && strchr("-+ #0'", *p)) p++;
+
+    // Width
+    if (*p == '*') {
+        spec->stars++;
+        p++;
+    } else {
+        while (*p >= '0' && *p <= '9') p++;
+    }
+
+    // Precision
+    if (*p == '.') {
+        spec->precision = 1;
+        p++;
+        if (*p == '*') {
+            spec->precision = 2;
+            spec->stars++;
+            p++;
+        } else {
+            while (*p >= '0' && *p <= '9') p++;
+        }
+    }
+
+    // Length modifier
+    size_t n = 0;
+    while (*p && strchr("hlzjtL", *p) && n < sizeof(spec->length) - 1) {
+        spec->length[n++] = *p++;
+    }
+    spec->length[n] = '\0';
+
+    spec->conv = *p;
+    if (*p == '\0') {
+        return -1;
+    }
+    spec->len = (size_t)(p - start) + 1;
+
+    switch (spec->conv) {
+        case 'd': case 'i': case 'u': case 'x': case 'X': case 'o': case 'c':
+            spec->type = (n == 0 || spec->length[0] == 'h') ? BINLOG_ARG_INT : BINLOG_ARG_INT64;
+            return 0;
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+            if (spec->length[0] == 'L') return -1;  // long double not supported
+            spec->type = BINLOG_ARG_DOUBLE;
+            return 0;
+        case 'p':
+            spec->type = BINLOG_ARG_PTR;
+            return 0;
+        case 's':
+            if (n != 0) return -1;  // wide strings not supported
+            spec->type = BINLOG_ARG_STR;
+            return 0;
+        default:
+            return -1;
+    }
+}
+
+// How to read an argument of this spec from a va_list
+static BinlogArgType read_type(const BinlogSpec *spec) {
+    if (spec->type == BINLOG_ARG_STR && spec->precision == 2) {
+        return BINLOG_ARG_STR_STAR;
+    }
+    if (spec->type != BINLOG_ARG_INT64) {
+        return spec->type;
+    }
+    switch (spec->length[0]) {
+        case 'z': return BINLOG_ARG_SIZE;
+        case 't': return BINLOG_ARG_PTRDIFF;
+        case 'j': return BINLOG_ARG_INTMAX;
+        case 'l': return spec->length[1] == 'l' ? BINLOG_ARG_INT64 : BINLOG_ARG_LONG;
+        default:  return BINLOG_ARG_INT64;
+    }
+}
+
+int binlog_arg_types(const char *fmt, uint8_t *types, int max_types) {
+    int count = 0;
+    for (const char *p = fmt; *p; p++) {
+        if (*p != '%') continue;
+
+        BinlogSpec spec;
+        if (binlog_parse_spec(p, &spec) != 0) {
+            return -1;
+        }
+        p += spec.len - 1;
+        if (spec.type == BINLOG_ARG_NONE) continue;
+        if (spec.type == BINLOG_ARG_STR && spec.precision == 1) {
+            return -1;  // logged as text, which honours the precision
+        }
+
+        if (count + spec.stars + 1 > max_types) {
+            return -1;
+        }
+        for (int i = 0; i < spec.stars; i++) {
+            types[count++] = BINLOG_ARG_INT;
+        }
+        types[count++] = (uint8_t)read_type(&spec);
+    }
+    return count;
+}
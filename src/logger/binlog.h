@@ -0,0 +1,76 @@
+#ifndef BINLOG_H
+#define BINLOG_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Binary log format (HYPRSWITCHER_LOG_FORMAT=binary), decoded offline by
+// hyprswitcher-logdecode. All integers are in host byte order; the decoder
+// is meant to run on the machine that wrote the log.
+//
+// File:    "HSWBLOG1" magic, then records
+// Records: one type byte followed by
+//   'P' process  u32 pid                      (starts every flushed chunk)
+//   'S' site     u32 id, u8 level, u32 line,
+//                u16 file_len, file, u16 fmt_len, fmt
+//   'R' record   u32 id, u64 timestamp_ns (CLOCK_REALTIME),
+//                u16 payload_len, payload
+// Site ids are per process: a 'P' record selects the namespace for the
+// 'S' and 'R' records that follow it.
+//
+// Payload: the printf arguments in format order, each encoded by type
+//   INT    4 bytes    (%d %i %u %x %X %o %c with no/hh/h length, and '*')
+//   INT64  8 bytes    (l, ll, z, j, t lengths)
+//   DOUBLE 8 bytes    (%f %e %g %a)
+//   PTR    8 bytes    (%p)
+//   STR    u16 length + bytes (truncated to BINLOG_MAX_STR)
+
+#define BINLOG_MAGIC      "HSWBLOG1"
+#define BINLOG_MAGIC_LEN  8
+#define BINLOG_MAX_ARGS   16
+#define BINLOG_MAX_STR    1024
+
+#define BINLOG_REC_PROCESS 'P'
+#define BINLOG_REC_SITE    'S'
+#define BINLOG_REC_LOG     'R'
+
+typedef enum {
+    BINLOG_ARG_NONE = 0,
+    BINLOG_ARG_INT,
+    BINLOG_ARG_INT64,
+    BINLOG_ARG_DOUBLE,
+    BINLOG_ARG_PTR,
+    BINLOG_ARG_STR,
+    // binlog_arg_types() only: encoded as INT64, but read from the va_list
+    // as the C type the length modifier names before widening
+    BINLOG_ARG_LONG,
+    BINLOG_ARG_SIZE,
+    BINLOG_ARG_PTRDIFF,
+    BINLOG_ARG_INTMAX,
+    // binlog_arg_types() only: %.*s, encoded as STR but copying at most the
+    // preceding '*' argument's bytes (the string need not be NUL-terminated)
+    BINLOG_ARG_STR_STAR
+} BinlogArgType;
+
+// One printf conversion specification
+typedef struct {
+    size_t len;            // bytes from '%' through the conversion char
+    int stars;             // number of '*' width/precision arguments (0-2)
+    BinlogArgType type;    // value argument type (NONE for "%%")
+    char length[3];        // length modifier ("", "h", "hh", "l", "ll", "z", "j", "t")
+    int precision;         // 0 none, 1 digits (".N"), 2 from an argument (".*")
+    char conv;             // conversion character
+} BinlogSpec;
+
+// Parse the conversion specification starting at p (which points at '%').
+// Returns 0 on success, -1 for conversions we cannot encode (e.g. %n).
+int binlog_parse_spec(const char *p, BinlogSpec *spec);
+
+// Compute the argument types for a whole format string. INT64 arguments
+// are refined to the LONG/SIZE/PTRDIFF/INTMAX read types (INT64 = long long).
+// %.*s reads as STR_STAR; %.Ns is refused (logged as text), as its
+// argument need not be NUL-terminated either.
+// Returns the number of arguments, or -1 if the format cannot be encoded.
+int binlog_arg_types(const char *fmt, uint8_t *types, int max_types);
+
+#endif
@@ -0,0 +1,348 @@
+#define _POSIX_C_SOURCE 200809L
+// hyprswitcher-logdecode: render binary logs written with
+// HYPRSWITCHER_LOG_FORMAT=binary as the usual text log lines.
+//
+// Usage: hyprswitcher-logdecode FILE...
+// Pass the rotated file first (hyprswitcher.log.bin.1 hyprswitcher.log.bin)
+// to get the lines in chronological order.
+
+#include "binlog.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static const char *level_strings[] = {
+    "DEBUG", "INFO", "WARN", "ERROR"
+};
+
+typedef struct {
+    uint32_t pid;
+    uint32_t id;
+    uint8_t level;
+    uint32_t line;
+    char *file;
+    char *fmt;
+} Site;
+
+static Site *sites = NULL;
+static size_t site_count = 0;
+static size_t site_capacity = 0;
+
+// Input cursor over one file loaded into memory
+typedef struct {
+    const uint8_t *data;
+    size_t len;
+    size_t pos;
+} Reader;
+
+static int read_bytes(Reader *r, void *out, size_t n) {
+    if (r->len - r->pos < n) {
+        return -1;
+    }
+    memcpy(out, r->data + r->pos, n);
+    r->pos += n;
+    return 0;
+}
+
+static char *read_string(Reader *r) {
+    uint16_t n;
+    if (read_bytes(r, &n, sizeof(n)) != 0 || r->len - r->pos < n) {
+        return NULL;
+    }
+    char *s = malloc((size_t)n + 1);
+    if (!s) {
+        return NULL;
+    }
+    memcpy(s, r->data + r->pos, n);
+    s[n] = '\0';
+    r->pos += n;
+    return s;
+}
+
+static Site *find_site(uint32_t pid, uint32_t id) {
+    // Newest definitions win (pids get reused across log files)
+    for (size_t i = site_count; i > 0; i--) {
+        if (sites[i - 1].pid == pid && sites[i - 1].id == id) {
+            return &sites[i - 1];
+        }
+    }
+    return NULL;
+}
+
+static Site *add_site(void) {
+    if (site_count == site_capacity) {
+        size_t cap = site_capacity ? site_capacity * 2 : 64;
+        Site *grown = realloc(sites, cap * sizeof(*sites));
+        if (!grown) {
+            return NULL;
+        }
+        sites = grown;
+        site_capacity = cap;
+    }
+    Site *site = &sites[site_count++];
+    memset(site, 0, sizeof(*site));
+    return site;
+}
+
+// Format a single conversion spec with the matching C type
+static void print_spec(const BinlogSpec *spec, const char *start,
+                       const int *stars, BinlogArgType type, const void *value,
+                       size_t str_len) {
+    char fmt[32];
+    size_t n = spec->len < sizeof(fmt) ? spec->len : sizeof(fmt) - 1;
+    memcpy(fmt, start, n);
+    fmt[n] = '\0';
+
+    int64_t i64;
+    int i32;
+    double d;
+    uint64_t ptr;
+
+    // Width/precision stars come first; re-use a fixed-arity printf per case
+#define EMIT(val) do { \
+        if (spec->stars == 2)      printf(fmt, stars[0], stars[1], val); \
+        else if (spec->stars == 1) printf(fmt, stars[0], val); \
+        else                       printf(fmt, val); \
+    } while (0)
+
+    switch (type) {
+        case BINLOG_ARG_INT:
+            memcpy(&i32, value, sizeof(i32));
+            EMIT(i32);
+            break;
+        case BINLOG_ARG_INT64:
+            memcpy(&i64, value, sizeof(i64));
+            if (spec->length[0] == 'z')      EMIT((size_t)i64);
+            else if (spec->length[0] == 'j') EMIT((intmax_t)i64);
+            else if (spec->length[0] == 't') EMIT((ptrdiff_t)i64);
+            else if (spec->length[1] == 'l') EMIT((long long)i64);
+            else                             EMIT((long)i64);
+            break;
+        case BINLOG_ARG_DOUBLE:
+            memcpy(&d, value, sizeof(d));
+            EMIT(d);
+            break;
+        case BINLOG_ARG_PTR:
+            memcpy(&ptr, value, sizeof(ptr));
+            EMIT((void *)(uintptr_t)ptr);
+            break;
+        case BINLOG_ARG_STR: {
+            char *s = malloc(str_len + 1);
+            if (!s) break;
+            memcpy(s, value, str_len);
+            s[str_len] = '\0';
+            EMIT(s);
+            free(s);
+            break;
+        }
+        default:
+            break;
+    }
+#undef EMIT
+}
+
+// Render one record's message by walking the site's format string
+static void print_message(const Site *site, const uint8_t *payload, size_t len) {
+    size_t pos = 0;
+    int stars[2];
+    int nstars = 0;
+    int arg = 0;
+
+    for (const char *p = site->fmt; *p; p++) {
+        if (*p != '%') {
+            putchar(*p);
+            continue;
+        }
+        BinlogSpec spec;
+        if (binlog_parse_spec(p, &spec) != 0) {
+            fputs(p, stdout);
+            return;
+        }
+        if (spec.type == BINLOG_ARG_NONE) {
+            putchar('%');
+            p += spec.len - 1;
+            continue;
+        }
+
+        nstars = 0;
+        for (int s = 0; s < spec.stars; s++) {
+            if (len - pos < 4) goto truncated;
+            memcpy(&stars[nstars++], payload + pos, 4);
+            pos += 4;
+            arg++;
+        }
+
+        const void *value = payload + pos;
+        size_t str_len = 0;
+        switch (spec.type) {
+            case BINLOG_ARG_INT:
+                if (len - pos < 4) goto truncated;
+                pos += 4;
+                break;
+            case BINLOG_ARG_STR: {
+                uint16_t n;
+                if (len - pos < 2) goto truncated;
+                memcpy(&n, payload + pos, 2);
+                if (len - pos - 2 < n) goto truncated;
+                value = payload + pos + 2;
+                str_len = n;
+                pos += 2 + (size_t)n;
+                break;
+            }
+            default:
+                if (len - pos < 8) goto truncated;
+                pos += 8;
+                break;
+        }
+        arg++;
+
+        print_spec(&spec, p, stars, spec.type, value, str_len);
+        p += spec.len - 1;
+    }
+    return;
+
+truncated:
+    printf("<truncated record, %d args decoded>", arg);
+}
+
+static void print_record(const Site *site, uint64_t ts_ns,
+                         const uint8_t *payload, size_t len) {
+    time_t secs = (time_t)(ts_ns / 1000000000ull);
+    struct tm tm_info;
+    char timestamp[24];
+    localtime_r(&secs, &tm_info);
+    strftime(timestamp, sizeof(timestamp), "%Y-%m-%d %H:%M:%S", &tm_info);
+
+    const char *filename = strrchr(site->file, '/');
+    filename = filename ? filename + 1 : site->file;
+    const char *level = site->level < 4 ? level_strings[site->level] : "?";
+
+    printf("[%s] [%s] [%s:%u] ", timestamp, level, filename, site->line);
+    print_message(site, payload, len);
+    putchar('\n');
+}
+
+static int decode(const char *path, const uint8_t *data, size_t len) {
+    Reader r = { data, len, 0 };
+    char magic[BINLOG_MAGIC_LEN];
+    if (read_bytes(&r, magic, sizeof(magic)) != 0 ||
+        memcmp(magic, BINLOG_MAGIC, BINLOG_MAGIC_LEN) != 0) {
+        fprintf(stderr, "%s: not a hyprswitcher binary log\n", path);
+        return -1;
+    }
+
+    uint32_t pid = 0;
+    while (r.pos < r.len) {
+        uint8_t type = r.data[r.pos++];
+        switch (type) {
+            case BINLOG_REC_PROCESS:
+                if (read_bytes(&r, &pid, sizeof(pid)) != 0) goto truncated;
+                break;
+
+            case BINLOG_REC_SITE: {
+                Site *site = add_site();
+                if (!site) {
+                    fprintf(stderr, "%s: out of memory\n", path);
+                    return -1;
+                }
+                site->pid = pid;
+                if (read_bytes(&r, &site->id, sizeof(site->id)) != 0 ||
+                    read_bytes(&r, &site->level, sizeof(site->level)) != 0 ||
+                    read_bytes(&r, &site->line, sizeof(site->line)) != 0 ||
+                    !(site->file = read_string(&r)) ||
+                    !(site->fmt = read_string(&r))) {
+                    site_count--;
+                    goto truncated;
+                }
+                break;
+            }
+
+            case BINLOG_REC_LOG: {
+                uint32_t id;
+                uint64_t ts_ns;
+                uint16_t plen;
+                if (read_bytes(&r, &id, sizeof(id)) != 0 ||
+                    read_bytes(&r, &ts_ns, sizeof(ts_ns)) != 0 ||
+                    read_bytes(&r, &plen, sizeof(plen)) != 0 ||
+                    r.len - r.pos < plen) {
+                    goto truncated;
+                }
+                const Site *site = find_site(pid, id);
+                if (site) {
+                    print_record(site, ts_ns, r.data + r.pos, plen);
+                } else {
+                    printf("[?] unknown site %u (pid %u)\n", id, pid);
+                }
+                r.pos += plen;
+                break;
+            }
+
+            default:
+                fprintf(stderr, "%s: corrupt record type 0x%02x at offset %zu\n",
+                        path, type, r.pos - 1);
+                return -1;
+        }
+    }
+    return 0;
+
+truncated:
+    fprintf(stderr, "%s: truncated record at end of file\n", path);
+    return -1;
+}
+
+static uint8_t *load_file(const char *path, size_t *len) {
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        perror(path);
+        return NULL;
+    }
+    size_t cap = 64 * 1024;
+    size_t n = 0;
+    uint8_t *data = malloc(cap);
+    while (data) {
+        size_t got = fread(data + n, 1, cap - n, f);
+        n += got;
+        if (n < cap) {
+            break;
+        }
+        cap *= 2;
+        uint8_t *grown = realloc(data, cap);
+        if (!grown) {
+            free(data);
+            data = NULL;
+        }
+        data = grown;
+    }
+    fclose(f);
+    *len = n;
+    return data;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s FILE...\n", argv[0]);
+        return 2;
+    }
+
+    int status = 0;
+    for (int i = 1; i < argc; i++) {
+        size_t len = 0;
+        uint8_t *data = load_file(argv[i], &len);
+        if (!data) {
+            status = 1;
+            continue;
+        }
+        if (decode(argv[i], data, len) != 0) {
+            status = 1;
+        }
+        free(data);
+    }
+
+    for (size_t i = 0; i < site_count; i++) {
+        free(sites[i].file);
+        free(sites[i].fmt);
+    }
+    free(sites);
+    return status;
+}
@@ -1,25 +1,60 @@
+#define _GNU_SOURCE  // fallocate()
 #include "logger.h"
+#include "binlog.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdarg.h>
 #include <time.h>
 #include <string.h>
 #include <strings.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/stat.h>
+
+// Size cap and batching defaults
+#define LOG_DEFAULT_MAX_BYTES   (1024L * 1024L)  // rotate after 1 MiB
+#define LOG_MIN_MAX_BYTES       (16L * 1024L)
+#define LOG_BUFFER_SIZE         (64 * 1024)      // stdio buffer for the log file
+#define LOG_FLUSH_INTERVAL_SEC  1                // flush at most once per second
 
 // Logger configuration
 typedef struct {
     LogLevel level;
     FILE *file;
-    const char *filepath;
+    char filepath[512];
     int initialized;
+    long max_bytes;         // file size that triggers rotation
+    long bytes_written;     // current file size including buffered bytes
+    time_t last_flush;
+    pthread_mutex_t lock;   // serializes lines from the IPC/ring threads
+    int binary;             // deferred-format binary records instead of text
+    int console;            // LOG_CONSOLE_*: copy lines to stdout or stderr
 } Logger;
 
+// Binary mode record buffer, written to the file in whole chunks
+typedef struct {
+    uint8_t buf[LOG_BUFFER_SIZE];
+    size_t len;
+    uint32_t next_site_id;
+    uint32_t generation;    // bumped per opened file so sites are redefined
+    pid_t pid;              // cached; reset in a forked child
+} BinaryLog;
+
+static BinaryLog binlog = { .len = 0, .next_site_id = 0, .generation = 1, .pid = 0 };
+
 // Global logger instance
 static Logger logger = {
     .level = LOG_INFO,  // Default to INFO level
     .file = NULL,
-    .filepath = "application.log",
-    .initialized = 0
+    .filepath = "",
+    .initialized = 0,
+    .max_bytes = LOG_DEFAULT_MAX_BYTES,
+    .bytes_written = 0,
+    .last_flush = 0,
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .binary = 0,
+    .console = LOG_CONSOLE_STDOUT
 };
 
 // Color codes for console output
@@ -61,26 +96,259 @@ static LogLevel parse_log_level(const char *str) {
     return LOG_INFO;
 }
 
+// Open the log file for appending, reserve disk space up to the cap and
+// switch to a large stdio buffer so lines are written in batches.
+static FILE *open_log_file(const char *path) {
+    FILE *file = fopen(path, "a");
+    if (!file) {
+        return NULL;
+    }
+    setvbuf(file, NULL, _IOFBF, LOG_BUFFER_SIZE);
+
+    struct stat st;
+    int fd = fileno(file);
+    logger.bytes_written = (fstat(fd, &st) == 0) ? (long)st.st_size : 0;
+
+    // Preallocate without changing the visible size; failure is harmless
+    if (logger.bytes_written < logger.max_bytes) {
+        (void)fallocate(fd, FALLOC_FL_KEEP_SIZE, 0, logger.max_bytes);
+    }
+
+    if (logger.binary) {
+        binlog.generation++;
+        if (logger.bytes_written == 0 &&
+            write(fd, BINLOG_MAGIC, BINLOG_MAGIC_LEN) == BINLOG_MAGIC_LEN) {
+            logger.bytes_written = BINLOG_MAGIC_LEN;
+        }
+    }
+    return file;
+}
+
+// Rotate: current file becomes <path>.1 (replacing the previous one)
+static void rotate_log_file(void) {
+    char rotated[sizeof(logger.filepath) + 2];
+    snprintf(rotated, sizeof(rotated), "%s.1", logger.filepath);
+
+    // Release preallocated blocks past EOF before the file is retired
+    fflush(logger.file);
+    (void)ftruncate(fileno(logger.file), logger.bytes_written);
+    fclose(logger.file);
+    rename(logger.filepath, rotated);
+    logger.file = open_log_file(logger.filepath);
+    logger.last_flush = time(NULL);
+}
+
+// Write buffered binary records as one chunk (one write() per flush keeps
+// chunks from concurrent helper processes from interleaving mid-record)
+static void binlog_flush(void) {
+    if (binlog.len == 0) {
+        return;
+    }
+    if (logger.file) {
+        if (write(fileno(logger.file), binlog.buf, binlog.len) > 0) {
+            logger.bytes_written += (long)binlog.len;
+        }
+    }
+    binlog.len = 0;
+    if (logger.file && logger.bytes_written >= logger.max_bytes) {
+        rotate_log_file();
+    }
+}
+
+static void binlog_put(const void *data, size_t len) {
+    memcpy(binlog.buf + binlog.len, data, len);
+    binlog.len += len;
+}
+
+static void binlog_put_u8(uint8_t v)   { binlog_put(&v, sizeof(v)); }
+static void binlog_put_u16(uint16_t v) { binlog_put(&v, sizeof(v)); }
+static void binlog_put_u32(uint32_t v) { binlog_put(&v, sizeof(v)); }
+static void binlog_put_u64(uint64_t v) { binlog_put(&v, sizeof(v)); }
+
+// Make room for `need` bytes, starting a new chunk if necessary
+static void binlog_reserve(size_t need) {
+    if (binlog.len + need > sizeof(binlog.buf)) {
+        binlog_flush();
+    }
+    if (binlog.len == 0) {
+        binlog_put_u8(BINLOG_REC_PROCESS);
+        binlog_put_u32((uint32_t)binlog.pid);
+    }
+}
+
+static size_t binlog_site_len(const LogSite *site, const char *fmt, size_t *file_len, size_t *fmt_len) {
+    *file_len = strlen(site->file);
+    *fmt_len = strlen(fmt);
+    if (*file_len > UINT16_MAX) *file_len = UINT16_MAX;
+    if (*fmt_len > UINT16_MAX) *fmt_len = UINT16_MAX;
+    return 1 + 4 + 1 + 4 + 2 + *file_len + 2 + *fmt_len;
+}
+
+// Put a site definition; the caller has reserved binlog_site_len() bytes
+static void binlog_define_site(LogSite *site, const char *fmt) {
+    size_t file_len, fmt_len;
+    binlog_site_len(site, fmt, &file_len, &fmt_len);
+
+    binlog_put_u8(BINLOG_REC_SITE);
+    binlog_put_u32(site->id);
+    binlog_put_u8((uint8_t)site->level);
+    binlog_put_u32((uint32_t)site->line);
+    binlog_put_u16((uint16_t)file_len);
+    binlog_put(site->file, file_len);
+    binlog_put_u16((uint16_t)fmt_len);
+    binlog_put(fmt, fmt_len);
+    site->generation = binlog.generation;
+}
+
+// Append one record: site id, timestamp and raw argument bytes
+static void binlog_record(LogSite *site, const char *fmt, uint64_t now_ns, va_list args) {
+    uint8_t payload[BINLOG_MAX_ARGS * (2 + BINLOG_MAX_STR)];
+    size_t plen = 0;
+    int star = -1;          // last int argument: the '*' before a %.*s
+    for (int i = 0; i < site->nargs; i++) {
+        switch (site->arg_types[i]) {
+            case BINLOG_ARG_INT: {
+                int v = va_arg(args, int);
+                star = v;
+                memcpy(payload + plen, &v, 4);
+                plen += 4;
+                break;
+            }
+            case BINLOG_ARG_INT64:
+            case BINLOG_ARG_LONG:
+            case BINLOG_ARG_SIZE:
+            case BINLOG_ARG_PTRDIFF:
+            case BINLOG_ARG_INTMAX: {
+                // Read the promoted C type, then widen to the 8-byte slot
+                int64_t v;
+                switch (site->arg_types[i]) {
+                    case BINLOG_ARG_LONG:    v = (int64_t)va_arg(args, long); break;
+                    case BINLOG_ARG_SIZE:    v = (int64_t)va_arg(args, size_t); break;
+                    case BINLOG_ARG_PTRDIFF: v = (int64_t)va_arg(args, ptrdiff_t); break;
+                    case BINLOG_ARG_INTMAX:  v = (int64_t)va_arg(args, intmax_t); break;
+                    default:                 v = (int64_t)va_arg(args, long long); break;
+                }
+                memcpy(payload + plen, &v, 8);
+                plen += 8;
+                break;
+            }
+            case BINLOG_ARG_DOUBLE: {
+                double v = va_arg(args, double);
+                memcpy(payload + plen, &v, 8);
+                plen += 8;
+                break;
+            }
+            case BINLOG_ARG_PTR: {
+                uint64_t v = (uint64_t)(uintptr_t)va_arg(args, void *);
+                memcpy(payload + plen, &v, 8);
+                plen += 8;
+                break;
+            }
+            case BINLOG_ARG_STR:
+            case BINLOG_ARG_STR_STAR: {
+                // %.*s: stop at the precision, the bytes past it may not exist
+                size_t limit = BINLOG_MAX_STR;
+                if (site->arg_types[i] == BINLOG_ARG_STR_STAR && star >= 0 &&
+                    (size_t)star < limit) {
+                    limit = (size_t)star;
+                }
+                const char *str = va_arg(args, const char *);
+                if (!str) str = "(null)";
+                size_t n = strnlen(str, limit);
+                uint16_t n16 = (uint16_t)n;
+                memcpy(payload + plen, &n16, 2);
+                memcpy(payload + plen + 2, str, n);
+                plen += 2 + n;
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    // Reserve the definition and the record together: a flush in between
+    // may rotate, and the new file must get the definition as well
+    size_t file_len, fmt_len;
+    size_t site_len = binlog_site_len(site, fmt, &file_len, &fmt_len);
+    size_t record_len = 1 + 4 + 8 + 2 + plen;
+    int define = site->generation != binlog.generation;
+    binlog_reserve((define ? site_len : 0) + record_len);
+    if (site->generation != binlog.generation) {
+        // Still fits: a flush during the reserve left only the 'P' record
+        binlog_define_site(site, fmt);
+    }
+
+    binlog_put_u8(BINLOG_REC_LOG);
+    binlog_put_u32(site->id);
+    binlog_put_u64(now_ns);
+    binlog_put_u16((uint16_t)plen);
+    binlog_put(payload, plen);
+}
+
+// fork() keeps only the calling thread: hold the lock across it so a child
+// never inherits it mid-line, and give the child its own binary buffer
+static void logger_atfork_prepare(void) {
+    pthread_mutex_lock(&logger.lock);
+}
+
+static void logger_atfork_parent(void) {
+    pthread_mutex_unlock(&logger.lock);
+}
+
+static void logger_atfork_child(void) {
+    // The parent still owns what is buffered, and site definitions must be
+    // repeated under this process's id
+    binlog.pid = getpid();
+    binlog.len = 0;
+    binlog.generation++;
+    pthread_mutex_unlock(&logger.lock);
+}
+
+static void logger_register_atfork(void) {
+    pthread_atfork(logger_atfork_prepare, logger_atfork_parent, logger_atfork_child);
+}
+
 // Initialize logger
 int log_init(const char *filepath, LogLevel level) {
+    static pthread_once_t atfork_once = PTHREAD_ONCE_INIT;
+    pthread_once(&atfork_once, logger_register_atfork);
+    binlog.pid = getpid();
+
     logger.level = level;
-    logger.filepath = filepath;
     
     // Check for environment variable override
     const char *env_level = getenv("HYPRSWITCHER_LOG");
     if (env_level && env_level[0] != '\0') {
         logger.level = parse_log_level(env_level);
     }
+
+    // Size cap override in KiB
+    const char *env_max = getenv("HYPRSWITCHER_LOG_MAX_KB");
+    if (env_max && env_max[0] != '\0') {
+        long kb = strtol(env_max, NULL, 10);
+        if (kb * 1024L >= LOG_MIN_MAX_BYTES) {
+            logger.max_bytes = kb * 1024L;
+        }
+    }
+    
+    // Deferred-format binary records (decode with hyprswitcher-logdecode)
+    const char *env_format = getenv("HYPRSWITCHER_LOG_FORMAT");
+    logger.binary = (env_format && strcasecmp(env_format, "binary") == 0);
     
     // Open log file if path provided
     if (filepath && filepath[0] != '\0') {
-        logger.file = fopen(filepath, "a");
+        snprintf(logger.filepath, sizeof(logger.filepath),
+                 logger.binary ? "%s.bin" : "%s", filepath);
+        logger.file = open_log_file(logger.filepath);
         if (!logger.file) {
             fprintf(stderr, "Failed to open log file: %s\n", filepath);
             // Continue without file logging
+        } else if (logger.bytes_written >= logger.max_bytes) {
+            rotate_log_file();
         }
     }
     
+    logger.last_flush = time(NULL);
     logger.initialized = 1;
     
     return 0;
@@ -88,12 +356,53 @@ int log_init(const char *filepath, LogLevel level) {
 
 // Close logger
 void log_close(void) {
+    pthread_mutex_lock(&logger.lock);
+    if (logger.binary) {
+        binlog_flush();
+    }
     if (logger.file) {
         fflush(logger.file);
         fclose(logger.file);
         logger.file = NULL;
     }
+    fflush(stdout);
     logger.initialized = 0;
+    pthread_mutex_unlock(&logger.lock);
+}
+
+// Write out buffered lines and records
+void log_flush(void) {
+    pthread_mutex_lock(&logger.lock);
+    if (logger.binary) {
+        binlog_flush();
+    }
+    if (logger.file) {
+        fflush(logger.file);
+    }
+    fflush(stdout);
+    fflush(stderr);
+    logger.last_flush = time(NULL);
+    pthread_mutex_unlock(&logger.lock);
+}
+
+// Switch to a fresh descriptor for the file now at logger.filepath
+void log_reopen(void) {
+    pthread_mutex_lock(&logger.lock);
+    if (logger.file) {
+        if (logger.binary) {
+            binlog_flush();
+        }
+        fclose(logger.file);
+        logger.file = open_log_file(logger.filepath);
+    }
+    pthread_mutex_unlock(&logger.lock);
+}
+
+// Choose where the console copy of each line goes (LOG_CONSOLE_*)
+void log_set_console(int mode) {
+    pthread_mutex_lock(&logger.lock);
+    logger.console = mode;
+    pthread_mutex_unlock(&logger.lock);
 }
 
 // Set log level
@@ -118,6 +427,9 @@ static void get_timestamp(char *buffer, size_t size) {
     strftime(buffer, size, "%Y-%m-%d %H:%M:%S", tm_info);
 }
 
+static void log_message_text(LogLevel level, const char *file, int line,
+                             const char *fmt, va_list ap);
+
 // Core logging function
 void log_message(LogLevel level, const char *file, int line, const char *fmt, ...) {
     // Skip if level is below threshold
@@ -129,6 +441,54 @@ void log_message(LogLevel level, const char *file, int line, const char *fmt, ..
     if (level < LOG_DEBUG || level > LOG_ERROR) {
         return;
     }
+
+    va_list ap;
+    va_start(ap, fmt);
+    log_message_text(level, file, line, fmt, ap);
+    va_end(ap);
+}
+
+// Logging entry point for the LOG_* macros
+void log_message_site(LogSite *site, const char *fmt, ...) {
+    LogLevel level = site->level;
+    if (level < logger.level || level < LOG_DEBUG || level > LOG_ERROR) {
+        return;
+    }
+
+    va_list ap;
+    va_start(ap, fmt);
+
+    if (logger.binary && logger.file) {
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        pthread_mutex_lock(&logger.lock);
+        if (site->id == 0) {
+            site->nargs = (int8_t)binlog_arg_types(fmt, site->arg_types,
+                                                   (int)sizeof(site->arg_types));
+            site->id = ++binlog.next_site_id;
+        }
+        if (site->nargs >= 0) {
+            binlog_record(site, fmt,
+                          (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec, ap);
+
+            if (level >= LOG_WARN || ts.tv_sec - logger.last_flush >= LOG_FLUSH_INTERVAL_SEC) {
+                binlog_flush();
+                logger.last_flush = ts.tv_sec;
+            }
+            pthread_mutex_unlock(&logger.lock);
+            va_end(ap);
+            return;
+        }
+        pthread_mutex_unlock(&logger.lock);
+    }
+
+    log_message_text(level, site->file, site->line, fmt, ap);
+    va_end(ap);
+}
+
+// Text formatting path (console and, outside binary mode, the log file)
+static void log_message_text(LogLevel level, const char *file, int line,
+                             const char *fmt, va_list ap) {
     
     char timestamp[24];
     get_timestamp(timestamp, sizeof(timestamp));
@@ -142,34 +502,54 @@ void log_message(LogLevel level, const char *file, int line, const char *fmt, ..
 
     va_list args;
 
-    // Log to console with colors
-    printf("%s[%s] [%s] [%s:%d] ",
-           level_colors[level],
-           timestamp,
-           level_strings[level],
-           filename,
-           line);
-
-    va_start(args, fmt);
-    vprintf(fmt, args);
-    va_end(args);
-
-    printf("%s\n", COLOR_RESET);
-    fflush(stdout);
+    pthread_mutex_lock(&logger.lock);
 
-    // Log to file (no colors)
-    if (logger.file) {
-        fprintf(logger.file, "[%s] [%s] [%s:%d] ",
+    // Log to console with colors (stdio buffering batches the writes)
+    FILE *console = logger.console == LOG_CONSOLE_STDERR ? stderr : stdout;
+    if (logger.console != LOG_CONSOLE_OFF) {
+        fprintf(console, "%s[%s] [%s] [%s:%d] ",
+                level_colors[level],
                 timestamp,
                 level_strings[level],
                 filename,
                 line);
 
-        va_start(args, fmt);
-        vfprintf(logger.file, fmt, args);
+        va_copy(args, ap);
+        vfprintf(console, fmt, args);
         va_end(args);
 
-        fprintf(logger.file, "\n");
-        fflush(logger.file);
+        fprintf(console, "%s\n", COLOR_RESET);
     }
+
+    // Log to file (no colors); binary logs only take encodable records
+    if (logger.file && !logger.binary) {
+        int n = fprintf(logger.file, "[%s] [%s] [%s:%d] ",
+                        timestamp,
+                        level_strings[level],
+                        filename,
+                        line);
+        if (n > 0) logger.bytes_written += n;
+
+        va_copy(args, ap);
+        n = vfprintf(logger.file, fmt, args);
+        va_end(args);
+        if (n > 0) logger.bytes_written += n;
+
+        fputc('\n', logger.file);
+        logger.bytes_written++;
+
+        if (logger.bytes_written >= logger.max_bytes) {
+            rotate_log_file();
+        }
+    }
+
+    // Flush warnings immediately; everything else at most once per second
+    time_t now = time(NULL);
+    if (level >= LOG_WARN || now - logger.last_flush >= LOG_FLUSH_INTERVAL_SEC) {
+        if (logger.file && !logger.binary) fflush(logger.file);
+        fflush(console);
+        logger.last_flush = now;
+    }
+
+    pthread_mutex_unlock(&logger.lock);
 }
\ No newline at end of file
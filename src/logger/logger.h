@@ -2,6 +2,7 @@
 #define LOGGER_H
 
 #include <stdlib.h>
+#include <stdint.h>
 
 // Log levels
 typedef enum {
@@ -11,18 +12,52 @@ typedef enum {
     LOG_ERROR
 } LogLevel;
 
+// Static per-call-site descriptor created by the LOG_* macros. In binary
+// mode (HYPRSWITCHER_LOG_FORMAT=binary) a call records only the site id,
+// a timestamp and the raw argument bytes; formatting happens offline in
+// hyprswitcher-logdecode.
+typedef struct {
+    const char *file;
+    int line;
+    LogLevel level;
+    uint32_t id;           // assigned on first use (0 = not yet)
+    uint32_t generation;   // log file generation the definition was written to
+    int8_t nargs;          // -1 = format cannot be encoded, log as text
+    uint8_t arg_types[16]; // BinlogArgType per argument
+} LogSite;
+
 // Function declarations
+// The log file is size-capped (1 MiB, HYPRSWITCHER_LOG_MAX_KB overrides) and
+// rotated to <filepath>.1; writes are buffered and flushed at most once per
+// second, or immediately for WARN and ERROR. NULL filepath logs to stdout only.
 int log_init(const char *filepath, LogLevel level);
 void log_close(void);
+// Write out everything buffered (file, binary records, stdout), e.g. before fork().
+void log_flush(void);
+// Reopen the log file by path: after fork() the inherited descriptor may be
+// rotated away by another process and would keep receiving the lines.
+void log_reopen(void);
 void log_set_level(LogLevel level);
+// Console copy of each line: off, stdout (default), or stderr for a host
+// process whose stdout is not ours (0 = off also suits commands whose stdout is data).
+#define LOG_CONSOLE_OFF    0
+#define LOG_CONSOLE_STDOUT 1
+#define LOG_CONSOLE_STDERR 2
+void log_set_console(int mode);
 LogLevel log_get_level(void);
 int log_level_enabled(LogLevel level);
 void log_message(LogLevel level, const char *file, int line, const char *fmt, ...);
+void log_message_site(LogSite *site, const char *fmt, ...);
 
 // Convenience macros
-#define LOG_DEBUG(...) log_message(LOG_DEBUG, __FILE__, __LINE__, __VA_ARGS__)
-#define LOG_INFO(...)  log_message(LOG_INFO,  __FILE__, __LINE__, __VA_ARGS__)
-#define LOG_WARN(...)  log_message(LOG_WARN,  __FILE__, __LINE__, __VA_ARGS__)
-#define LOG_ERROR(...) log_message(LOG_ERROR, __FILE__, __LINE__, __VA_ARGS__)
+#define LOG_AT_SITE(lvl, ...) do { \
+        static LogSite log_site_ = { __FILE__, __LINE__, lvl, 0, 0, 0, {0} }; \
+        log_message_site(&log_site_, __VA_ARGS__); \
+    } while (0)
+
+#define LOG_DEBUG(...) LOG_AT_SITE(LOG_DEBUG, __VA_ARGS__)
+#define LOG_INFO(...)  LOG_AT_SITE(LOG_INFO,  __VA_ARGS__)
+#define LOG_WARN(...)  LOG_AT_SITE(LOG_WARN,  __VA_ARGS__)
+#define LOG_ERROR(...) LOG_AT_SITE(LOG_ERROR, __VA_ARGS__)
 
 #endif
\ No newline at end of file
@@ -1,8 +1,17 @@
 #include "wayland.h"
 #include "ipc.h"
 #include "switcher_ipc.h"
+#include "switcher_ring.h"
 #include "config.h"
+#include "hypr_caps.h"
+#include "flight.h"
+#include "hypr_worker.h"
+#include "run_or_raise.h"
+#include "list_output.h"
+#include "fork_server.h"
 #include "logger/logger.h"
+#include <errno.h>
+#include <poll.h>
 #include <stdio.h>
 #include <string.h>
 #include <unistd.h>
@@ -17,8 +26,10 @@
  *     - Listens for commands from helper instances
  *
  *   - Subsequent invocations: become "helper instances"
- *     - Connect to existing socket
- *     - Send command (CYCLE, CYCLE_BACKWARD, COMMIT, CANCEL)
+ *     - Publish into the shared command ring if enabled (command_ring=true),
+ *       otherwise connect to the existing socket
+ *     - Send command (CYCLE, CYCLE_BACKWARD, COMMIT, CANCEL, PREPARE, SORT_*,
+ *       CLASS, CLASS_BACKWARD)
  *     - Exit immediately
  *
  * This allows Hyprland to use a simple binding:
@@ -26,21 +37,81 @@
  *
  * Each Alt+Tab press spawns hyprswitcher, but only the first one shows the overlay.
  * Subsequent presses just send cycle commands to the existing instance.
+ *
+ * With --prepare bound to the Alt press itself, the main instance starts
+ * (and draws) before Tab, hidden; the Tab's CYCLE then only maps it.
+ *
+ * With show_delay_ms set, a main instance waits that long before creating
+ * anything; a COMMIT (Alt released) in the meantime switches to the
+ * previous window with one Hyprland dispatch and exits.
+ *
+ * --focus-class / --focus-title never become either: they focus a matching
+ * window (or --launch a command) over Hyprland IPC and exit. --list prints
+ * the window list, from a running main instance if there is one.
+ *
+ * With a --fork-server running (fork_server.h), a helper that finds no
+ * main instance asks it instead, and a child forked from the already
+ * initialized server becomes the main instance.
  */
 
 typedef enum {
     CMD_CYCLE,
     CMD_CYCLE_BACKWARD,
     CMD_COMMIT,
-    CMD_CANCEL
+    CMD_CANCEL,
+    CMD_PREPARE,
+    CMD_SORT,
+    CMD_CLASS,
+    CMD_CLASS_BACKWARD,
+    CMD_RAISE,
+    CMD_LIST,
+    CMD_FORK_SERVER
 } CommandType;
 
+/* Order requested with --sort (CMD_SORT only) */
+static SortOrder g_sort_order = SORT_ORDER_MRU;
+
+/* --focus-class / --focus-title / --launch (CMD_RAISE only) */
+static RaiseRequest g_raise;
+
+/* --format (CMD_LIST only) */
+static ListFormat g_list_format = LIST_FORMAT_TSV;
+
+static const char *const list_command_strings[LIST_FORMAT_COUNT] = {
+    [LIST_FORMAT_TSV]  = SWITCHER_CMD_LIST_TSV,
+    [LIST_FORMAT_JSON] = SWITCHER_CMD_LIST_JSON,
+    [LIST_FORMAT_BIN]  = SWITCHER_CMD_LIST_BIN,
+};
+
+static const char *const sort_command_strings[SORT_ORDER_COUNT] = {
+    [SORT_ORDER_MRU]       = SWITCHER_CMD_SORT_MRU,
+    [SORT_ORDER_CLASS]     = SWITCHER_CMD_SORT_CLASS,
+    [SORT_ORDER_WORKSPACE] = SWITCHER_CMD_SORT_WORKSPACE,
+    [SORT_ORDER_MONITOR]   = SWITCHER_CMD_SORT_MONITOR,
+};
+
 static void print_usage(const char *prog) {
     fprintf(stderr, "Usage: %s [OPTIONS]\n", prog);
     fprintf(stderr, "\nOptions:\n");
     fprintf(stderr, "  --backward, -b    Send CYCLE_BACKWARD instead of CYCLE (for Shift+Alt+Tab)\n");
+    fprintf(stderr, "  --class, -k       Cycle only the focused application's windows (for Alt+`);\n");
+    fprintf(stderr, "                    with --backward, in reverse\n");
     fprintf(stderr, "  --commit, -c      Send COMMIT to focus selected window and close overlay\n");
     fprintf(stderr, "  --cancel, -x      Send CANCEL to restore original focus and close overlay\n");
+    fprintf(stderr, "  --prepare, -p     Warm up for an imminent Alt+Tab (bind to the Alt press);\n");
+    fprintf(stderr, "                    the overlay stays hidden until Tab\n");
+    fprintf(stderr, "  --sort, -s ORDER  Reorder the list: mru, class, workspace or monitor\n");
+    fprintf(stderr, "                    (starts the overlay in that order if none is open)\n");
+    fprintf(stderr, "  --focus-class CLASS\n");
+    fprintf(stderr, "                    Focus the most recent window of CLASS (or the next one if\n");
+    fprintf(stderr, "                    it already has focus) without showing the overlay\n");
+    fprintf(stderr, "  --focus-title REGEX\n");
+    fprintf(stderr, "                    Same, matching the title (combines with --focus-class)\n");
+    fprintf(stderr, "  --launch CMD      With --focus-*: run CMD through Hyprland if nothing matches\n");
+    fprintf(stderr, "  --list, -l        Print the windows in switcher order and exit (no overlay)\n");
+    fprintf(stderr, "  --format FORMAT   Output of --list: tsv (default), json or bin\n");
+    fprintf(stderr, "  --fork-server     Stay resident, initialized, and fork a fresh main instance\n");
+    fprintf(stderr, "                    for each Alt+Tab session (e.g. from exec-once)\n");
     fprintf(stderr, "  --help, -h        Show this help message\n");
     fprintf(stderr, "\nIf a main instance is already running, sends the specified command and exits.\n");
     fprintf(stderr, "Otherwise, becomes the main instance and shows the overlay.\n");
@@ -53,31 +124,335 @@ static const char *command_to_string(CommandType cmd) {
         case CMD_CYCLE_BACKWARD: return SWITCHER_CMD_CYCLE_BACKWARD;
         case CMD_COMMIT:         return SWITCHER_CMD_COMMIT;
         case CMD_CANCEL:         return SWITCHER_CMD_CANCEL;
+        case CMD_PREPARE:        return SWITCHER_CMD_PREPARE;
+        case CMD_SORT:           return sort_command_strings[g_sort_order];
+        case CMD_CLASS:          return SWITCHER_CMD_CLASS;
+        case CMD_CLASS_BACKWARD: return SWITCHER_CMD_CLASS_BACKWARD;
         default:                 return SWITCHER_CMD_CYCLE;
     }
 }
 
+static SwitcherCmdType command_to_type(CommandType cmd) {
+    switch (cmd) {
+        case CMD_CYCLE:          return SWITCHER_CMD_TYPE_CYCLE;
+        case CMD_CYCLE_BACKWARD: return SWITCHER_CMD_TYPE_CYCLE_BACKWARD;
+        case CMD_COMMIT:         return SWITCHER_CMD_TYPE_COMMIT;
+        case CMD_CANCEL:         return SWITCHER_CMD_TYPE_CANCEL;
+        case CMD_PREPARE:        return SWITCHER_CMD_TYPE_PREPARE;
+        case CMD_SORT:           return (SwitcherCmdType)(SWITCHER_CMD_TYPE_SORT_MRU + g_sort_order);
+        case CMD_CLASS:          return SWITCHER_CMD_TYPE_CLASS;
+        case CMD_CLASS_BACKWARD: return SWITCHER_CMD_TYPE_CLASS_BACKWARD;
+        default:                 return SWITCHER_CMD_TYPE_CYCLE;
+    }
+}
+
+/* Session command received by the fork server (see starts_session()) */
+static CommandType command_from_type(SwitcherCmdType type) {
+    switch (type) {
+        case SWITCHER_CMD_TYPE_CYCLE_BACKWARD: return CMD_CYCLE_BACKWARD;
+        case SWITCHER_CMD_TYPE_PREPARE:        return CMD_PREPARE;
+        case SWITCHER_CMD_TYPE_CLASS:          return CMD_CLASS;
+        case SWITCHER_CMD_TYPE_CLASS_BACKWARD: return CMD_CLASS_BACKWARD;
+        case SWITCHER_CMD_TYPE_SORT_MRU:
+        case SWITCHER_CMD_TYPE_SORT_CLASS:
+        case SWITCHER_CMD_TYPE_SORT_WORKSPACE:
+        case SWITCHER_CMD_TYPE_SORT_MONITOR:
+            g_sort_order = (SortOrder)(SORT_ORDER_MRU + (type - SWITCHER_CMD_TYPE_SORT_MRU));
+            return CMD_SORT;
+        default:                               return CMD_CYCLE;
+    }
+}
+
 static const char *command_name(CommandType cmd) {
     switch (cmd) {
         case CMD_CYCLE:          return "CYCLE";
         case CMD_CYCLE_BACKWARD: return "CYCLE_BACKWARD";
         case CMD_COMMIT:         return "COMMIT";
         case CMD_CANCEL:         return "CANCEL";
+        case CMD_PREPARE:        return "PREPARE";
+        case CMD_SORT:           return sort_command_strings[g_sort_order];
+        case CMD_CLASS:          return "CLASS";
+        case CMD_CLASS_BACKWARD: return "CLASS_BACKWARD";
+        case CMD_RAISE:          return "RAISE";
+        case CMD_LIST:           return list_command_strings[g_list_format];
+        case CMD_FORK_SERVER:    return "FORK_SERVER";
         default:                 return "CYCLE";
     }
 }
 
+typedef enum {
+    QUICK_TAP_WAIT,      /* keep waiting for the delay to run out */
+    QUICK_TAP_SHOW,      /* Alt is still held: create the overlay now */
+    QUICK_TAP_DONE       /* session over without an overlay */
+} QuickTapResult;
+
+static QuickTapResult quick_tap_command(SwitcherCmdType cmd) {
+    switch (cmd) {
+        case SWITCHER_CMD_TYPE_COMMIT:
+            if (hypr_ipc_focus_last() == 0) {
+                LOG_INFO("[MAIN] Quick tap: focused the previous window");
+            } else {
+                LOG_WARN("[MAIN] Quick tap: focuscurrentorlast failed");
+            }
+            return QUICK_TAP_DONE;
+        case SWITCHER_CMD_TYPE_CANCEL:
+            LOG_INFO("[MAIN] Quick tap cancelled");
+            return QUICK_TAP_DONE;
+        case SWITCHER_CMD_TYPE_CYCLE:
+            wayland_add_startup_cycles(1);
+            return QUICK_TAP_SHOW;
+        case SWITCHER_CMD_TYPE_CYCLE_BACKWARD:
+            wayland_add_startup_cycles(-1);
+            return QUICK_TAP_SHOW;
+        case SWITCHER_CMD_TYPE_CLASS:
+        case SWITCHER_CMD_TYPE_CLASS_BACKWARD:
+            wayland_add_startup_class_cycles(cmd == SWITCHER_CMD_TYPE_CLASS ? 1 : -1);
+            return QUICK_TAP_SHOW;
+        case SWITCHER_CMD_TYPE_SORT_MRU:
+        case SWITCHER_CMD_TYPE_SORT_CLASS:
+        case SWITCHER_CMD_TYPE_SORT_WORKSPACE:
+        case SWITCHER_CMD_TYPE_SORT_MONITOR:
+            config_get_mut()->sort_order =
+                (SortOrder)(SORT_ORDER_MRU + (cmd - SWITCHER_CMD_TYPE_SORT_MRU));
+            return QUICK_TAP_SHOW;
+        default:
+            return QUICK_TAP_WAIT;   /* PREPARE, unknown */
+    }
+}
+
+/*
+ * Wait up to show_delay_ms for helper commands before creating the
+ * overlay. Commands after the one that decides are left queued for the
+ * event loop.
+ *
+ * Returns:
+ *   true if the session ended (quick tap or cancel); nothing was created
+ */
+static bool quick_tap_wait(int listen_fd, int ring_fd) {
+    uint64_t deadline = flight_now() + (uint64_t)config_get()->show_delay_ms * 1000000ull;
+
+    struct pollfd pfds[2];
+    int nfds = 0;
+    pfds[nfds++] = (struct pollfd){ .fd = listen_fd, .events = POLLIN };
+    if (ring_fd >= 0) {
+        pfds[nfds++] = (struct pollfd){ .fd = ring_fd, .events = POLLIN };
+    }
+
+    for (;;) {
+        uint64_t now = flight_now();
+        if (now >= deadline) {
+            LOG_DEBUG("[MAIN] Alt still held after show_delay_ms; showing overlay");
+            return false;
+        }
+        int timeout_ms = (int)((deadline - now + 999999) / 1000000);
+        if (poll(pfds, (nfds_t)nfds, timeout_ms) < 0 && errno != EINTR) {
+            return false;
+        }
+
+        QuickTapResult r = QUICK_TAP_WAIT;
+        int client_fd;
+        while (r == QUICK_TAP_WAIT && (client_fd = switcher_ipc_accept(listen_fd)) >= 0) {
+            SwitcherCmdType cmd = switcher_ipc_read_command(client_fd);
+            close(client_fd);
+            r = quick_tap_command(cmd);
+        }
+        SwitcherCmdType cmd;
+        while (r == QUICK_TAP_WAIT && ring_fd >= 0 &&
+               (cmd = switcher_ring_pop()) != SWITCHER_CMD_TYPE_NONE) {
+            r = quick_tap_command(cmd);
+        }
+        if (r != QUICK_TAP_WAIT) {
+            return r == QUICK_TAP_DONE;
+        }
+    }
+}
+
+/*
+ * Value of `--name VALUE` or `--name=VALUE` at argv[*i] (advancing *i past
+ * a separate value).
+ *
+ * Returns:
+ *   true if argv[*i] is the option; *value is NULL if it is missing
+ */
+static bool option_value(int argc, char *argv[], int *i, const char *name, const char **value) {
+    size_t len = strlen(name);
+    if (strncmp(argv[*i], name, len) != 0) {
+        return false;
+    }
+    if (argv[*i][len] == '=') {
+        *value = argv[*i] + len + 1;
+        return true;
+    }
+    if (argv[*i][len] != '\0') {
+        return false;
+    }
+    *value = *i + 1 < argc ? argv[++*i] : NULL;
+    return true;
+}
+
+/*
+ * --list: ask the running main instance, whose list is already current,
+ * else query Hyprland once. With own_order (--sort given) the main
+ * instance's order does not apply, so it is skipped.
+ */
+static int list_windows(bool own_order) {
+    int conn_fd = own_order ? -1 : switcher_ipc_try_connect();
+    if (conn_fd >= 0) {
+        long copied = 0;
+        if (switcher_ipc_send(conn_fd, list_command_strings[g_list_format]) == 0) {
+            copied = switcher_ipc_receive_reply(conn_fd, STDOUT_FILENO);
+        }
+        close(conn_fd);
+        if (copied != 0) {
+            return copied > 0 ? 0 : 1;
+        }
+        LOG_INFO("[MAIN] Main instance has no list yet; querying Hyprland");
+    }
+    return list_output_headless(g_list_format, STDOUT_FILENO) == 0 ? 0 : 1;
+}
+
+static int missing_value(const char *prog, const char *option) {
+    fprintf(stderr, "Missing value for %s\n", option);
+    print_usage(prog);
+    return 1;
+}
+
+/*
+ * Become the main instance: own the socket, show the overlay and run the
+ * session. ready_fd (fork server child, else -1) is signalled once the
+ * socket listens; warmed skips what the fork server already did.
+ */
+static int run_main_instance(CommandType command, int ready_fd, bool warmed) {
+    LOG_INFO("[MAIN] No existing instance, becoming main instance");
+
+    /* Verify Hyprland IPC is available */
+    if (!warmed) {
+        hypr_ipc_connect();
+    }
+
+    /* Create listening socket for helper instances */
+    int listen_fd = switcher_ipc_listen();
+    if (listen_fd < 0) {
+        LOG_ERROR("[MAIN] Failed to create IPC socket");
+        log_close();
+        return 1;
+    }
+
+    LOG_INFO("[MAIN] IPC socket created (fd=%d)", listen_fd);
+    fork_server_ready(ready_fd);
+
+    /* Optional shared-memory command ring (socket stays available as fallback) */
+    int ring_fd = -1;
+    if (config_get()->command_ring) {
+        ring_fd = switcher_ring_create();
+        if (ring_fd < 0) {
+            LOG_WARN("[MAIN] Command ring unavailable; using socket only");
+        }
+    }
+
+    /* Quick tap: give Alt show_delay_ms to come back up before creating anything */
+    if (command == CMD_CYCLE && config_get()->show_delay_ms > 0 &&
+        quick_tap_wait(listen_fd, ring_fd)) {
+        switcher_ring_destroy();
+        switcher_ipc_cleanup(listen_fd);
+        LOG_INFO("[MAIN] Main instance exiting");
+        log_close();
+        return 0;
+    }
+
+    /* Specialize IPC paths to this Hyprland instance (cached after first run) */
+    if (!warmed) {
+        hypr_caps_init();
+    }
+
+    /*
+     * Fetch the client list on the IPC worker while Wayland starts up.
+     * Without the worker the list is fetched synchronously on configure.
+     * The toplevel backend gets its list over Wayland instead (init_wayland
+     * requests it here after all if the protocol is unavailable).
+     */
+    if (hypr_worker_start() == 0) {
+        if (config_get()->window_backend == WINDOW_BACKEND_HYPRLAND) {
+            hypr_worker_request_initial_clients();
+        }
+    } else {
+        LOG_WARN("[MAIN] IPC worker unavailable; querying Hyprland on the main thread");
+    }
+
+    /* Initialize Wayland and create overlay (drawn but unmapped if preparing) */
+    init_wayland();
+    if (command == CMD_PREPARE) {
+        wayland_set_prepared();
+    } else if (command == CMD_CLASS || command == CMD_CLASS_BACKWARD) {
+        wayland_add_startup_class_cycles(command == CMD_CLASS ? 1 : -1);
+    }
+    create_layer_surface();
+
+    /* Run the main event loop (handles both Wayland events and IPC commands) */
+    wayland_loop_with_ipc(listen_fd, ring_fd);
+    hypr_worker_stop();
+
+    /* Cleanup (ring file first so the socket directory can be removed) */
+    switcher_ring_destroy();
+    switcher_ipc_cleanup(listen_fd);
+
+    LOG_INFO("[MAIN] Main instance exiting");
+    log_close();
+    return 0;
+}
+
 int main(int argc, char *argv[]) {
     /* Parse arguments */
     CommandType command = CMD_CYCLE;
+    bool list = false;
+    bool sort_given = false;
 
     for (int i = 1; i < argc; i++) {
-        if (strcmp(argv[i], "--backward") == 0 || strcmp(argv[i], "-b") == 0) {
-            command = CMD_CYCLE_BACKWARD;
+        const char *value = NULL;
+        if (option_value(argc, argv, &i, "--focus-class", &value)) {
+            if (!value || !value[0]) return missing_value(argv[0], "--focus-class");
+            g_raise.app_class = value;
+        } else if (option_value(argc, argv, &i, "--focus-title", &value)) {
+            if (!value || !value[0]) return missing_value(argv[0], "--focus-title");
+            g_raise.title = value;
+        } else if (option_value(argc, argv, &i, "--launch", &value)) {
+            if (!value || !value[0]) return missing_value(argv[0], "--launch");
+            g_raise.launch = value;
+        } else if (option_value(argc, argv, &i, "--format", &value)) {
+            if (!list_output_parse_format(value, &g_list_format)) {
+                fprintf(stderr, "Unknown list format: %s\n", value ? value : "(missing)");
+                print_usage(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--fork-server") == 0) {
+            command = CMD_FORK_SERVER;
+        } else if (strcmp(argv[i], "--list") == 0 || strcmp(argv[i], "-l") == 0) {
+            list = true;
+        } else if (strcmp(argv[i], "--backward") == 0 || strcmp(argv[i], "-b") == 0) {
+            command = command == CMD_CLASS ? CMD_CLASS_BACKWARD : CMD_CYCLE_BACKWARD;
+        } else if (strcmp(argv[i], "--class") == 0 || strcmp(argv[i], "-k") == 0) {
+            command = command == CMD_CYCLE_BACKWARD ? CMD_CLASS_BACKWARD : CMD_CLASS;
         } else if (strcmp(argv[i], "--commit") == 0 || strcmp(argv[i], "-c") == 0) {
             command = CMD_COMMIT;
         } else if (strcmp(argv[i], "--cancel") == 0 || strcmp(argv[i], "-x") == 0) {
             command = CMD_CANCEL;
+        } else if (strcmp(argv[i], "--prepare") == 0 || strcmp(argv[i], "-p") == 0) {
+            command = CMD_PREPARE;
+        } else if (strcmp(argv[i], "--sort") == 0 || strcmp(argv[i], "-s") == 0 ||
+                   strncmp(argv[i], "--sort=", 7) == 0) {
+            const char *order = NULL;
+            if (strncmp(argv[i], "--sort=", 7) == 0) {
+                order = argv[i] + 7;
+            } else if (i + 1 < argc) {
+                order = argv[++i];
+            }
+            if (!config_parse_sort_order(order, &g_sort_order)) {
+                fprintf(stderr, "Unknown sort order: %s\n", order ? order : "(missing)");
+                print_usage(argv[0]);
+                return 1;
+            }
+            command = CMD_SORT;
+            sort_given = true;
         } else if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0) {
             print_usage(argv[0]);
             return 0;
@@ -87,18 +462,89 @@ int main(int argc, char *argv[]) {
             return 1;
         }
     }
+    if (list) {
+        command = CMD_LIST;
+    } else if (command == CMD_FORK_SERVER) {
+        /* nothing else applies */
+    } else if (g_raise.app_class || g_raise.title) {
+        command = CMD_RAISE;
+    } else if (g_raise.launch) {
+        fprintf(stderr, "--launch needs --focus-class or --focus-title\n");
+        print_usage(argv[0]);
+        return 1;
+    }
 
-    /* Initialize logger (level can be overridden by HYPRSWITCHER_LOG env var) */
-    if (log_init("logger.log", LOG_INFO) != 0) {
+    /* Initialize logger (level can be overridden by HYPRSWITCHER_LOG env var).
+     * The log lives in $XDG_STATE_HOME/hyprswitcher/ so it never lands in
+     * whatever directory Hyprland happened to start us from. */
+    char log_path[512];
+    char state_dir[384];
+    const char *log_file = NULL;
+    if (config_get_state_dir(state_dir, sizeof(state_dir)) == 0) {
+        snprintf(log_path, sizeof(log_path), "%s/hyprswitcher.log", state_dir);
+        log_file = log_path;
+    }
+    if (log_init(log_file, LOG_INFO) != 0) {
         fprintf(stderr, "Failed to initialize logger\n");
         return 1;
     }
 
+    /* Run-or-raise: one j/clients request and one dispatch, nothing else */
+    if (command == CMD_RAISE) {
+        LOG_INFO("[MAIN] hyprswitcher starting (command=%s)", command_name(command));
+        int rc = run_or_raise(&g_raise);
+        log_close();
+        return rc < 0 ? 1 : rc;
+    }
+
     /* Load configuration (uses defaults if no config file found) */
     config_load();
+    flight_init(config_get()->slo_ms);
+    if (sort_given) {
+        config_get_mut()->sort_order = g_sort_order;
+    }
+
+    /* Resident fork server: returns here in each forked session */
+    if (command == CMD_FORK_SERVER) {
+        LOG_INFO("[MAIN] hyprswitcher starting (command=%s)", command_name(command));
+        hypr_ipc_connect();
+        hypr_caps_init();
+        SwitcherCmdType first = SWITCHER_CMD_TYPE_NONE;
+        int ready_fd = -1;
+        int rc = fork_server_run(&first, &ready_fd);
+        if (rc != 1) {
+            log_close();
+            return rc == 0 ? 0 : 1;
+        }
+        command = command_from_type(first);
+        if (command == CMD_SORT) {
+            config_get_mut()->sort_order = g_sort_order;
+        }
+        LOG_INFO("[MAIN] Forked session (command=%s)", command_name(command));
+        return run_main_instance(command, ready_fd, true);
+    }
+
+    /* --list: stdout is the list, so log lines only go to the file */
+    if (command == CMD_LIST) {
+        log_set_console(LOG_CONSOLE_OFF);
+        int rc = list_windows(sort_given);
+        log_close();
+        return rc;
+    }
 
     LOG_INFO("[MAIN] hyprswitcher starting (command=%s)", command_name(command));
 
+    /*
+     * Fast path: publish the command into the main instance's shared ring.
+     * Falls through to the socket if the ring is missing, stale or full.
+     */
+    if (config_get()->command_ring &&
+        switcher_ring_try_send(command_to_type(command)) == 0) {
+        LOG_INFO("[MAIN] Helper instance exiting after ring send");
+        log_close();
+        return 0;
+    }
+
     /*
      * Try to connect to an existing main instance.
      * If successful, we're a helper instance: send command and exit.
@@ -134,35 +580,19 @@ int main(int argc, char *argv[]) {
         return 0;
     }
 
-    /*
-     * We become the main instance.
-     */
-    LOG_INFO("[MAIN] No existing instance, becoming main instance");
-
-    /* Verify Hyprland IPC is available */
-    hypr_ipc_connect();
-
-    /* Create listening socket for helper instances */
-    int listen_fd = switcher_ipc_listen();
-    if (listen_fd < 0) {
-        LOG_ERROR("[MAIN] Failed to create IPC socket");
+    /* A resident fork server starts the session from its warm image */
+    int forked = fork_server_request(command_to_string(command));
+    if (forked == FORK_SERVER_STARTED) {
+        LOG_INFO("[MAIN] Fork server started the session");
         log_close();
-        return 1;
+        return 0;
+    }
+    if (forked == FORK_SERVER_RUNNING && (conn_fd = switcher_ipc_try_connect()) >= 0) {
+        int ret = switcher_ipc_send(conn_fd, command_to_string(command));
+        close(conn_fd);
+        log_close();
+        return ret == 0 ? 0 : 1;
     }
 
-    LOG_INFO("[MAIN] IPC socket created (fd=%d)", listen_fd);
-
-    /* Initialize Wayland and create overlay */
-    init_wayland();
-    create_layer_surface();
-
-    /* Run the main event loop (handles both Wayland events and IPC commands) */
-    wayland_loop_with_ipc(listen_fd);
-
-    /* Cleanup */
-    switcher_ipc_cleanup(listen_fd);
-
-    LOG_INFO("[MAIN] Main instance exiting");
-    log_close();
-    return 0;
+    return run_main_instance(command, -1, false);
 }
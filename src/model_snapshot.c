@@ -0,0 +1,186 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "model_snapshot.h"
+#include "logger/logger.h"
+
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct Snapshot {
+    ModelSnapshot pub;               /* First: readers get &pub */
+    atomic_uint refs;                /* Readers, plus one while current */
+    struct Snapshot *next_retired;   /* Writer-only list */
+} Snapshot;
+
+/*
+ * Reclamation protocol (all accesses seq_cst):
+ *   reader: hazard = p; re-check current == p; refs++; hazard = NULL
+ *   writer: current = new; refs-- on old; later free old once
+ *           no hazard points at it *and then* refs == 0
+ * A reader whose re-check passed announced p before it was replaced, so
+ * the writer's hazard scan sees it until refs++ is visible.
+ */
+static _Atomic(Snapshot *) s_current = NULL;
+static _Atomic(Snapshot *) s_hazards[MODEL_SNAPSHOT_READERS];
+static atomic_flag s_slot_busy[MODEL_SNAPSHOT_READERS];
+
+/* Writer-side state */
+static Snapshot *s_retired = NULL;
+static uint64_t s_published_gen = 0;
+
+static size_t string_size(const char *s) {
+    return s ? strlen(s) + 1 : 1;
+}
+
+static const char *copy_string(char **cursor, const char *s) {
+    char *dst = *cursor;
+    size_t n = string_size(s);
+    if (s) {
+        memcpy(dst, s, n);
+    } else {
+        dst[0] = '\0';
+    }
+    *cursor += n;
+    return dst;
+}
+
+/* Copy the model into one allocation: header, rows, MRU map, strings */
+static Snapshot *snapshot_build(const ClientModel *m) {
+    size_t count = client_model_count(m);
+    size_t strings = 0;
+    for (size_t i = 0; i < count; i++) {
+        const HyprClientInfo *info = client_model_at(m, i);
+        strings += string_size(info->address) + string_size(info->app_class) +
+                   string_size(info->title);
+    }
+
+    size_t rows_off = (sizeof(Snapshot) + _Alignof(ModelRow) - 1) & ~(_Alignof(ModelRow) - 1);
+    size_t mru_off = rows_off + count * sizeof(ModelRow);
+    size_t str_off = mru_off + count * sizeof(uint32_t);
+    char *block = malloc(str_off + strings);
+    if (!block) {
+        LOG_ERROR("[SNAPSHOT] Out of memory copying %zu windows", count);
+        return NULL;
+    }
+
+    Snapshot *snap = (Snapshot *)block;
+    ModelRow *rows = (ModelRow *)(block + rows_off);
+    uint32_t *mru = (uint32_t *)(block + mru_off);
+    char *cursor = block + str_off;
+
+    for (size_t i = 0; i < count; i++) {
+        const HyprClientInfo *info = client_model_at(m, i);
+        rows[i].address = copy_string(&cursor, info->address);
+        rows[i].app_class = copy_string(&cursor, info->app_class);
+        rows[i].title = copy_string(&cursor, info->title);
+        rows[i].workspace_id = info->workspace_id;
+        rows[i].monitor_id = info->monitor_id;
+        rows[i].focused = info->focused;
+    }
+    for (size_t i = 0; i < count; i++) {
+        const HyprClientInfo *info = client_model_mru_at(m, i);
+        int row = client_model_index_of(m, info->address);
+        mru[i] = row >= 0 ? (uint32_t)row : 0;
+    }
+
+    snap->pub.generation = client_model_generation(m);
+    snap->pub.order = client_model_get_order(m);
+    snap->pub.count = count;
+    snap->pub.rows = rows;
+    snap->pub.mru = mru;
+    atomic_init(&snap->refs, 1);
+    snap->next_retired = NULL;
+    return snap;
+}
+
+static bool snapshot_hazarded(const Snapshot *snap) {
+    for (size_t i = 0; i < MODEL_SNAPSHOT_READERS; i++) {
+        if (atomic_load(&s_hazards[i]) == snap) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Free retired snapshots that no reader can reach any more */
+static void reclaim_retired(void) {
+    Snapshot **pp = &s_retired;
+    while (*pp) {
+        Snapshot *snap = *pp;
+        if (!snapshot_hazarded(snap) && atomic_load(&snap->refs) == 0) {
+            *pp = snap->next_retired;
+            free(snap);
+        } else {
+            pp = &snap->next_retired;
+        }
+    }
+}
+
+bool model_snapshot_publish(const ClientModel *m) {
+    bool published = false;
+    Snapshot *current = atomic_load(&s_current);
+    if (m && (!current || client_model_generation(m) != s_published_gen)) {
+        Snapshot *snap = snapshot_build(m);
+        if (snap) {
+            Snapshot *old = atomic_exchange(&s_current, snap);
+            s_published_gen = snap->pub.generation;
+            if (old) {
+                atomic_fetch_sub(&old->refs, 1);
+                old->next_retired = s_retired;
+                s_retired = old;
+            }
+            published = true;
+        }
+    }
+    reclaim_retired();
+    return published;
+}
+
+const ModelSnapshot *model_snapshot_acquire(void) {
+    /* Claim a hazard slot; only other readers can hold them, and briefly */
+    size_t slot = 0;
+    while (atomic_flag_test_and_set(&s_slot_busy[slot])) {
+        if (++slot == MODEL_SNAPSHOT_READERS) {
+            slot = 0;
+            sched_yield();
+        }
+    }
+
+    Snapshot *snap;
+    do {
+        snap = atomic_load(&s_current);
+        atomic_store(&s_hazards[slot], snap);
+    } while (snap != atomic_load(&s_current));
+    if (snap) {
+        atomic_fetch_add(&snap->refs, 1);
+    }
+    atomic_store(&s_hazards[slot], NULL);
+    atomic_flag_clear(&s_slot_busy[slot]);
+
+    return snap ? &snap->pub : NULL;
+}
+
+void model_snapshot_release(const ModelSnapshot *snapshot) {
+    if (snapshot) {
+        /* The writer frees it on a later publish once refs reaches 0 */
+        Snapshot *snap = (Snapshot *)snapshot;
+        atomic_fetch_sub(&snap->refs, 1);
+    }
+}
+
+void model_snapshot_shutdown(void) {
+    Snapshot *current = atomic_exchange(&s_current, NULL);
+    free(current);
+    while (s_retired) {
+        Snapshot *snap = s_retired;
+        s_retired = snap->next_retired;
+        if (atomic_load(&snap->refs) != 0) {
+            LOG_WARN("[SNAPSHOT] Freeing snapshot still held by %u reader(s)",
+                     atomic_load(&snap->refs));
+        }
+        free(snap);
+    }
+    s_published_gen = 0;
+}
@@ -0,0 +1,77 @@
+#pragma once
+/*
+ * model_snapshot.h - Immutable copies of the window list for readers
+ *
+ * The client model is mutated in place by the event thread, which also
+ * renders straight from it. Readers that are not that thread, or that
+ * need the list to outlive the next change (LIST replies, and later query
+ * or export threads), read a published snapshot instead: an immutable
+ * copy of the rows in the current order. The writer publishes on demand,
+ * before such a read, so changes nobody reads (e.g. throttled titles) are
+ * never copied.
+ *
+ * Readers pin the current snapshot with model_snapshot_acquire() and drop
+ * it with model_snapshot_release(); neither blocks or waits for the
+ * writer. The writer never waits for readers either: a replaced snapshot
+ * is retired and freed by a later publish once no reader holds it.
+ *
+ * Only one thread (the one owning the ClientModel) may publish.
+ */
+
+#ifndef MODEL_SNAPSHOT_H
+#define MODEL_SNAPSHOT_H
+
+#include "client_model.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Maximum number of concurrent model_snapshot_acquire() calls */
+#define MODEL_SNAPSHOT_READERS 16
+
+typedef struct {
+    const char *address;
+    const char *app_class;
+    const char *title;
+    int workspace_id;
+    int monitor_id;
+    bool focused;
+} ModelRow;
+
+typedef struct {
+    uint64_t generation;     /* client_model_generation() it was taken at */
+    SortOrder order;
+    size_t count;
+    const ModelRow *rows;    /* In `order` */
+    const uint32_t *mru;     /* mru[i]: row of the i-th most recently focused window */
+} ModelSnapshot;
+
+/*
+ * Publish the model's current contents if they changed since the last
+ * publish, then free retired snapshots no reader holds. Writer only.
+ *
+ * Returns:
+ *   true if a new snapshot was published
+ */
+bool model_snapshot_publish(const ClientModel *m);
+
+/*
+ * Pin the latest snapshot. Safe from any thread; lock-free against the
+ * writer.
+ *
+ * Returns:
+ *   Snapshot (release with model_snapshot_release), or NULL if nothing
+ *   was published yet
+ */
+const ModelSnapshot *model_snapshot_acquire(void);
+
+/* Drop a pinned snapshot (NULL is ignored). Safe from any thread. */
+void model_snapshot_release(const ModelSnapshot *snapshot);
+
+/*
+ * Free the current and all retired snapshots. Call after every reader
+ * has stopped.
+ */
+void model_snapshot_shutdown(void);
+
+#endif /* MODEL_SNAPSHOT_H */
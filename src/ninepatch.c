@@ -0,0 +1,157 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "ninepatch.h"
+#include "logger/logger.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+bool nine_patch_create(NinePatch *np, int inset) {
+    np->image = NULL;
+    np->inset = inset;
+    if (inset < 0) {
+        return false;
+    }
+
+    int size = 2 * inset + 1;
+    cairo_surface_t *image = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, size, size);
+    if (cairo_surface_status(image) != CAIRO_STATUS_SUCCESS) {
+        LOG_ERROR("[NINEPATCH] Failed to allocate %dx%d template", size, size);
+        cairo_surface_destroy(image);
+        return false;
+    }
+    np->image = image;
+    return true;
+}
+
+void nine_patch_destroy(NinePatch *np) {
+    if (np->image) {
+        cairo_surface_destroy(np->image);
+        np->image = NULL;
+    }
+}
+
+bool nine_patch_fits(const NinePatch *np, int w, int h) {
+    int size = 2 * np->inset + 1;
+    return np->image && w >= size && h >= size;
+}
+
+/* Fill n pixels with one value by doubling memcpys */
+static void fill_span(uint32_t *dst, uint32_t value, int n) {
+    if (n <= 0) {
+        return;
+    }
+    dst[0] = value;
+    int done = 1;
+    while (done < n) {
+        int chunk = done < n - done ? done : n - done;
+        memcpy(dst + done, dst, (size_t)chunk * sizeof(uint32_t));
+        done += chunk;
+    }
+}
+
+/* Expand one template row into a full-width destination row */
+static void blit_row(uint32_t *dst, const uint32_t *src, int inset, int w) {
+    memcpy(dst, src, (size_t)inset * sizeof(uint32_t));
+    fill_span(dst + inset, src[inset], w - 2 * inset);
+    memcpy(dst + w - inset, src + inset + 1, (size_t)inset * sizeof(uint32_t));
+}
+
+void nine_patch_blit(const NinePatch *np, cairo_surface_t *dst,
+                     int x, int y, int w, int h) {
+    if (!nine_patch_fits(np, w, h)) {
+        return;
+    }
+
+    int dst_w = cairo_image_surface_get_width(dst);
+    int dst_h = cairo_image_surface_get_height(dst);
+    if (x < 0 || y < 0 || x + w > dst_w || y + h > dst_h) {
+        /* Partial blits would need per-row clipping of the corners; the
+         * renderer never asks for one, so treat it as a caller bug. */
+        LOG_WARN("[NINEPATCH] Blit %dx%d+%d+%d outside %dx%d surface",
+                 w, h, x, y, dst_w, dst_h);
+        return;
+    }
+
+    cairo_surface_flush(np->image);
+    cairo_surface_flush(dst);
+
+    const unsigned char *src_data = cairo_image_surface_get_data(np->image);
+    int src_stride = cairo_image_surface_get_stride(np->image);
+    unsigned char *dst_data = cairo_image_surface_get_data(dst);
+    int dst_stride = cairo_image_surface_get_stride(dst);
+    int inset = np->inset;
+    size_t row_bytes = (size_t)w * sizeof(uint32_t);
+
+    for (int dy = 0; dy < h; dy++) {
+        uint32_t *out = (uint32_t *)(dst_data + (size_t)(y + dy) * dst_stride) + x;
+        int ty;
+        if (dy < inset) {
+            ty = dy;
+        } else if (dy >= h - inset) {
+            ty = 2 * inset + 1 - (h - dy);
+        } else if (dy > inset) {
+            /* Every middle row is identical to the first one */
+            memcpy(out, (const uint32_t *)(dst_data + (size_t)(y + inset) * dst_stride) + x,
+                   row_bytes);
+            continue;
+        } else {
+            ty = inset;
+        }
+        blit_row(out, (const uint32_t *)(src_data + (size_t)ty * src_stride), inset, w);
+    }
+
+    cairo_surface_mark_dirty_rectangle(dst, x, y, w, h);
+}
+
+/* One box pass over n samples spaced `step` bytes apart, zero outside */
+static void box_pass(unsigned char *data, int n, int step, int radius, unsigned char *tmp) {
+    int window = 2 * radius + 1;
+    unsigned sum = 0;
+    for (int i = 0; i < n; i++) {
+        tmp[i] = data[(size_t)i * step];
+    }
+    for (int i = 0; i < radius && i < n; i++) {
+        sum += tmp[i];
+    }
+    for (int i = 0; i < n; i++) {
+        if (i + radius < n) {
+            sum += tmp[i + radius];
+        }
+        if (i - radius - 1 >= 0) {
+            sum -= tmp[i - radius - 1];
+        }
+        data[(size_t)i * step] = (unsigned char)((sum + (unsigned)window / 2) / (unsigned)window);
+    }
+}
+
+void nine_patch_blur_a8(cairo_surface_t *mask, int radius) {
+    if (radius <= 0 || cairo_image_surface_get_format(mask) != CAIRO_FORMAT_A8) {
+        return;
+    }
+
+    cairo_surface_flush(mask);
+    unsigned char *data = cairo_image_surface_get_data(mask);
+    int w = cairo_image_surface_get_width(mask);
+    int h = cairo_image_surface_get_height(mask);
+    int stride = cairo_image_surface_get_stride(mask);
+
+    unsigned char *tmp = malloc((size_t)(w > h ? w : h));
+    if (!tmp) {
+        LOG_WARN("[NINEPATCH] Out of memory blurring shadow; using a hard edge");
+        return;
+    }
+
+    for (int pass = 0; pass < 3; pass++) {
+        for (int y = 0; y < h; y++) {
+            box_pass(data + (size_t)y * stride, w, 1, radius, tmp);
+        }
+        for (int x = 0; x < w; x++) {
+            box_pass(data + x, h, stride, radius, tmp);
+        }
+    }
+    free(tmp);
+
+    cairo_surface_mark_dirty(mask);
+}
@@ -0,0 +1,62 @@
+#pragma once
+/*
+ * ninepatch.h - Pre-rendered stretchable images for the overlay chrome
+ *
+ * Rounded panels, item highlights and drop shadows only differ along their
+ * edges and corners; everything else is a single repeated pixel. A nine-patch
+ * stores one small square template per look: its corners are copied as-is,
+ * the middle row and column are stretched, and the centre pixel fills the
+ * rest. Anti-aliased arcs and blurred shadows are therefore drawn once per
+ * theme, and each frame only copies rows.
+ *
+ * Blits replace the destination pixels (cairo OPERATOR_SOURCE semantics),
+ * so a template that goes on top of something else must already contain it.
+ */
+
+#ifndef NINEPATCH_H
+#define NINEPATCH_H
+
+#include <cairo/cairo.h>
+#include <stdbool.h>
+
+typedef struct {
+    cairo_surface_t *image;  /* (2 * inset + 1) square ARGB32 template, or NULL */
+    int inset;               /* Corner size in pixels */
+} NinePatch;
+
+/*
+ * Allocate a transparent template for the given corner size.
+ * Draw into np->image with cairo, then use nine_patch_blit().
+ *
+ * Returns:
+ *   true:  Template allocated
+ *   false: Allocation failed (np->image is NULL)
+ */
+bool nine_patch_create(NinePatch *np, int inset);
+
+/* Free the template (safe on a failed or zeroed NinePatch). */
+void nine_patch_destroy(NinePatch *np);
+
+/*
+ * Whether a w x h blit can be produced without squashing the corners.
+ *
+ * Returns:
+ *   true if the template is valid and w, h >= its size
+ */
+bool nine_patch_fits(const NinePatch *np, int w, int h);
+
+/*
+ * Stretch the template over a rectangle of an ARGB32 image surface.
+ * The rectangle is clipped to the surface; nothing is drawn unless
+ * nine_patch_fits(np, w, h).
+ */
+void nine_patch_blit(const NinePatch *np, cairo_surface_t *dst,
+                     int x, int y, int w, int h);
+
+/*
+ * Blur an A8 image surface in place (three box passes, roughly Gaussian,
+ * reaching about 3 * radius pixels). Used once when building shadows.
+ */
+void nine_patch_blur_a8(cairo_surface_t *mask, int radius);
+
+#endif /* NINEPATCH_H */
@@ -1,118 +1,164 @@
-#define _POSIX_C_SOURCE 200112L
+#define _POSIX_C_SOURCE 200809L
 
 #include "render.h"
 #include "config.h"
 #include "wayland.h"
 #include "logger/logger.h"
 #include "util.h"
+#include "text.h"
+#include "flight.h"
+#include "ninepatch.h"
+#include "buffer_pool.h"
+#include "bg_layer.h"
 
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
-#include <unistd.h>
-#include <fcntl.h>
-#include <sys/mman.h>
 #include <cairo/cairo.h>
 #include <pango/pangocairo.h>
 #include <glib.h>
 
-/* Forward declaration for mkstemp */
-int mkstemp(char *template);
-
 /* ============================================================================
  * Buffer Management
  * ============================================================================ */
 
 /*
- * Create an anonymous shared memory file for Wayland buffer.
- * Returns file descriptor on success, calls DIE on failure.
+ * Row keys of what a buffer (or the surface) shows: one for the frame
+ * layout and one per visible row (text, highlight, index). A row whose key
+ * is unchanged keeps its pixels and is not damaged.
  */
-static int create_shm_file(size_t size) {
-    char name[] = "/tmp/hyprswitcher-shm-XXXXXX";
-    int fd = mkstemp(name);
-    if (fd < 0) {
-        DIE("shm mkstemp failed\n");
-    }
-    unlink(name);
-    
-    if (ftruncate(fd, (off_t)size) < 0) {
-        close(fd);
-        DIE("shm ftruncate failed\n");
-    }
-    
-    return fd;
-}
+typedef struct {
+    const PoolBuffer *buf;
+    unsigned serial;         /* buf->serial when drawn */
+    uint64_t frame_key;      /* Size, scroll position, indicators (0 = unknown) */
+    uint64_t *rows;
+    size_t row_count;
+    size_t row_cap;
+} DrawnRows;
 
 /*
- * Buffer release callback - called when compositor is done with the buffer.
- * This ensures proper cleanup without memory leaks.
+ * A finished frame: the buffer plus where it goes. With the background
+ * layer (bg_layer.c) the buffer only covers the content at (x, y) and the
+ * overlay_* size is filled by the compositor; otherwise it is the whole
+ * overlay at (0, 0).
  */
-static void buffer_release_callback(void *data, struct wl_buffer *buffer) {
-    (void)data;
-    wl_buffer_destroy(buffer);
-}
-
-static const struct wl_buffer_listener buffer_listener = {
-    .release = buffer_release_callback,
-};
+typedef struct {
+    PoolBuffer *buf;
+    int x;
+    int y;
+    int overlay_width;
+    int overlay_height;
+    bool layered;
+    DrawnRows *drawn;        /* Row keys of buf (NULL: not a row frame) */
+    bool damage_all;
+    int damage_y0;           /* Buffer rows to damage otherwise (y0 == y1: none) */
+    int damage_y1;
+} RenderFrame;
 
 /*
- * Render context - holds all resources for a single render pass.
- * This encapsulates buffer creation and cleanup.
+ * Render context - holds the resources for a single render pass.
+ * Pixels live in a pooled shm buffer (buffer_pool.c). Drawing uses overlay
+ * coordinates; the cairo context is translated by the frame origin.
  */
 typedef struct {
-    int fd;
-    void *data;
-    size_t size;
+    RenderFrame frame;
     int width;
     int height;
-    int stride;
     cairo_surface_t *cairo_surface;
     cairo_t *cr;
-    struct wl_buffer *buffer;
     bool valid;
 } RenderContext;
 
+/* Deferred presentation: the last finished frame, waiting to be attached */
+static bool s_defer_frames = false;
+static RenderFrame s_pending;
+
+/* Row keys per pooled buffer, and of the frame on screen */
+#define DRAWN_SLOTS 4
+static DrawnRows s_drawn[DRAWN_SLOTS];
+static DrawnRows s_shown;
+static RenderFrame s_shown_frame;    /* Where it went (buf valid while its serial matches) */
+static unsigned s_shown_serial;
+
+static DrawnRows *drawn_for(const PoolBuffer *buf) {
+    DrawnRows *slot = NULL;
+    for (size_t i = 0; i < DRAWN_SLOTS; i++) {
+        if (s_drawn[i].buf == buf) {
+            return &s_drawn[i];
+        }
+        if (!slot && !s_drawn[i].buf) {
+            slot = &s_drawn[i];
+        }
+    }
+    slot = slot ? slot : &s_drawn[0];
+    slot->buf = buf;
+    slot->frame_key = 0;
+    return slot;
+}
+
+static void drawn_store(DrawnRows *d, unsigned serial, uint64_t frame_key,
+                        const uint64_t *rows, size_t count) {
+    if (count > d->row_cap) {
+        uint64_t *grown = realloc(d->rows, count * sizeof(*grown));
+        if (!grown) {
+            d->frame_key = 0;
+            return;
+        }
+        d->rows = grown;
+        d->row_cap = count;
+    }
+    if (count > 0) {
+        memcpy(d->rows, rows, count * sizeof(*rows));
+    }
+    d->row_count = count;
+    d->serial = serial;
+    d->frame_key = frame_key;
+}
+
+static uint64_t key_hash(uint64_t h, const void *data, size_t n) {
+    const unsigned char *p = data;
+    for (size_t i = 0; i < n; i++) {
+        h ^= p[i];
+        h *= 0x100000001b3ull;
+    }
+    return h;
+}
+
+#define KEY_SEED 0xcbf29ce484222325ull
+
 /*
- * Initialize a render context for the given dimensions.
+ * Initialize a render context for a width x height buffer placed at
+ * (x, y) of an overlay_width x overlay_height overlay.
  * Returns true on success.
  */
-static bool render_context_init(RenderContext *ctx, int width, int height) {
+static bool render_context_init(RenderContext *ctx, int x, int y, int width, int height,
+                                int overlay_width, int overlay_height) {
     memset(ctx, 0, sizeof(*ctx));
     
-    /* Sanity check dimensions to prevent overflow (max ~16K x 16K) */
-    if (width <= 0 || height <= 0 || width > 16384 || height > 16384) {
-        LOG_ERROR("[RENDER] Invalid dimensions: %dx%d", width, height);
+    ctx->frame.buf = buffer_pool_acquire(width, height);
+    if (!ctx->frame.buf) {
         return false;
     }
-    
+    if (ctx->frame.buf == s_pending.buf) {
+        s_pending.buf = NULL;   /* being redrawn; replaced when this frame finishes */
+    }
+    ctx->frame.x = x;
+    ctx->frame.y = y;
+    ctx->frame.overlay_width = overlay_width;
+    ctx->frame.overlay_height = overlay_height;
+    ctx->frame.layered = bg_layer_active();
+    ctx->frame.drawn = NULL;
+    ctx->frame.damage_all = true;
     ctx->width = width;
     ctx->height = height;
-    ctx->stride = width * 4;
-    ctx->size = (size_t)ctx->stride * (size_t)height;
-    ctx->valid = false;
-    
-    /* Create shared memory */
-    ctx->fd = create_shm_file(ctx->size);
-    if (ctx->fd < 0) {
-        return false;
-    }
-    
-    /* Map memory */
-    ctx->data = mmap(NULL, ctx->size, PROT_READ | PROT_WRITE, MAP_SHARED, ctx->fd, 0);
-    if (ctx->data == MAP_FAILED) {
-        LOG_ERROR("[RENDER] mmap failed for %dx%d (size=%zu)", width, height, ctx->size);
-        close(ctx->fd);
-        return false;
-    }
     
     /* Create cairo surface */
     ctx->cairo_surface = cairo_image_surface_create_for_data(
-        ctx->data, CAIRO_FORMAT_ARGB32, width, height, ctx->stride);
+        ctx->frame.buf->data, CAIRO_FORMAT_ARGB32, width, height, ctx->frame.buf->stride);
     
     if (cairo_surface_status(ctx->cairo_surface) != CAIRO_STATUS_SUCCESS) {
         LOG_ERROR("[RENDER] cairo_image_surface_create_for_data failed");
-        munmap(ctx->data, ctx->size);
-        close(ctx->fd);
+        cairo_surface_destroy(ctx->cairo_surface);
         return false;
     }
     
@@ -120,19 +166,64 @@ static bool render_context_init(RenderContext *ctx, int width, int height) {
     ctx->cr = cairo_create(ctx->cairo_surface);
     if (cairo_status(ctx->cr) != CAIRO_STATUS_SUCCESS) {
         LOG_ERROR("[RENDER] cairo_create failed");
+        cairo_destroy(ctx->cr);
         cairo_surface_destroy(ctx->cairo_surface);
-        munmap(ctx->data, ctx->size);
-        close(ctx->fd);
         return false;
     }
+    cairo_translate(ctx->cr, -x, -y);
     
     ctx->valid = true;
     return true;
 }
 
+/* Attach a buffer, damage what changed and commit */
+static void attach_frame(const RenderFrame *frame, struct wl_surface *surface) {
+    PoolBuffer *buf = frame->buf;
+    if (frame->layered) {
+        /* Content first; the parent commit applies it with the background */
+        struct wl_surface *content = bg_layer_content_surface();
+        wl_surface_attach(content, buf->buffer, 0, 0);
+        if (frame->damage_all) {
+            wl_surface_damage_buffer(content, 0, 0, buf->width, buf->height);
+        } else if (frame->damage_y1 > frame->damage_y0) {
+            wl_surface_damage_buffer(content, 0, frame->damage_y0, buf->width,
+                                     frame->damage_y1 - frame->damage_y0);
+        }
+        wl_surface_commit(content);
+        bg_layer_commit(surface, frame->x, frame->y,
+                        frame->overlay_width, frame->overlay_height,
+                        &config_get()->background);
+    } else {
+        wl_surface_attach(surface, buf->buffer, 0, 0);
+        if (frame->damage_all) {
+            wl_surface_damage(surface, 0, 0, buf->width, buf->height);
+        } else if (frame->damage_y1 > frame->damage_y0) {
+            wl_surface_damage(surface, 0, frame->damage_y0, buf->width,
+                              frame->damage_y1 - frame->damage_y0);
+        }
+        wl_surface_commit(surface);
+    }
+    if (frame->drawn && frame->drawn->frame_key != 0) {
+        drawn_store(&s_shown, buf->serial, frame->drawn->frame_key,
+                    frame->drawn->rows, frame->drawn->row_count);
+    } else {
+        s_shown.frame_key = 0;
+    }
+    s_shown_frame = *frame;
+    s_shown_serial = buf->serial;
+    buffer_pool_mark_busy(buf);
+}
+
+/* Commit a finished frame; it ends the action being measured, if any */
+static void present_frame(const RenderFrame *frame, struct wl_surface *surface) {
+    attach_frame(frame, surface);
+    flight_mark(FLIGHT_COMMIT, frame->buf->width * frame->buf->height);
+    flight_action_end();
+}
+
 /*
- * Finish rendering and commit to Wayland surface.
- * Cleans up cairo resources but keeps buffer valid for Wayland.
+ * Finish rendering and commit to Wayland surface, or keep the frame
+ * pending while presentation is deferred.
  */
 static void render_context_commit(RenderContext *ctx, struct wl_surface *surface) {
     if (!ctx->valid || !surface) {
@@ -147,28 +238,31 @@ static void render_context_commit(RenderContext *ctx, struct wl_surface *surface
     cairo_surface_destroy(ctx->cairo_surface);
     ctx->cairo_surface = NULL;
     
-    /* Create Wayland buffer */
-    struct wl_shm *shm = get_shm();
-    struct wl_shm_pool *pool = wl_shm_create_pool(shm, ctx->fd, (int32_t)ctx->size);
-    ctx->buffer = wl_shm_pool_create_buffer(
-        pool, 0, ctx->width, ctx->height, ctx->stride,
-        WL_SHM_FORMAT_ARGB8888);
-    wl_buffer_add_listener(ctx->buffer, &buffer_listener, NULL);
-    wl_shm_pool_destroy(pool);
-    
-    /* Attach and commit */
-    wl_surface_attach(surface, ctx->buffer, 0, 0);
-    wl_surface_damage(surface, 0, 0, ctx->width, ctx->height);
-    wl_surface_commit(surface);
-    
-    /* Buffer will be destroyed in release callback when compositor is done */
-    /* We can close fd now as Wayland has duplicated it internally */
-    close(ctx->fd);
-    ctx->fd = -1;
-    
-    /* Unmap memory (safe after commit) */
-    munmap(ctx->data, ctx->size);
-    ctx->data = NULL;
+    /* Pixels without row keys (placeholder, empty list) */
+    if (!ctx->frame.drawn) {
+        drawn_for(ctx->frame.buf)->frame_key = 0;
+    }
+    if (s_defer_frames) {
+        s_pending = ctx->frame;
+        s_pending.damage_all = true;   /* what is on screen by then is unknown */
+        return;
+    }
+    s_pending.buf = NULL;
+    present_frame(&ctx->frame, surface);
+}
+
+void render_set_deferred(bool deferred) {
+    s_defer_frames = deferred;
+}
+
+bool render_present_pending(struct wl_surface *surface) {
+    RenderFrame frame = s_pending;
+    s_pending.buf = NULL;
+    if (!frame.buf || !surface) {
+        return false;
+    }
+    present_frame(&frame, surface);
+    return true;
 }
 
 /* ============================================================================
@@ -208,6 +302,427 @@ static void set_color(cairo_t *cr, const ConfigColor *color) {
     cairo_set_source_rgba(cr, color->r, color->g, color->b, color->a);
 }
 
+/* ============================================================================
+ * Theme Cache (pre-rendered chrome)
+ * ============================================================================ */
+
+/*
+ * Everything the cached images depend on. Surfaces are always drawn at
+ * buffer scale 1, so the theme alone decides their pixels.
+ */
+typedef struct {
+    ConfigColor background;
+    ConfigColor shadow;
+    ConfigColor highlight_bg;
+    ConfigColor highlight_border;
+    ConfigColor border;
+    int corner_radius;
+    int border_width_normal;
+    int border_width_selected;
+    int shadow_size;
+} ThemeKey;
+
+static struct {
+    bool built;
+    ThemeKey key;
+    NinePatch panel;         /* Shadow + rounded background; goes onto a cleared buffer */
+    NinePatch item_focused;  /* Highlight fill and border over the background */
+    NinePatch item_normal;   /* Item border over the background */
+    int item_margin;         /* How far item borders reach outside the item rect */
+} s_theme;
+
+/* Radius of the outer panel, slightly larger than the items' */
+static double panel_radius(const SwitcherConfig *cfg) {
+    return cfg->corner_radius * 1.5;
+}
+
+static void theme_key_from_config(const SwitcherConfig *cfg, ThemeKey *key) {
+    memset(key, 0, sizeof(*key));
+    key->background = cfg->background;
+    key->shadow = cfg->shadow_color;
+    key->highlight_bg = cfg->highlight_bg;
+    key->highlight_border = cfg->highlight_border;
+    key->border = cfg->border_color;
+    key->corner_radius = cfg->corner_radius;
+    key->border_width_normal = cfg->border_width_normal;
+    key->border_width_selected = cfg->border_width_selected;
+    key->shadow_size = cfg->shadow_size;
+}
+
+/*
+ * Panel template: the rounded background inset by the shadow size, with
+ * the blurred shadow around it. The background is written with SOURCE so
+ * a translucent panel does not show its own shadow through it.
+ */
+static void build_panel_patch(const SwitcherConfig *cfg) {
+    int shadow = cfg->shadow_size;
+    int blur = shadow / 3;
+    double radius = panel_radius(cfg);
+    /* Three box passes spread the shadow 3 * blur px along the edges too:
+     * the stretched middle row/column must be that far from both corner
+     * arcs, or the edge shadows come out fainter than the corners */
+    if (!nine_patch_create(&s_theme.panel, shadow + (int)radius + 3 * blur + 2)) {
+        return;
+    }
+
+    cairo_surface_t *image = s_theme.panel.image;
+    int size = cairo_image_surface_get_width(image);
+    double inner = size - 2.0 * shadow;
+    cairo_t *cr = cairo_create(image);
+    cairo_set_antialias(cr, CAIRO_ANTIALIAS_BEST);
+
+    if (shadow > 0) {
+        cairo_surface_t *mask = cairo_image_surface_create(CAIRO_FORMAT_A8, size, size);
+        cairo_t *mcr = cairo_create(mask);
+        draw_rounded_rect(mcr, shadow, shadow, inner, inner, radius);
+        cairo_set_source_rgba(mcr, 0, 0, 0, 1);
+        cairo_fill(mcr);
+        cairo_destroy(mcr);
+
+        nine_patch_blur_a8(mask, blur);
+        set_color(cr, &cfg->shadow_color);
+        cairo_mask_surface(cr, mask, 0, 0);
+        cairo_surface_destroy(mask);
+    }
+
+    cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
+    draw_rounded_rect(cr, shadow, shadow, inner, inner, radius);
+    set_color(cr, &cfg->background);
+    cairo_fill(cr);
+    cairo_destroy(cr);
+}
+
+/*
+ * Item template: the panel background with the item drawn over it exactly
+ * as the cairo path would, extended by `margin` so borders straddling the
+ * item edge are kept.
+ */
+static void build_item_patch(NinePatch *np, const SwitcherConfig *cfg,
+                             bool focused, int margin) {
+    int line = focused ? cfg->border_width_selected : cfg->border_width_normal;
+    int radius = cfg->corner_radius;
+    if (!nine_patch_create(np, margin + radius + line + 1)) {
+        return;
+    }
+
+    int size = cairo_image_surface_get_width(np->image);
+    double item = size - 2.0 * margin;
+    cairo_t *cr = cairo_create(np->image);
+    cairo_set_antialias(cr, CAIRO_ANTIALIAS_BEST);
+
+    cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
+    set_color(cr, &cfg->background);
+    cairo_paint(cr);
+    cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
+
+    if (focused) {
+        draw_rounded_rect(cr, margin, margin, item, item, radius);
+        set_color(cr, &cfg->highlight_bg);
+        cairo_fill_preserve(cr);
+        set_color(cr, &cfg->highlight_border);
+    } else {
+        draw_rounded_rect(cr, margin + 0.5, margin + 0.5, item - 1, item - 1, radius);
+        set_color(cr, &cfg->border_color);
+    }
+    cairo_set_line_width(cr, line);
+    cairo_stroke(cr);
+    cairo_destroy(cr);
+}
+
+static void theme_cache_free(void) {
+    nine_patch_destroy(&s_theme.panel);
+    nine_patch_destroy(&s_theme.item_focused);
+    nine_patch_destroy(&s_theme.item_normal);
+    s_theme.built = false;
+}
+
+/*
+ * Rebuild the cached images if the theme changed since the last frame.
+ */
+static void theme_cache_update(const SwitcherConfig *cfg) {
+    ThemeKey key;
+    theme_key_from_config(cfg, &key);
+    if (s_theme.built && memcmp(&key, &s_theme.key, sizeof(key)) == 0) {
+        return;
+    }
+
+    theme_cache_free();
+    s_theme.key = key;
+    s_theme.built = true;
+
+    int widest = cfg->border_width_selected > cfg->border_width_normal
+        ? cfg->border_width_selected : cfg->border_width_normal;
+    s_theme.item_margin = (widest + 1) / 2;
+
+    build_panel_patch(cfg);
+    build_item_patch(&s_theme.item_focused, cfg, true, s_theme.item_margin);
+    build_item_patch(&s_theme.item_normal, cfg, false, s_theme.item_margin);
+    LOG_DEBUG("[RENDER] Built theme cache (panel inset=%d, item inset=%d)",
+              s_theme.panel.inset, s_theme.item_focused.inset);
+}
+
+/* ============================================================================
+ * Marquee (cut-off title of the selected row)
+ * ============================================================================ */
+
+/* Pause at either end of a pass */
+#define MARQUEE_PAUSE_NS 1000000000ull
+/* Blank space after the end of the title */
+#define MARQUEE_TAIL_PX 24
+
+/*
+ * The selected row's full title is shaped once, over the highlight, into
+ * an offscreen strip. Each step copies a row-sized window of the strip
+ * into one buffer row band (a memcpy per scanline, no shaping) and damages
+ * only that band; steps are paced by frame callbacks. At offset 0 the
+ * ellipsized text drawn by render_draw_rows() is restored from `rest`.
+ */
+static struct {
+    cairo_surface_t *strip;
+    uint32_t *rest;          /* w x h pixels of the row as drawn (ellipsized) */
+    uint64_t row_key;        /* Row the strip belongs to (0 = none) */
+    uint64_t frame_key;      /* Layout it was positioned in */
+    int x, y, w, h;          /* Text window, overlay coordinates */
+    int span;                /* Largest offset */
+    int offset;              /* Offset in the frame on screen */
+    uint64_t start_ns;       /* Start of the current pass */
+    uint64_t wake_ns;        /* Next change while no frame callback is pending */
+    struct wl_callback *frame_cb;
+    bool frame_ready;        /* The compositor is ready for the next step */
+} s_marquee;
+
+static void marquee_drop(void) {
+    if (s_marquee.strip) {
+        cairo_surface_destroy(s_marquee.strip);
+    }
+    if (s_marquee.frame_cb) {
+        wl_callback_destroy(s_marquee.frame_cb);
+    }
+    free(s_marquee.rest);
+    memset(&s_marquee, 0, sizeof(s_marquee));
+}
+
+static void marquee_frame_done(void *data, struct wl_callback *cb, uint32_t time) {
+    (void)data;
+    (void)time;
+    wl_callback_destroy(cb);
+    s_marquee.frame_cb = NULL;
+    s_marquee.frame_ready = true;
+}
+
+static const struct wl_callback_listener marquee_frame_listener = {
+    .done = marquee_frame_done,
+};
+
+/*
+ * Offset for now_ns: a pause at the start, a scroll at marquee_speed, a
+ * pause at the end, then the next pass. *change_ns is when it next changes.
+ */
+static int marquee_offset_at(uint64_t now_ns, uint64_t *change_ns) {
+    uint64_t speed = (uint64_t)config_get()->marquee_speed;
+    uint64_t scroll_ns = (uint64_t)s_marquee.span * 1000000000ull / speed;
+    if (now_ns - s_marquee.start_ns >= 2 * MARQUEE_PAUSE_NS + scroll_ns) {
+        s_marquee.start_ns = now_ns;
+    }
+    uint64_t t = now_ns - s_marquee.start_ns;
+    if (t < MARQUEE_PAUSE_NS) {
+        *change_ns = s_marquee.start_ns + MARQUEE_PAUSE_NS;
+        return 0;
+    }
+    if (t < MARQUEE_PAUSE_NS + scroll_ns) {
+        uint64_t offset = (t - MARQUEE_PAUSE_NS) * speed / 1000000000ull;
+        *change_ns = s_marquee.start_ns + MARQUEE_PAUSE_NS +
+                     ((offset + 1) * 1000000000ull + speed - 1) / speed;
+        return (int)offset;
+    }
+    *change_ns = s_marquee.start_ns + 2 * MARQUEE_PAUSE_NS + scroll_ns;
+    return s_marquee.span;
+}
+
+/* Copy the window at `offset` into pixels whose origin is (fx, fy) */
+static void marquee_blit(unsigned char *data, int stride, int fx, int fy, int offset) {
+    const unsigned char *src;
+    int src_stride;
+    if (offset > 0) {
+        src = cairo_image_surface_get_data(s_marquee.strip) + (size_t)offset * 4;
+        src_stride = cairo_image_surface_get_stride(s_marquee.strip);
+    } else {
+        src = (const unsigned char *)s_marquee.rest;
+        src_stride = s_marquee.w * 4;
+    }
+    size_t row_bytes = (size_t)s_marquee.w * 4;
+    unsigned char *dst = data + (size_t)(s_marquee.y - fy) * stride + (size_t)(s_marquee.x - fx) * 4;
+    for (int row = 0; row < s_marquee.h; row++) {
+        memcpy(dst + (size_t)row * stride, src + (size_t)row * src_stride, row_bytes);
+    }
+}
+
+/*
+ * The selected row was just drawn into ctx at (text_x, text_y): keep the
+ * strip if it is for the same row, otherwise shape the full title into a
+ * new one.
+ */
+static void marquee_update(RenderContext *ctx, PangoLayout *layout, uint64_t row_key,
+                           uint64_t frame_key, int x, int y, int w, int h,
+                           double text_x, double text_y, bool over_background) {
+    const SwitcherConfig *cfg = config_get();
+    if (cfg->marquee_speed <= 0 || !pango_layout_is_ellipsized(layout) || w <= 0 || h <= 0 ||
+        x < ctx->frame.x || y < ctx->frame.y ||
+        x + w > ctx->frame.x + ctx->width || y + h > ctx->frame.y + ctx->height) {
+        marquee_drop();
+        return;
+    }
+    if (s_marquee.strip && s_marquee.row_key == row_key && s_marquee.frame_key == frame_key) {
+        return;
+    }
+    marquee_drop();
+
+    PangoLayout *full = pango_layout_copy(layout);
+    pango_layout_set_width(full, -1);
+    pango_layout_set_ellipsize(full, PANGO_ELLIPSIZE_NONE);
+    int full_w, full_h;
+    pango_layout_get_pixel_size(full, &full_w, &full_h);
+    int lead = (int)(text_x - x);
+    int strip_w = lead + full_w + MARQUEE_TAIL_PX;
+    if (strip_w <= w) {
+        g_object_unref(full);
+        return;
+    }
+
+    cairo_surface_t *strip = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, strip_w, h);
+    uint32_t *rest = malloc((size_t)w * (size_t)h * 4);
+    if (cairo_surface_status(strip) != CAIRO_STATUS_SUCCESS || !rest) {
+        LOG_WARN("[RENDER] No marquee strip (%dx%d)", strip_w, h);
+        cairo_surface_destroy(strip);
+        free(rest);
+        g_object_unref(full);
+        return;
+    }
+
+    /* Same pixels as the row's interior: background (unless the
+     * compositor supplies it), highlight over it, then the text */
+    cairo_t *cr = cairo_create(strip);
+    cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
+    if (over_background) {
+        set_color(cr, &cfg->background);
+    } else {
+        cairo_set_source_rgba(cr, 0, 0, 0, 0);
+    }
+    cairo_paint(cr);
+    cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
+    set_color(cr, &cfg->highlight_bg);
+    cairo_paint(cr);
+    set_color(cr, &cfg->text_selected);
+    cairo_move_to(cr, text_x - x, text_y - y);
+    pango_cairo_show_layout(cr, full);
+    cairo_destroy(cr);
+    cairo_surface_flush(strip);
+    g_object_unref(full);
+
+    /* The ellipsized row as drawn, for offset 0 */
+    cairo_surface_flush(ctx->cairo_surface);
+    const unsigned char *row = ctx->frame.buf->data +
+                               (size_t)(y - ctx->frame.y) * ctx->frame.buf->stride +
+                               (size_t)(x - ctx->frame.x) * 4;
+    for (int r = 0; r < h; r++) {
+        memcpy(rest + (size_t)r * w, row + (size_t)r * ctx->frame.buf->stride, (size_t)w * 4);
+    }
+
+    s_marquee.strip = strip;
+    s_marquee.rest = rest;
+    s_marquee.row_key = row_key;
+    s_marquee.frame_key = frame_key;
+    s_marquee.x = x;
+    s_marquee.y = y;
+    s_marquee.w = w;
+    s_marquee.h = h;
+    s_marquee.span = strip_w - w;
+    s_marquee.start_ns = flight_now();
+    s_marquee.wake_ns = s_marquee.start_ns + MARQUEE_PAUSE_NS;
+    LOG_DEBUG("[RENDER] Marquee strip %dx%d for a %dpx window", strip_w, h, w);
+}
+
+uint64_t render_marquee_deadline(void) {
+    if (!s_marquee.strip || s_defer_frames) {
+        return 0;
+    }
+    if (s_marquee.frame_ready) {
+        return 1;
+    }
+    return s_marquee.frame_cb ? 0 : s_marquee.wake_ns;
+}
+
+void render_marquee_step(struct wl_surface *surface, uint64_t now_ns) {
+    s_marquee.frame_ready = false;
+    if (!s_marquee.strip || s_defer_frames || !surface) {
+        return;
+    }
+    if (config_get()->marquee_speed <= 0) {
+        marquee_drop();   /* turned off by a reload */
+        return;
+    }
+    uint64_t change_ns;
+    int offset = marquee_offset_at(now_ns, &change_ns);
+    s_marquee.wake_ns = change_ns;
+    if (offset == s_marquee.offset) {
+        return;
+    }
+
+    /* Step the frame on screen: same layout and rows, new window */
+    RenderFrame frame = s_shown_frame;
+    if (!frame.buf || s_shown.frame_key != s_marquee.frame_key) {
+        marquee_drop();
+        return;
+    }
+    PoolBuffer *buf = buffer_pool_acquire(frame.buf->width, frame.buf->height);
+    if (!buf) {
+        s_marquee.wake_ns = now_ns + 4000000ull;   /* all busy; retry shortly */
+        return;
+    }
+    DrawnRows *drawn = drawn_for(buf);
+    bool same = drawn->serial == buf->serial &&
+                drawn->frame_key == s_shown.frame_key &&
+                drawn->row_count == s_shown.row_count &&
+                memcmp(drawn->rows, s_shown.rows, s_shown.row_count * sizeof(uint64_t)) == 0;
+    if (!same) {
+        /* An older frame: start from the one on screen */
+        if (buf == frame.buf || frame.buf->serial != s_shown_serial) {
+            marquee_drop();
+            return;
+        }
+        memcpy(buf->data, frame.buf->data, buf->size);
+        drawn_store(drawn, buf->serial, s_shown.frame_key, s_shown.rows, s_shown.row_count);
+    }
+    if (buf == s_pending.buf) {
+        s_pending.buf = NULL;
+    }
+    marquee_blit(buf->data, buf->stride, frame.x, frame.y, offset);
+
+    frame.buf = buf;
+    frame.drawn = drawn;
+    frame.damage_all = false;
+    frame.damage_y0 = s_marquee.y - frame.y;
+    frame.damage_y1 = frame.damage_y0 + s_marquee.h;
+    s_marquee.frame_cb = wl_surface_frame(surface);
+    wl_callback_add_listener(s_marquee.frame_cb, &marquee_frame_listener, NULL);
+    attach_frame(&frame, surface);
+    s_marquee.offset = offset;
+}
+
+void render_cleanup(void) {
+    s_pending.buf = NULL;
+    marquee_drop();
+    memset(&s_shown_frame, 0, sizeof(s_shown_frame));
+    for (size_t i = 0; i < DRAWN_SLOTS; i++) {
+        free(s_drawn[i].rows);
+    }
+    free(s_shown.rows);
+    memset(s_drawn, 0, sizeof(s_drawn));
+    memset(&s_shown, 0, sizeof(s_shown));
+    buffer_pool_destroy();
+    theme_cache_free();
+}
+
 /* ============================================================================
  * Main Rendering Functions
  * ============================================================================ */
@@ -223,17 +738,22 @@ void render_draw(struct wl_surface *surface, int width, int height) {
     const SwitcherConfig *cfg = config_get();
     
     RenderContext ctx;
-    if (!render_context_init(&ctx, width, height)) {
+    if (!render_context_init(&ctx, 0, 0, width, height, width, height)) {
         LOG_ERROR("[RENDER] Failed to create render context");
         return;
     }
     
     cairo_t *cr = ctx.cr;
     
-    /* Draw background */
-    set_color(cr, &cfg->background);
-    cairo_rectangle(cr, 0, 0, width, height);
-    cairo_fill(cr);
+    /* Draw background (the background layer supplies it otherwise) */
+    cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
+    if (ctx.frame.layered) {
+        cairo_set_source_rgba(cr, 0, 0, 0, 0);
+    } else {
+        set_color(cr, &cfg->background);
+    }
+    cairo_paint(cr);
+    cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
     
     /* Draw centered text */
     PangoLayout *layout = pango_cairo_create_layout(cr);
@@ -272,21 +792,134 @@ void render_draw_titles(struct wl_surface *surface, int width, int height,
     render_draw_titles_focus(surface, width, height, titles, count, -1);
 }
 
+static const char *title_array_row(size_t index, void *user) {
+    return ((const char **)user)[index];
+}
+
 /*
  * Draw window titles with focus highlight.
- * This is the main rendering function for the switcher overlay.
  */
 void render_draw_titles_focus(struct wl_surface *surface, int width, int height,
                                const char **titles, size_t count, int focused_index) {
+    render_draw_rows(surface, width, height, titles ? title_array_row : NULL,
+                     (void *)titles, count, focused_index);
+}
+
+/*
+ * Draw window rows with focus highlight.
+ * This is the main rendering function for the switcher overlay.
+ */
+void render_draw_rows(struct wl_surface *surface, int width, int height,
+                      RenderRowText row_text, void *user, size_t count, int focused_index) {
     if (!surface || width <= 0 || height <= 0) {
         return;
     }
     
     const SwitcherConfig *cfg = config_get();
+    theme_cache_update(cfg);
+    
+    /* A single-pixel background (bg_layer.c) is a plain rectangle */
+    bool layered = bg_layer_active();
+    double bg_radius = layered ? 0 : panel_radius(cfg);
+    int shadow = layered ? 0 : cfg->shadow_size;
+    
+    /* Calculate item dimensions */
+    int padding = cfg->padding;
+    int item_height = cfg->item_height;
+    int item_pad_x = cfg->item_padding_x;
+    int radius = cfg->corner_radius;
+    int item_margin = s_theme.item_margin;
+    
+    int content_width = width - (2 * padding) - (2 * shadow);
+    if (content_width < 100) content_width = 100;
+    
+    bool empty = (count == 0 || !row_text);
+    
+    /* Calculate visible items */
+    size_t max_visible = cfg->max_visible_items > 0 
+        ? (size_t)cfg->max_visible_items 
+        : count;
+    size_t visible_count = count < max_visible ? count : max_visible;
+    
+    /* Calculate scroll offset if focused item would be out of view */
+    size_t scroll_offset = 0;
+    if (focused_index >= 0) {
+        size_t fidx = (size_t)focused_index;
+        
+        /* Handle downward scrolling: focused item is below visible window */
+        if (fidx >= visible_count) {
+            scroll_offset = fidx - visible_count + 1;
+            if (scroll_offset + visible_count > count) {
+                scroll_offset = count - visible_count;
+            }
+        }
+        
+        /* Handle upward scrolling: focused item is above visible window */
+        if (fidx < scroll_offset) {
+            scroll_offset = fidx;
+        }
+    }
+    bool more_above = !empty && scroll_offset > 0;
+    bool more_below = !empty && scroll_offset + visible_count < count;
+    
+    /* With the background layer only the rows (borders and scroll
+     * indicators included) need a buffer; otherwise the whole overlay */
+    int area_x = 0, area_y = 0, area_w = width, area_h = height;
+    if (layered && !empty) {
+        int x0 = padding - item_margin;
+        int x1 = padding + content_width + item_margin;
+        int y0 = padding - item_margin;
+        int y1 = padding + (int)(visible_count - 1) * item_height + (item_height - 4) + item_margin;
+        if (more_above && padding / 2 - 4 < y0) y0 = padding / 2 - 4;
+        if (more_below && height - padding / 2 + 4 > y1) y1 = height - padding / 2 + 4;
+        if (x0 < 0) x0 = 0;
+        if (y0 < 0) y0 = 0;
+        if (x1 > width) x1 = width;
+        if (y1 > height) y1 = height;
+        if (x1 > x0 && y1 > y0) {
+            area_x = x0;
+            area_y = y0;
+            area_w = x1 - x0;
+            area_h = y1 - y0;
+        }
+    }
+    
+    /* Keys of this frame: a reused buffer only redraws the rows that
+     * differ from what it holds, and only rows that differ from the frame
+     * on screen are damaged */
+    struct {
+        int width, height, area_x, area_y, area_w, area_h;
+        size_t scroll_offset, visible_count;
+        bool more_above, more_below, layered;
+    } layout_key;
+    memset(&layout_key, 0, sizeof(layout_key));
+    layout_key.width = width;
+    layout_key.height = height;
+    layout_key.area_x = area_x;
+    layout_key.area_y = area_y;
+    layout_key.area_w = area_w;
+    layout_key.area_h = area_h;
+    layout_key.scroll_offset = scroll_offset;
+    layout_key.visible_count = visible_count;
+    layout_key.more_above = more_above;
+    layout_key.more_below = more_below;
+    layout_key.layered = layered;
+    uint64_t frame_key = key_hash(KEY_SEED, &layout_key, sizeof(layout_key)) | 1;
+    
+    uint64_t *row_keys = empty ? NULL : malloc(visible_count * sizeof(*row_keys));
+    for (size_t vi = 0; row_keys && vi < visible_count; vi++) {
+        size_t i = vi + scroll_offset;
+        const char *text = row_text(i, user);
+        uint8_t focused = ((int)i == focused_index);
+        uint64_t h = key_hash(KEY_SEED, text ? text : "", text ? strlen(text) + 1 : 1);
+        h = key_hash(h, &i, sizeof(i));
+        row_keys[vi] = key_hash(h, &focused, 1);
+    }
     
     RenderContext ctx;
-    if (!render_context_init(&ctx, width, height)) {
+    if (!render_context_init(&ctx, area_x, area_y, area_w, area_h, width, height)) {
         LOG_ERROR("[RENDER] Failed to create render context");
+        free(row_keys);
         return;
     }
     
@@ -295,21 +928,21 @@ void render_draw_titles_focus(struct wl_surface *surface, int width, int height,
     /* Enable antialiasing */
     cairo_set_antialias(cr, CAIRO_ANTIALIAS_BEST);
     
-    /* ====================================================================
-     * Draw Background with Rounded Corners
-     * ==================================================================== */
-    
-    double bg_radius = cfg->corner_radius * 1.5;  /* Slightly larger for outer bg */
-    
-    /* Clear to transparent first */
-    cairo_set_operator(cr, CAIRO_OPERATOR_CLEAR);
-    cairo_paint(cr);
-    cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
-    
-    /* Draw rounded background */
-    draw_rounded_rect(cr, 0, 0, width, height, bg_radius);
-    set_color(cr, &cfg->background);
-    cairo_fill(cr);
+    /* Row-by-row repaint fills each row's band with plain background, so
+     * the band must not reach the panel's corners or a neighbouring row */
+    DrawnRows *drawn = drawn_for(ctx.frame.buf);
+    bool partial = row_keys &&
+                   drawn->frame_key == frame_key &&
+                   drawn->serial == ctx.frame.buf->serial &&
+                   drawn->row_count == visible_count &&
+                   item_margin <= 2 &&
+                   (layered || padding - item_margin >= (int)bg_radius + 1);
+    bool shown_same = row_keys &&
+                      s_shown.frame_key == frame_key &&
+                      s_shown.row_count == visible_count;
+    ctx.frame.damage_all = !shown_same;
+    ctx.frame.damage_y0 = ctx.frame.damage_y1 = 0;
+    size_t redrawn = 0;
     
     /* ====================================================================
      * Setup Text Rendering
@@ -327,15 +960,6 @@ void render_draw_titles_focus(struct wl_surface *surface, int width, int height,
         pango_layout_set_alignment(layout, PANGO_ALIGN_LEFT);
     }
     
-    /* Calculate item dimensions */
-    int padding = cfg->padding;
-    int item_height = cfg->item_height;
-    int item_pad_x = cfg->item_padding_x;
-    int radius = cfg->corner_radius;
-    
-    int content_width = width - (2 * padding);
-    if (content_width < 100) content_width = 100;
-    
     /* Set max width for text ellipsis */
     int text_max_width = content_width - (2 * item_pad_x);
     if (cfg->show_index) {
@@ -343,11 +967,44 @@ void render_draw_titles_focus(struct wl_surface *surface, int width, int height,
     }
     pango_layout_set_width(layout, text_max_width * PANGO_SCALE);
     
+    /* Text taller than a row band would leave old glyphs outside it */
+    if (partial) {
+        int probe_w, probe_h;
+        pango_layout_set_text(layout, "Ag", -1);
+        pango_layout_get_size(layout, &probe_w, &probe_h);
+        if (probe_h / PANGO_SCALE > item_height - 4 + 2 * item_margin) {
+            partial = false;
+        }
+    }
+    
+    /* ====================================================================
+     * Draw Background with Rounded Corners
+     * ==================================================================== */
+    
+    if (!partial) {
+        /* Clear to transparent first */
+        cairo_set_operator(cr, CAIRO_OPERATOR_CLEAR);
+        cairo_paint(cr);
+        cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
+        
+        /* Draw rounded background (and shadow) from the cached nine-patch;
+         * fall back to a plain cairo fill if the surface is too small for it */
+        if (layered) {
+            /* Filled by the compositor from the single-pixel buffer */
+        } else if (nine_patch_fits(&s_theme.panel, width, height)) {
+            nine_patch_blit(&s_theme.panel, ctx.cairo_surface, 0, 0, width, height);
+        } else {
+            draw_rounded_rect(cr, shadow, shadow, width - 2 * shadow, height - 2 * shadow, bg_radius);
+            set_color(cr, &cfg->background);
+            cairo_fill(cr);
+        }
+    }
+    
     /* ====================================================================
      * Handle Empty State
      * ==================================================================== */
     
-    if (count == 0 || !titles) {
+    if (empty) {
         const char *msg = "No windows open";
         pango_layout_set_alignment(layout, PANGO_ALIGN_CENTER);
         pango_layout_set_width(layout, -1);
@@ -373,50 +1030,84 @@ void render_draw_titles_focus(struct wl_surface *surface, int width, int height,
      * Draw Window Items
      * ==================================================================== */
     
-    /* Calculate visible items */
-    size_t max_visible = cfg->max_visible_items > 0 
-        ? (size_t)cfg->max_visible_items 
-        : count;
-    size_t visible_count = count < max_visible ? count : max_visible;
-    
-    /* Calculate scroll offset if focused item would be out of view */
-    size_t scroll_offset = 0;
-    if (focused_index >= 0) {
-        size_t fidx = (size_t)focused_index;
-        
-        /* Handle downward scrolling: focused item is below visible window */
-        if (fidx >= visible_count) {
-            scroll_offset = fidx - visible_count + 1;
-            if (scroll_offset + visible_count > count) {
-                scroll_offset = count - visible_count;
-            }
-        }
-        
-        /* Handle upward scrolling: focused item is above visible window */
-        if (fidx < scroll_offset) {
-            scroll_offset = fidx;
-        }
-    }
+    /* Items can be copied from the cached templates when the area under
+     * them (borders included) is plain background, clear of the panel's
+     * rounded corners. The templates carry that background, so over the
+     * background layer they are only exact when it is opaque. */
+    bool items_cached = layered
+        ? cfg->background.a >= 1.0
+        : padding - item_margin >= (int)bg_radius + 1;
+    bool marquee_row = false;
     
     /* Draw each visible item */
     for (size_t vi = 0; vi < visible_count; vi++) {
         size_t i = vi + scroll_offset;
         if (i >= count) break;
         
-        const char *text = titles[i] ? titles[i] : "(untitled)";
+        const char *text = row_text(i, user);
+        if (!text) text = "(untitled)";
         bool is_focused = ((int)i == focused_index);
         
         /* Calculate item position */
-        double item_x = padding;
-        double item_y = padding + (vi * item_height);
+        double item_x = shadow + padding;
+        double item_y = shadow + padding + (vi * item_height);
         double item_w = content_width;
         double item_h = item_height - 4;  /* Small gap between items */
         
+        /* The row's band: the item with its borders, clear of its neighbours */
+        int band_y0 = (int)item_y - item_margin;
+        int band_y1 = (int)(item_y + item_h) + item_margin;
+        bool redraw = !partial || row_keys[vi] != drawn->rows[vi];
+        if (shown_same && (redraw || row_keys[vi] != s_shown.rows[vi])) {
+            int y0 = band_y0 - area_y, y1 = band_y1 - area_y;
+            if (ctx.frame.damage_y1 == ctx.frame.damage_y0) {
+                ctx.frame.damage_y0 = y0;
+                ctx.frame.damage_y1 = y1;
+            }
+            if (y0 < ctx.frame.damage_y0) ctx.frame.damage_y0 = y0;
+            if (y1 > ctx.frame.damage_y1) ctx.frame.damage_y1 = y1;
+        }
+        if (!redraw) {
+            /* An unchanged selected row keeps its strip */
+            if (is_focused && s_marquee.row_key == row_keys[vi]) {
+                marquee_row = true;
+            }
+            continue;
+        }
+        redrawn++;
+        if (partial) {
+            cairo_save(cr);
+            cairo_rectangle(cr, item_x - item_margin, band_y0,
+                            item_w + 2 * item_margin, band_y1 - band_y0);
+            cairo_clip(cr);
+            cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
+            if (layered) {
+                cairo_set_source_rgba(cr, 0, 0, 0, 0);
+            } else {
+                set_color(cr, &cfg->background);
+            }
+            cairo_paint(cr);
+            cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
+        }
+        
         /* ================================================================
          * Draw Item Background and Border
          * ================================================================ */
         
-        if (is_focused) {
+        const NinePatch *item_patch = is_focused ? &s_theme.item_focused : &s_theme.item_normal;
+        int blit_w = (int)item_w + 2 * item_margin;
+        int blit_h = (int)item_h + 2 * item_margin;
+        
+        /* Buffer coordinates: nine-patch blits bypass the cairo transform */
+        int blit_x = (int)item_x - item_margin - area_x;
+        int blit_y = (int)item_y - item_margin - area_y;
+        
+        bool patched = items_cached && nine_patch_fits(item_patch, blit_w, blit_h) &&
+                       blit_x >= 0 && blit_y >= 0 &&
+                       blit_x + blit_w <= area_w && blit_y + blit_h <= area_h;
+        if (patched) {
+            nine_patch_blit(item_patch, ctx.cairo_surface, blit_x, blit_y, blit_w, blit_h);
+        } else if (is_focused) {
             /* Focused item: filled background */
             draw_rounded_rect(cr, item_x, item_y, item_w, item_h, radius);
             set_color(cr, &cfg->highlight_bg);
@@ -439,16 +1130,16 @@ void render_draw_titles_focus(struct wl_surface *surface, int width, int height,
          * Draw Item Text
          * ================================================================ */
         
-        /* Build display text */
-        char display_text[512];
+        /* Build display text (titles are normalized at ingest, see text.h,
+         * so they are short valid UTF-8 and can be handed to Pango as-is) */
+        char display_text[TEXT_MAX_BYTES + 32];
+        const char *shown = text;
         if (cfg->show_index) {
             snprintf(display_text, sizeof(display_text), "%zu. %s", i + 1, text);
-        } else {
-            strncpy(display_text, text, sizeof(display_text) - 1);
-            display_text[sizeof(display_text) - 1] = '\0';
+            shown = display_text;
         }
         
-        pango_layout_set_text(layout, display_text, -1);
+        pango_layout_set_text(layout, shown, -1);
         
         /* Get text dimensions */
         int tw, th;
@@ -474,30 +1165,58 @@ void render_draw_titles_focus(struct wl_surface *surface, int width, int height,
         /* Draw text */
         cairo_move_to(cr, text_x, text_y);
         pango_cairo_show_layout(cr, layout);
+        if (partial) {
+            cairo_restore(cr);
+        }
+        
+        /* Cut-off selected title: scrolled inside the highlight, clear of
+         * its border and rounded corners */
+        if (is_focused && row_keys) {
+            int inset = cfg->border_width_selected + 1;
+            int x0 = (int)text_x, x1 = (int)text_x + text_max_width;
+            if (x0 < (int)item_x + radius) x0 = (int)item_x + radius;
+            if (x1 > (int)(item_x + item_w) - radius) x1 = (int)(item_x + item_w) - radius;
+            int y0 = (int)item_y + inset;
+            int y1 = (int)(item_y + item_h) - inset;
+            marquee_update(&ctx, layout, row_keys[vi], frame_key, x0, y0, x1 - x0, y1 - y0,
+                           text_x, text_y, !layered || patched);
+            marquee_row = s_marquee.strip != NULL;
+        }
+    }
+    
+    /* Put the marquee back where it was in the frame on screen */
+    if (!marquee_row) {
+        marquee_drop();
+    } else {
+        cairo_surface_flush(ctx.cairo_surface);
+        marquee_blit(ctx.frame.buf->data, ctx.frame.buf->stride,
+                     ctx.frame.x, ctx.frame.y, s_marquee.offset);
+        cairo_surface_mark_dirty(ctx.cairo_surface);
     }
     
     /* ====================================================================
      * Draw Scroll Indicators (if needed)
      * ==================================================================== */
     
-    if (scroll_offset > 0) {
+    /* A partial repaint keeps the indicators: they are part of frame_key */
+    if (more_above && !partial) {
         /* Draw "more above" indicator */
         set_color(cr, &cfg->text_color);
         cairo_set_line_width(cr, 2);
         double cx = width / 2.0;
-        double cy = padding / 2.0;
+        double cy = shadow + padding / 2.0;
         cairo_move_to(cr, cx - 10, cy + 3);
         cairo_line_to(cr, cx, cy - 3);
         cairo_line_to(cr, cx + 10, cy + 3);
         cairo_stroke(cr);
     }
     
-    if (scroll_offset + visible_count < count) {
+    if (more_below && !partial) {
         /* Draw "more below" indicator */
         set_color(cr, &cfg->text_color);
         cairo_set_line_width(cr, 2);
         double cx = width / 2.0;
-        double cy = height - padding / 2.0;
+        double cy = height - shadow - padding / 2.0;
         cairo_move_to(cr, cx - 10, cy - 3);
         cairo_line_to(cr, cx, cy + 3);
         cairo_line_to(cr, cx + 10, cy - 3);
@@ -511,7 +1230,13 @@ void render_draw_titles_focus(struct wl_surface *surface, int width, int height,
     pango_font_description_free(font);
     g_object_unref(layout);
     
+    if (row_keys) {
+        drawn_store(drawn, ctx.frame.buf->serial, frame_key, row_keys, visible_count);
+        ctx.frame.drawn = drawn;
+        free(row_keys);
+    }
+    
     render_context_commit(&ctx, surface);
-    LOG_DEBUG("[RENDER] Drew %zu items (focus=%d) on %dx%d", 
-              visible_count, focused_index, width, height);
+    LOG_DEBUG("[RENDER] Drew %zu of %zu items (focus=%d) on %dx%d", 
+              redrawn, visible_count, focused_index, width, height);
 }
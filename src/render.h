@@ -1,7 +1,55 @@
 #pragma once
 #include <wayland-client.h>
+#include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 void render_draw(struct wl_surface *surface, int width, int height);
 void render_draw_titles(struct wl_surface *surface, int width, int height, const char **titles, size_t count);
 void render_draw_titles_focus(struct wl_surface *surface, int width, int height, const char **titles, size_t count, int focused_index);
+
+/* Text of row `index` (0 <= index < count); NULL draws "(untitled)" */
+typedef const char *(*RenderRowText)(size_t index, void *user);
+
+/*
+ * Draw the switcher list, fetching text only for the rows that are visible.
+ * render_draw_titles_focus() is this with an array of titles.
+ */
+void render_draw_rows(struct wl_surface *surface, int width, int height,
+                      RenderRowText row_text, void *user, size_t count, int focused_index);
+
+/*
+ * While deferred, finished frames are kept in their pool buffer instead of
+ * being attached, so a surface can be fully drawn before it is mapped.
+ * Only the newest frame is kept.
+ */
+void render_set_deferred(bool deferred);
+
+/*
+ * Attach and commit the frame kept while deferred.
+ *
+ * Returns:
+ *   true if a frame was pending and is now committed
+ */
+bool render_present_pending(struct wl_surface *surface);
+
+/*
+ * A selected title that does not fit scrolls back and forth (marquee_speed
+ * in the config). Each step copies a pre-rendered strip into one row band
+ * of a pool buffer and commits just that band; no text is shaped.
+ *
+ * Returns:
+ *   0 if no step is wanted (nothing scrolls, deferred, or waiting for the
+ *   compositor's frame callback), otherwise the time (flight_now() ns) at
+ *   which to call render_marquee_step()
+ */
+uint64_t render_marquee_deadline(void);
+
+/* Advance the marquee to now_ns and commit the band if it moved. */
+void render_marquee_step(struct wl_surface *surface, uint64_t now_ns);
+
+/*
+ * Free the cached panel, shadow and item images and the buffer pool.
+ * They are rebuilt on the next draw; call once at shutdown.
+ */
+void render_cleanup(void);
@@ -0,0 +1,79 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "run_or_raise.h"
+#include "ipc.h"
+#include "hypr_caps.h"
+#include "logger/logger.h"
+
+#include <regex.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <strings.h>
+
+typedef struct {
+    const RaiseRequest *req;
+    regex_t title_re;
+    size_t seen;
+} RaiseMatch;
+
+static bool raise_keep(const HyprClientInfo *client, void *user) {
+    RaiseMatch *match = user;
+    match->seen++;
+    if (match->req->app_class &&
+        strcasecmp(client->app_class ? client->app_class : "", match->req->app_class) != 0) {
+        return false;
+    }
+    if (match->req->title &&
+        regexec(&match->title_re, client->title ? client->title : "", 0, NULL, 0) != 0) {
+        return false;
+    }
+    return true;
+}
+
+int run_or_raise(const RaiseRequest *req) {
+    RaiseMatch match = { .req = req };
+    if (req->title) {
+        int rc = regcomp(&match.title_re, req->title, REG_EXTENDED | REG_NOSUB);
+        if (rc != 0) {
+            char err[128];
+            regerror(rc, &match.title_re, err, sizeof(err));
+            LOG_ERROR("[RAISE] Invalid title pattern '%s': %s", req->title, err);
+            return -1;
+        }
+    }
+
+    HyprClientInfo *list = NULL;
+    size_t count = 0;
+    int rc = hypr_ipc_get_clients_matching(&list, &count, raise_keep, &match);
+    if (req->title) {
+        regfree(&match.title_re);
+    }
+    if (rc != 0) {
+        LOG_ERROR("[RAISE] Failed to list clients");
+        return -1;
+    }
+
+    if (count == 0) {
+        if (!req->launch) {
+            LOG_INFO("[RAISE] No match among %zu windows", match.seen);
+            return 1;
+        }
+        LOG_INFO("[RAISE] No match among %zu windows; launching '%s'", match.seen, req->launch);
+        return hypr_ipc_dispatch_exec(req->launch) == 0 ? 0 : -1;
+    }
+
+    /* Most recent first; step past the window that already has focus */
+    hypr_ipc_sort_clients_by_focus(list, count);
+    const HyprClientInfo *target = &list[0];
+    if (count > 1 && target->focusHistoryID == 0) {
+        target = &list[1];
+    }
+
+    hypr_caps_init();   /* address form; cached after the first run */
+    rc = hypr_ipc_dispatch_focus(target->address);
+    LOG_INFO("[RAISE] %s %s (%s) of %zu matches, %zu windows",
+             rc == 0 ? "Focused" : "Failed to focus", target->address,
+             target->app_class ? target->app_class : "", count, match.seen);
+    hypr_ipc_free_client_infos(list, count);
+    return rc == 0 ? 0 : -1;
+}
@@ -0,0 +1,36 @@
+#pragma once
+/*
+ * run_or_raise.h - One-shot "focus this application, or start it" command
+ *
+ * `hyprswitcher --focus-class CLASS` / `--focus-title PATTERN` replaces the
+ * usual script of `hyprctl clients -j | jq ...` followed by
+ * `hyprctl dispatch focuswindow ...`: one process, one j/clients request
+ * parsed entry by entry (non-matching windows are dropped as they arrive)
+ * and one focuswindow dispatch. No Wayland connection is made and no main
+ * instance is involved.
+ *
+ * The most recently focused match wins. If that is the window already in
+ * focus, the next most recent match is taken instead, so repeating the
+ * binding cycles through the application's windows.
+ */
+
+#ifndef RUN_OR_RAISE_H
+#define RUN_OR_RAISE_H
+
+typedef struct {
+    const char *app_class;   /* Exact class, case-insensitive (NULL = any) */
+    const char *title;       /* POSIX extended regex on the title (NULL = any) */
+    const char *launch;      /* Command started via Hyprland if nothing matches */
+} RaiseRequest;
+
+/*
+ * Focus the best match for the request, or launch its command.
+ *
+ * Returns:
+ *   0: A window was focused or the command was started
+ *   1: Nothing matched and there is no command to launch
+ *   -1: Invalid pattern or Hyprland request failed
+ */
+int run_or_raise(const RaiseRequest *req);
+
+#endif /* RUN_OR_RAISE_H */
@@ -9,6 +9,7 @@
 #include <unistd.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <poll.h>
 #include <sys/socket.h>
 #include <sys/stat.h>
 #include <sys/un.h>
@@ -16,9 +17,11 @@
 /* Socket directory and file names */
 #define SWITCHER_DIR_NAME "hyprswitcher"
 #define SWITCHER_SOCKET_NAME "socket"
+#define SWITCHER_FORK_SERVER_NAME "fork-server"
 
 /* Static path buffer for socket path (computed once) */
 static char s_socket_path[256] = {0};
+static char s_fork_server_path[256] = {0};
 static char s_socket_dir[256] = {0};
 static bool s_paths_initialized = false;
 
@@ -49,6 +52,13 @@ static int init_paths(void) {
         return -1;
     }
 
+    ret = snprintf(s_fork_server_path, sizeof(s_fork_server_path), "%s/%s",
+                   s_socket_dir, SWITCHER_FORK_SERVER_NAME);
+    if (ret < 0 || (size_t)ret >= sizeof(s_fork_server_path)) {
+        LOG_ERROR("[SWITCHER_IPC] Fork server socket path too long");
+        return -1;
+    }
+
     s_paths_initialized = true;
     LOG_DEBUG("[SWITCHER_IPC] Socket path: %s", s_socket_path);
     return 0;
@@ -90,15 +100,15 @@ bool switcher_ipc_socket_exists(void) {
     return (stat(s_socket_path, &st) == 0);
 }
 
-int switcher_ipc_try_connect(void) {
-    if (init_paths() != 0) {
-        return -1;
-    }
-
+/*
+ * Connect to the socket at path, removing it if nobody listens.
+ * Returns the connected FD, or -1.
+ */
+static int connect_to(const char *path) {
     /* Quick check if socket file exists */
     struct stat st;
-    if (stat(s_socket_path, &st) != 0) {
-        LOG_DEBUG("[SWITCHER_IPC] Socket file doesn't exist, no main instance running");
+    if (stat(path, &st) != 0) {
+        LOG_DEBUG("[SWITCHER_IPC] %s doesn't exist", path);
         return -1;
     }
 
@@ -111,21 +121,39 @@ int switcher_ipc_try_connect(void) {
     struct sockaddr_un addr;
     memset(&addr, 0, sizeof(addr));
     addr.sun_family = AF_UNIX;
-    strncpy(addr.sun_path, s_socket_path, sizeof(addr.sun_path) - 1);
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
     addr.sun_path[sizeof(addr.sun_path) - 1] = '\0';
 
     if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
         LOG_DEBUG("[SWITCHER_IPC] connect() failed: %s (stale socket?)", strerror(errno));
         close(fd);
         /* Try to remove stale socket */
-        unlink(s_socket_path);
+        unlink(path);
         return -1;
     }
+    return fd;
+}
 
+int switcher_ipc_try_connect(void) {
+    if (init_paths() != 0) {
+        return -1;
+    }
+    int fd = connect_to(s_socket_path);
+    if (fd < 0) {
+        LOG_DEBUG("[SWITCHER_IPC] No main instance running");
+        return -1;
+    }
     LOG_INFO("[SWITCHER_IPC] Connected to existing main instance");
     return fd;
 }
 
+int switcher_ipc_fork_server_connect(void) {
+    if (init_paths() != 0) {
+        return -1;
+    }
+    return connect_to(s_fork_server_path);
+}
+
 int switcher_ipc_send(int fd, const char *command) {
     if (fd < 0 || !command) {
         return -1;
@@ -146,11 +174,11 @@ int switcher_ipc_send(int fd, const char *command) {
     return 0;
 }
 
-int switcher_ipc_listen(void) {
-    if (init_paths() != 0) {
-        return -1;
-    }
-
+/*
+ * Create and bind a listening socket at path inside the socket directory.
+ * Returns the listening FD (non-blocking), or -1.
+ */
+static int listen_at(const char *path) {
     /* Create directory with secure permissions */
     if (mkdir(s_socket_dir, 0700) < 0 && errno != EEXIST) {
         LOG_ERROR("[SWITCHER_IPC] mkdir(%s) failed: %s", s_socket_dir, strerror(errno));
@@ -168,7 +196,7 @@ int switcher_ipc_listen(void) {
     }
 
     /* Remove any stale socket file */
-    unlink(s_socket_path);
+    unlink(path);
 
     int fd = socket(AF_UNIX, SOCK_STREAM, 0);
     if (fd < 0) {
@@ -179,32 +207,46 @@ int switcher_ipc_listen(void) {
     struct sockaddr_un addr;
     memset(&addr, 0, sizeof(addr));
     addr.sun_family = AF_UNIX;
-    strncpy(addr.sun_path, s_socket_path, sizeof(addr.sun_path) - 1);
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
     addr.sun_path[sizeof(addr.sun_path) - 1] = '\0';
 
     if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
-        LOG_ERROR("[SWITCHER_IPC] bind(%s) failed: %s", s_socket_path, strerror(errno));
+        LOG_ERROR("[SWITCHER_IPC] bind(%s) failed: %s", path, strerror(errno));
         close(fd);
         return -1;
     }
 
     /* Set socket file permissions */
-    chmod(s_socket_path, 0600);
+    chmod(path, 0600);
 
     if (listen(fd, 5) < 0) {
         LOG_ERROR("[SWITCHER_IPC] listen() failed: %s", strerror(errno));
         close(fd);
-        unlink(s_socket_path);
+        unlink(path);
         return -1;
     }
 
     /* Set non-blocking for integration with event loop */
     set_nonblocking(fd);
 
-    LOG_INFO("[SWITCHER_IPC] Listening on %s", s_socket_path);
+    LOG_INFO("[SWITCHER_IPC] Listening on %s", path);
     return fd;
 }
 
+int switcher_ipc_listen(void) {
+    if (init_paths() != 0) {
+        return -1;
+    }
+    return listen_at(s_socket_path);
+}
+
+int switcher_ipc_fork_server_listen(void) {
+    if (init_paths() != 0) {
+        return -1;
+    }
+    return listen_at(s_fork_server_path);
+}
+
 int switcher_ipc_accept(int listen_fd) {
     if (listen_fd < 0) {
         return -1;
@@ -261,12 +303,81 @@ SwitcherCmdType switcher_ipc_read_command(int client_fd) {
         return SWITCHER_CMD_TYPE_COMMIT;
     } else if (strncmp(msg, SWITCHER_CMD_CANCEL, strlen(SWITCHER_CMD_CANCEL)) == 0) {
         return SWITCHER_CMD_TYPE_CANCEL;
+    } else if (strncmp(msg, SWITCHER_CMD_PREPARE, strlen(SWITCHER_CMD_PREPARE)) == 0) {
+        return SWITCHER_CMD_TYPE_PREPARE;
+    } else if (strncmp(msg, SWITCHER_CMD_SORT_MRU, strlen(SWITCHER_CMD_SORT_MRU)) == 0) {
+        return SWITCHER_CMD_TYPE_SORT_MRU;
+    } else if (strncmp(msg, SWITCHER_CMD_SORT_CLASS, strlen(SWITCHER_CMD_SORT_CLASS)) == 0) {
+        return SWITCHER_CMD_TYPE_SORT_CLASS;
+    } else if (strncmp(msg, SWITCHER_CMD_SORT_WORKSPACE, strlen(SWITCHER_CMD_SORT_WORKSPACE)) == 0) {
+        return SWITCHER_CMD_TYPE_SORT_WORKSPACE;
+    } else if (strncmp(msg, SWITCHER_CMD_SORT_MONITOR, strlen(SWITCHER_CMD_SORT_MONITOR)) == 0) {
+        return SWITCHER_CMD_TYPE_SORT_MONITOR;
+    } else if (strncmp(msg, SWITCHER_CMD_CLASS_BACKWARD, strlen(SWITCHER_CMD_CLASS_BACKWARD)) == 0) {
+        return SWITCHER_CMD_TYPE_CLASS_BACKWARD;
+    } else if (strncmp(msg, SWITCHER_CMD_CLASS, strlen(SWITCHER_CMD_CLASS)) == 0) {
+        return SWITCHER_CMD_TYPE_CLASS;
+    } else if (strncmp(msg, SWITCHER_CMD_LIST_TSV, strlen(SWITCHER_CMD_LIST_TSV)) == 0) {
+        return SWITCHER_CMD_TYPE_LIST_TSV;
+    } else if (strncmp(msg, SWITCHER_CMD_LIST_JSON, strlen(SWITCHER_CMD_LIST_JSON)) == 0) {
+        return SWITCHER_CMD_TYPE_LIST_JSON;
+    } else if (strncmp(msg, SWITCHER_CMD_LIST_BIN, strlen(SWITCHER_CMD_LIST_BIN)) == 0) {
+        return SWITCHER_CMD_TYPE_LIST_BIN;
     }
 
     LOG_WARN("[SWITCHER_IPC] Unknown command: '%s'", msg);
     return SWITCHER_CMD_TYPE_UNKNOWN;
 }
 
+/* Time either side waits for the other before giving up on a reply */
+#define SWITCHER_REPLY_TIMEOUT_MS 200
+
+int switcher_ipc_reply(int client_fd, const char *data, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(client_fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            struct pollfd pfd = { .fd = client_fd, .events = POLLOUT };
+            if ((errno == EAGAIN || errno == EWOULDBLOCK) &&
+                poll(&pfd, 1, SWITCHER_REPLY_TIMEOUT_MS) > 0) {
+                continue;
+            }
+            LOG_WARN("[SWITCHER_IPC] Reply not delivered (%zu bytes left): %s", len,
+                     errno ? strerror(errno) : "timeout");
+            return -1;
+        }
+        data += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+long switcher_ipc_receive_reply(int fd, int out_fd) {
+    char buf[16384];
+    long total = 0;
+    for (;;) {
+        /* The main loop answers between frames; allow it a few */
+        struct pollfd pfd = { .fd = fd, .events = POLLIN };
+        int ready = poll(&pfd, 1, SWITCHER_REPLY_TIMEOUT_MS * 5);
+        if (ready < 0 && errno == EINTR) continue;
+        if (ready <= 0) {
+            LOG_WARN("[SWITCHER_IPC] No reply from main instance");
+            return total > 0 ? -1 : 0;
+        }
+        ssize_t n = read(fd, buf, sizeof(buf));
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) return -1;
+        if (n == 0) return total;
+        for (ssize_t off = 0; off < n;) {
+            ssize_t w = write(out_fd, buf + off, (size_t)(n - off));
+            if (w < 0 && errno == EINTR) continue;
+            if (w < 0) return -1;
+            off += w;
+        }
+        total += n;
+    }
+}
+
 void switcher_ipc_cleanup(int listen_fd) {
     if (listen_fd >= 0) {
         close(listen_fd);
@@ -288,3 +399,13 @@ void switcher_ipc_cleanup(int listen_fd) {
 
     LOG_INFO("[SWITCHER_IPC] Cleanup complete");
 }
+
+void switcher_ipc_fork_server_cleanup(int listen_fd) {
+    if (listen_fd >= 0) {
+        close(listen_fd);
+    }
+    if (s_paths_initialized && s_fork_server_path[0] != '\0') {
+        unlink(s_fork_server_path);
+        rmdir(s_socket_dir);   /* only if no main instance is running */
+    }
+}
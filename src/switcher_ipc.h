@@ -7,12 +7,21 @@
  * - Subsequent invocations become "helper instances" (send command to main, exit immediately)
  *
  * Socket location: $XDG_RUNTIME_DIR/hyprswitcher/socket
+ * Fork server (fork_server.h): $XDG_RUNTIME_DIR/hyprswitcher/fork-server,
+ * same 16-byte commands, answered with one byte once a session owns the
+ * main socket
  *
  * Commands (fixed 16-byte messages, null-padded):
  *   "CYCLE"          - Cycle selection forward
  *   "CYCLE_BACKWARD" - Cycle selection backward (Shift+Tab)
  *   "COMMIT"         - Commit current selection and close
  *   "CANCEL"         - Cancel and restore original focus
+ *   "PREPARE"        - Alt is down, Tab may follow: refresh a stale list
+ *   "SORT_<ORDER>"   - Reorder the list (MRU, CLASS, WORKSPACE, MONITOR)
+ *   "CLASS"          - Cycle through the focused application's windows
+ *   "CLASS_BACKWARD" - Same, in reverse
+ *   "LIST_<FORMAT>"  - Reply with the window list (TSV, JSON, BIN; see
+ *                      list_output.h), then close
  */
 
 #ifndef SWITCHER_IPC_H
@@ -29,6 +38,16 @@
 #define SWITCHER_CMD_CYCLE_BACKWARD "CYCLE_BACKWARD"
 #define SWITCHER_CMD_COMMIT         "COMMIT"
 #define SWITCHER_CMD_CANCEL         "CANCEL"
+#define SWITCHER_CMD_PREPARE        "PREPARE"
+#define SWITCHER_CMD_SORT_MRU       "SORT_MRU"
+#define SWITCHER_CMD_SORT_CLASS     "SORT_CLASS"
+#define SWITCHER_CMD_SORT_WORKSPACE "SORT_WORKSPACE"
+#define SWITCHER_CMD_SORT_MONITOR   "SORT_MONITOR"
+#define SWITCHER_CMD_CLASS          "CLASS"
+#define SWITCHER_CMD_CLASS_BACKWARD "CLASS_BACKWARD"
+#define SWITCHER_CMD_LIST_TSV       "LIST_TSV"
+#define SWITCHER_CMD_LIST_JSON      "LIST_JSON"
+#define SWITCHER_CMD_LIST_BIN       "LIST_BIN"
 
 /* Command type enum for easier handling */
 typedef enum {
@@ -37,6 +56,16 @@ typedef enum {
     SWITCHER_CMD_TYPE_CYCLE_BACKWARD,
     SWITCHER_CMD_TYPE_COMMIT,
     SWITCHER_CMD_TYPE_CANCEL,
+    SWITCHER_CMD_TYPE_PREPARE,
+    SWITCHER_CMD_TYPE_SORT_MRU,          /* SORT_* follow SortOrder (config.h) */
+    SWITCHER_CMD_TYPE_SORT_CLASS,
+    SWITCHER_CMD_TYPE_SORT_WORKSPACE,
+    SWITCHER_CMD_TYPE_SORT_MONITOR,
+    SWITCHER_CMD_TYPE_CLASS,
+    SWITCHER_CMD_TYPE_CLASS_BACKWARD,
+    SWITCHER_CMD_TYPE_LIST_TSV,          /* LIST_* follow ListFormat (list_output.h) */
+    SWITCHER_CMD_TYPE_LIST_JSON,
+    SWITCHER_CMD_TYPE_LIST_BIN,
     SWITCHER_CMD_TYPE_UNKNOWN
 } SwitcherCmdType;
 
@@ -94,6 +123,26 @@ int switcher_ipc_accept(int listen_fd);
  */
 SwitcherCmdType switcher_ipc_read_command(int client_fd);
 
+/*
+ * Answer a command that expects a reply (LIST_*) on its client socket.
+ * Waits up to 200 ms whenever the helper is not reading.
+ *
+ * Returns:
+ *   0:  Reply written
+ *   -1: Error or the helper stopped reading
+ */
+int switcher_ipc_reply(int client_fd, const char *data, size_t len);
+
+/*
+ * Copy the main instance's reply to a command sent with switcher_ipc_send()
+ * to out_fd, until the main instance closes the connection.
+ *
+ * Returns:
+ *   Bytes copied (0 = no reply: the main instance closed the connection or
+ *   did not answer in time), or -1 on error or a reply cut short
+ */
+long switcher_ipc_receive_reply(int fd, int out_fd);
+
 /*
  * Get the socket file path.
  * Useful for logging/debugging.
@@ -115,6 +164,22 @@ int switcher_ipc_get_socket_path(char *buf, size_t bufsize);
  */
 void switcher_ipc_cleanup(int listen_fd);
 
+/*
+ * Same as switcher_ipc_try_connect() and switcher_ipc_listen(), for the
+ * fork server's socket.
+ *
+ * Returns:
+ *   Socket FD, or -1 (no fork server running / error logged)
+ */
+int switcher_ipc_fork_server_connect(void);
+int switcher_ipc_fork_server_listen(void);
+
+/*
+ * Close the fork server's listening socket and unlink its file.
+ * Safe to call with fd=-1.
+ */
+void switcher_ipc_fork_server_cleanup(int listen_fd);
+
 /*
  * Check if socket file exists (quick check without connecting).
  *
@@ -0,0 +1,280 @@
+#define _GNU_SOURCE
+
+#include "switcher_ring.h"
+#include "logger/logger.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <linux/futex.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+
+#define RING_FILE_NAME "ring"
+#define RING_MAGIC     0x48535752u  /* "HSWR" */
+#define RING_VERSION   1u
+
+/*
+ * Slot sequence protocol (bounded MPSC queue):
+ *   seq == pos          slot free for the producer reserving position pos
+ *   seq == pos + 1      slot holds a published command for position pos
+ *   seq == pos + SLOTS  slot consumed, free for the next lap
+ */
+typedef struct {
+    _Atomic uint32_t seq;
+    uint32_t cmd;
+} RingSlot;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    int32_t owner_pid;
+    _Atomic uint32_t head;   /* next position to reserve (producers, CAS) */
+    _Atomic uint32_t tail;   /* next position to consume (owner only) */
+    _Atomic uint32_t wake;   /* futex word, bumped after every publish */
+    RingSlot slots[SWITCHER_RING_SLOTS];
+} RingShared;
+
+/* Owner-side state */
+static RingShared *s_ring = NULL;
+static char s_ring_path[256] = {0};
+static int s_event_fd = -1;
+static pthread_t s_watcher;
+static bool s_watcher_running = false;
+static atomic_bool s_watcher_stop = false;
+
+static long futex_call(_Atomic uint32_t *addr, int op, uint32_t val) {
+    return syscall(SYS_futex, (uint32_t *)addr, op, val, NULL, NULL, 0);
+}
+
+/*
+ * Build $XDG_RUNTIME_DIR/hyprswitcher/ring next to the command socket.
+ */
+static int ring_path(char *buf, size_t bufsize) {
+    char sock[256];
+    if (switcher_ipc_get_socket_path(sock, sizeof(sock)) != 0) {
+        return -1;
+    }
+    char *slash = strrchr(sock, '/');
+    if (!slash) {
+        return -1;
+    }
+    *slash = '\0';
+    int ret = snprintf(buf, bufsize, "%s/%s", sock, RING_FILE_NAME);
+    if (ret < 0 || (size_t)ret >= bufsize) {
+        return -1;
+    }
+    return 0;
+}
+
+/*
+ * Watcher thread: sleep on the wake word, forward each change to the eventfd.
+ * A publish between the load and FUTEX_WAIT makes the wait fail with EAGAIN,
+ * so no wakeup is lost.
+ */
+static void *watcher_main(void *arg) {
+    (void)arg;
+    uint32_t seen = atomic_load(&s_ring->wake);
+
+    while (!atomic_load(&s_watcher_stop)) {
+        if (futex_call(&s_ring->wake, FUTEX_WAIT, seen) < 0 &&
+            errno != EAGAIN && errno != EINTR) {
+            LOG_WARN("[SWITCHER_RING] futex wait failed: %s", strerror(errno));
+            break;
+        }
+        uint32_t now = atomic_load(&s_ring->wake);
+        if (now != seen) {
+            seen = now;
+            eventfd_write(s_event_fd, 1);
+        }
+    }
+    return NULL;
+}
+
+int switcher_ring_create(void) {
+    if (ring_path(s_ring_path, sizeof(s_ring_path)) != 0) {
+        LOG_WARN("[SWITCHER_RING] Could not determine ring path");
+        return -1;
+    }
+
+    unlink(s_ring_path);
+    int fd = open(s_ring_path, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        LOG_WARN("[SWITCHER_RING] open(%s) failed: %s", s_ring_path, strerror(errno));
+        return -1;
+    }
+    if (ftruncate(fd, (off_t)sizeof(RingShared)) < 0) {
+        LOG_WARN("[SWITCHER_RING] ftruncate failed: %s", strerror(errno));
+        close(fd);
+        unlink(s_ring_path);
+        return -1;
+    }
+
+    void *map = mmap(NULL, sizeof(RingShared), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        LOG_WARN("[SWITCHER_RING] mmap failed: %s", strerror(errno));
+        unlink(s_ring_path);
+        return -1;
+    }
+    s_ring = map;
+
+    for (uint32_t i = 0; i < SWITCHER_RING_SLOTS; i++) {
+        atomic_init(&s_ring->slots[i].seq, i);
+        s_ring->slots[i].cmd = SWITCHER_CMD_TYPE_NONE;
+    }
+    atomic_init(&s_ring->head, 0);
+    atomic_init(&s_ring->tail, 0);
+    atomic_init(&s_ring->wake, 0);
+    s_ring->owner_pid = (int32_t)getpid();
+    s_ring->version = RING_VERSION;
+    /* Magic last: helpers ignore the file until it is fully initialized */
+    atomic_thread_fence(memory_order_release);
+    s_ring->magic = RING_MAGIC;
+
+    s_event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (s_event_fd < 0) {
+        LOG_WARN("[SWITCHER_RING] eventfd failed: %s", strerror(errno));
+        switcher_ring_destroy();
+        return -1;
+    }
+
+    atomic_store(&s_watcher_stop, false);
+    if (pthread_create(&s_watcher, NULL, watcher_main, NULL) != 0) {
+        LOG_WARN("[SWITCHER_RING] Failed to start watcher thread");
+        switcher_ring_destroy();
+        return -1;
+    }
+    s_watcher_running = true;
+
+    LOG_INFO("[SWITCHER_RING] Command ring ready at %s (event fd=%d)", s_ring_path, s_event_fd);
+    return s_event_fd;
+}
+
+SwitcherCmdType switcher_ring_pop(void) {
+    if (!s_ring) {
+        return SWITCHER_CMD_TYPE_NONE;
+    }
+
+    eventfd_t ignored;
+    eventfd_read(s_event_fd, &ignored);
+
+    uint32_t pos = atomic_load_explicit(&s_ring->tail, memory_order_relaxed);
+    RingSlot *slot = &s_ring->slots[pos % SWITCHER_RING_SLOTS];
+    uint32_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+    if ((int32_t)(seq - (pos + 1)) != 0) {
+        return SWITCHER_CMD_TYPE_NONE;
+    }
+
+    uint32_t cmd = slot->cmd;
+    atomic_store_explicit(&slot->seq, pos + SWITCHER_RING_SLOTS, memory_order_release);
+    atomic_store_explicit(&s_ring->tail, pos + 1, memory_order_relaxed);
+
+    if (cmd <= SWITCHER_CMD_TYPE_NONE || cmd >= SWITCHER_CMD_TYPE_UNKNOWN) {
+        LOG_WARN("[SWITCHER_RING] Invalid command %u in slot %u", cmd, pos);
+        return SWITCHER_CMD_TYPE_UNKNOWN;
+    }
+    LOG_DEBUG("[SWITCHER_RING] Popped command %u (pos=%u)", cmd, pos);
+    return (SwitcherCmdType)cmd;
+}
+
+void switcher_ring_destroy(void) {
+    if (s_watcher_running) {
+        atomic_store(&s_watcher_stop, true);
+        atomic_fetch_add(&s_ring->wake, 1);
+        futex_call(&s_ring->wake, FUTEX_WAKE, 1);
+        pthread_join(s_watcher, NULL);
+        s_watcher_running = false;
+    }
+    if (s_event_fd >= 0) {
+        close(s_event_fd);
+        s_event_fd = -1;
+    }
+    if (s_ring) {
+        s_ring->magic = 0;
+        munmap(s_ring, sizeof(RingShared));
+        s_ring = NULL;
+    }
+    if (s_ring_path[0] != '\0') {
+        unlink(s_ring_path);
+        LOG_DEBUG("[SWITCHER_RING] Removed ring file: %s", s_ring_path);
+        s_ring_path[0] = '\0';
+    }
+}
+
+int switcher_ring_try_send(SwitcherCmdType cmd) {
+    char path[256];
+    if (ring_path(path, sizeof(path)) != 0) {
+        return -1;
+    }
+
+    int fd = open(path, O_RDWR | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size != (off_t)sizeof(RingShared)) {
+        close(fd);
+        return -1;
+    }
+    RingShared *ring = mmap(NULL, sizeof(RingShared), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (ring == MAP_FAILED) {
+        return -1;
+    }
+
+    int rc = -1;
+    if (ring->magic != RING_MAGIC || ring->version != RING_VERSION) {
+        LOG_DEBUG("[SWITCHER_RING] Ring not initialized, falling back to socket");
+        goto out;
+    }
+    atomic_thread_fence(memory_order_acquire);
+    if (kill((pid_t)ring->owner_pid, 0) != 0 && errno == ESRCH) {
+        LOG_DEBUG("[SWITCHER_RING] Ring owner %d is gone, falling back to socket",
+                  ring->owner_pid);
+        goto out;
+    }
+
+    /* Reserve a slot */
+    uint32_t pos = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    RingSlot *slot;
+    for (;;) {
+        slot = &ring->slots[pos % SWITCHER_RING_SLOTS];
+        uint32_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        int32_t diff = (int32_t)(seq - pos);
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&ring->head, &pos, pos + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            LOG_WARN("[SWITCHER_RING] Ring full, falling back to socket");
+            goto out;
+        } else {
+            pos = atomic_load_explicit(&ring->head, memory_order_relaxed);
+        }
+    }
+
+    /* Publish and wake the owner */
+    slot->cmd = (uint32_t)cmd;
+    atomic_store_explicit(&slot->seq, pos + 1, memory_order_release);
+    atomic_fetch_add(&ring->wake, 1);
+    futex_call(&ring->wake, FUTEX_WAKE, 1);
+
+    LOG_INFO("[SWITCHER_RING] Sent command %d (pos=%u)", (int)cmd, pos);
+    rc = 0;
+
+out:
+    munmap(ring, sizeof(RingShared));
+    return rc;
+}
@@ -0,0 +1,61 @@
+#pragma once
+/*
+ * switcher_ring.h - Shared-memory command ring for helper -> main instance commands
+ *
+ * Optional fast path next to the socket protocol in switcher_ipc.c.
+ * Enabled with `command_ring=true` in the config file.
+ *
+ * Layout:
+ *   - The main instance creates $XDG_RUNTIME_DIR/hyprswitcher/ring (mode 0600)
+ *     holding a small fixed-size ring of command slots.
+ *   - Helpers map the same file, reserve a slot with an atomic CAS on the
+ *     shared head counter, publish the command and FUTEX_WAKE the owner.
+ *   - A watcher thread in the main instance FUTEX_WAITs on the wake word and
+ *     signals an eventfd that the Wayland loop polls alongside its other FDs.
+ *
+ * Sending a command costs an open + mmap + CAS + futex syscall; there is
+ * no connect/accept/close round trip. Whenever the ring is missing, full,
+ * or owned by a dead process, helpers fall back to the socket protocol.
+ */
+
+#ifndef SWITCHER_RING_H
+#define SWITCHER_RING_H
+
+#include "switcher_ipc.h"
+
+/* Number of command slots (power of two) */
+#define SWITCHER_RING_SLOTS 32
+
+/*
+ * Create the ring file and start the watcher thread (main instance).
+ *
+ * Returns:
+ *   >= 0: eventfd (non-blocking) that becomes readable when commands arrive
+ *   -1:   Error (logged); the socket protocol remains available
+ */
+int switcher_ring_create(void);
+
+/*
+ * Pop the next pending command, draining the eventfd as needed.
+ *
+ * Returns:
+ *   Command type, or SWITCHER_CMD_TYPE_NONE if the ring is empty
+ */
+SwitcherCmdType switcher_ring_pop(void);
+
+/*
+ * Stop the watcher thread, unmap and unlink the ring file.
+ * Safe to call when switcher_ring_create() failed or was never called.
+ */
+void switcher_ring_destroy(void);
+
+/*
+ * Enqueue a command into a running main instance's ring (helper).
+ *
+ * Returns:
+ *   0:  Command published and owner woken
+ *   -1: No usable ring (missing, stale or full); use the socket instead
+ */
+int switcher_ring_try_send(SwitcherCmdType cmd);
+
+#endif /* SWITCHER_RING_H */
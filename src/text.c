@@ -0,0 +1,182 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "text.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ONES  0x0101010101010101ull
+#define HIGHS 0x8080808080808080ull
+
+static const char s_replacement[] = "\xEF\xBF\xBD";  /* U+FFFD */
+static const char s_ellipsis[] = "\xE2\x80\xA6";     /* U+2026 */
+
+/*
+ * True if all eight bytes are printable ASCII (0x20-0x7E) and no two
+ * spaces are adjacent, i.e. the chunk can be copied unchanged.
+ */
+static inline bool chunk_is_plain(uint64_t v) {
+    if (v & HIGHS) {
+        return false;                                   /* non-ASCII */
+    }
+    if ((v - 0x20 * ONES) & ~v & HIGHS) {
+        return false;                                   /* byte < 0x20 */
+    }
+    if ((v + ONES) & HIGHS) {
+        return false;                                   /* 0x7F */
+    }
+    uint64_t t = v ^ (0x20 * ONES);
+    uint64_t spaces = ~(((t & 0x7F * ONES) + 0x7F * ONES) | t) & HIGHS;
+    return (spaces & (spaces << 8)) == 0;               /* no "  " */
+}
+
+static bool is_ascii_space(unsigned char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+/*
+ * Decode one UTF-8 sequence (RFC 3629: no overlongs, surrogates or
+ * code points above U+10FFFF).
+ *
+ * Returns:
+ *   Sequence length (2-4) with *cp set, or 0 if the bytes are invalid
+ */
+static size_t utf8_decode(const unsigned char *s, size_t len, uint32_t *cp) {
+    unsigned char c = s[0];
+    size_t n;
+    uint32_t min;
+    if (c >= 0xC2 && c <= 0xDF) {
+        n = 2; min = 0x80;    *cp = c & 0x1F;
+    } else if (c >= 0xE0 && c <= 0xEF) {
+        n = 3; min = 0x800;   *cp = c & 0x0F;
+    } else if (c >= 0xF0 && c <= 0xF4) {
+        n = 4; min = 0x10000; *cp = c & 0x07;
+    } else {
+        return 0;
+    }
+    if (len < n) {
+        return 0;
+    }
+    for (size_t i = 1; i < n; i++) {
+        if ((s[i] & 0xC0) != 0x80) {
+            return 0;
+        }
+        *cp = (*cp << 6) | (s[i] & 0x3F);
+    }
+    if (*cp < min || *cp > 0x10FFFF || (*cp >= 0xD800 && *cp <= 0xDFFF)) {
+        return 0;
+    }
+    return n;
+}
+
+size_t text_sanitize(char *dst, size_t dst_size, const char *src, size_t src_len) {
+    if (!dst || dst_size == 0) {
+        return 0;
+    }
+    size_t cap = dst_size - 1;
+    if (cap > TEXT_MAX_BYTES) {
+        cap = TEXT_MAX_BYTES;
+    }
+    if (!src) {
+        dst[0] = '\0';
+        return 0;
+    }
+
+    const unsigned char *s = (const unsigned char *)src;
+    size_t in = 0;
+    size_t out = 0;
+    bool pending_space = false;   /* emitted lazily, so trailing space is dropped */
+    bool truncated = false;
+
+    while (in < src_len) {
+        /* Fast path: copy runs of plain ASCII eight bytes at a time */
+        if (!pending_space && src_len - in >= 8 && cap - out >= 8) {
+            uint64_t v;
+            memcpy(&v, s + in, sizeof(v));
+            if (chunk_is_plain(v) && s[in] != ' ' && s[in + 7] != ' ') {
+                memcpy(dst + out, s + in, 8);
+                in += 8;
+                out += 8;
+                continue;
+            }
+        }
+
+        const char *bytes = (const char *)s + in;
+        size_t n = 1;
+        unsigned char c = s[in];
+
+        if (c < 0x80) {
+            if (is_ascii_space(c)) {
+                pending_space = (out > 0);
+                in++;
+                continue;
+            }
+            in++;
+            if (c < 0x20 || c == 0x7F) {
+                continue;
+            }
+        } else {
+            uint32_t cp;
+            n = utf8_decode(s + in, src_len - in, &cp);
+            if (n == 0) {
+                bytes = s_replacement;
+                n = 3;
+                in++;
+            } else if (cp <= 0x9F) {
+                in += n;                  /* C1 control */
+                continue;
+            } else if (cp == 0x2028 || cp == 0x2029) {
+                pending_space = (out > 0);  /* line/paragraph separator */
+                in += n;
+                continue;
+            } else {
+                in += n;
+            }
+        }
+
+        if (out + (pending_space ? 1 : 0) + n > cap) {
+            truncated = true;
+            break;
+        }
+        if (pending_space) {
+            dst[out++] = ' ';
+            pending_space = false;
+        }
+        memcpy(dst + out, bytes, n);
+        out += n;
+    }
+
+    if (truncated && cap >= sizeof(s_ellipsis) - 1) {
+        size_t room = cap - (sizeof(s_ellipsis) - 1);
+        while (out > room) {
+            out--;
+            /* Back up to the start of the character we are cutting into */
+            while (out > 0 && ((unsigned char)dst[out] & 0xC0) == 0x80) {
+                out--;
+            }
+        }
+        while (out > 0 && dst[out - 1] == ' ') {
+            out--;
+        }
+        memcpy(dst + out, s_ellipsis, sizeof(s_ellipsis) - 1);
+        out += sizeof(s_ellipsis) - 1;
+    }
+
+    dst[out] = '\0';
+    return out;
+}
+
+char *text_sanitize_dup(const char *src) {
+    if (!src) {
+        return NULL;
+    }
+    char buf[TEXT_MAX_BYTES + 1];
+    size_t len = text_sanitize(buf, sizeof(buf), src, strlen(src));
+    char *copy = malloc(len + 1);
+    if (copy) {
+        memcpy(copy, buf, len + 1);
+    }
+    return copy;
+}
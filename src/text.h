@@ -0,0 +1,49 @@
+#pragma once
+/*
+ * text.h - Normalization of window titles and classes at ingest
+ *
+ * Titles come from other applications and can contain anything: invalid
+ * UTF-8, control characters, runs of whitespace or many kilobytes of text.
+ * Left alone, that reaches Pango on every frame, which then has to validate
+ * and fall back itself. Everything received from j/clients and the event
+ * socket is passed through text_sanitize() once instead, so the rest of the
+ * program can treat window text as short, valid, printable UTF-8.
+ */
+
+#ifndef TEXT_H
+#define TEXT_H
+
+#include <stddef.h>
+
+/* Longest text ever displayed in a row (bytes, excluding the terminator) */
+#define TEXT_MAX_BYTES 255
+
+/*
+ * Copy `src` into `dst` as normalized text:
+ *   - invalid UTF-8 sequences become U+FFFD
+ *   - control characters (C0, DEL, C1) are removed
+ *   - whitespace runs collapse to one space; leading/trailing space is trimmed
+ *   - the result is capped at min(dst_size - 1, TEXT_MAX_BYTES) bytes on a
+ *     character boundary, ending in "…" when something was cut
+ * Plain printable ASCII is handled eight bytes at a time.
+ *
+ * @param dst      Output buffer (always NUL-terminated if dst_size > 0)
+ * @param dst_size Size of dst in bytes
+ * @param src      Input bytes (need not be NUL-terminated)
+ * @param src_len  Number of input bytes
+ *
+ * Returns:
+ *   Length of the normalized text in bytes
+ */
+size_t text_sanitize(char *dst, size_t dst_size, const char *src, size_t src_len);
+
+/*
+ * Allocate a normalized copy of a NUL-terminated string.
+ *
+ * Returns:
+ *   Newly allocated string (caller frees), or NULL if src is NULL or
+ *   allocation failed
+ */
+char *text_sanitize_dup(const char *src);
+
+#endif /* TEXT_H */
@@ -0,0 +1,142 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "title_throttle.h"
+#include "text.h"
+#include "logger/logger.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    char address[32];
+    char title[TEXT_MAX_BYTES + 1];
+    uint64_t applied_ns;     /* Last title of this window applied (0 = never) */
+    bool held;               /* title not applied yet */
+} TitleSlot;
+
+static TitleSlot *s_slots = NULL;
+static size_t s_count = 0;
+static size_t s_capacity = 0;
+
+static TitleSlot *slot_find(const char *address) {
+    for (size_t i = 0; i < s_count; i++) {
+        if (strcmp(s_slots[i].address, address) == 0) {
+            return &s_slots[i];
+        }
+    }
+    return NULL;
+}
+
+static TitleSlot *slot_add(const char *address) {
+    if (s_count == s_capacity) {
+        size_t capacity = s_capacity ? s_capacity * 2 : 16;
+        TitleSlot *grown = realloc(s_slots, capacity * sizeof(*grown));
+        if (!grown) {
+            LOG_ERROR("[TITLE] Out of memory tracking %s", address);
+            return NULL;
+        }
+        s_slots = grown;
+        s_capacity = capacity;
+    }
+    TitleSlot *slot = &s_slots[s_count++];
+    snprintf(slot->address, sizeof(slot->address), "%s", address);
+    slot->title[0] = '\0';
+    slot->applied_ns = 0;
+    slot->held = false;
+    return slot;
+}
+
+static void slot_remove(size_t index) {
+    s_slots[index] = s_slots[--s_count];
+}
+
+static bool slot_due(const TitleSlot *slot, uint64_t now_ns, uint64_t interval_ns) {
+    return slot->applied_ns == 0 || now_ns - slot->applied_ns >= interval_ns;
+}
+
+bool title_throttle_offer(const char *address, const char *title, uint64_t now_ns,
+                          uint64_t interval_ns, bool visible) {
+    if (!address || !title) {
+        return false;
+    }
+    TitleSlot *slot = slot_find(address);
+
+    if (visible && (!slot || slot_due(slot, now_ns, interval_ns))) {
+        if (!slot && interval_ns > 0) {
+            slot = slot_add(address);
+        }
+        if (slot) {
+            slot->applied_ns = now_ns;
+            slot->held = false;
+        }
+        return true;
+    }
+
+    if (!slot) {
+        slot = slot_add(address);
+        if (!slot) {
+            return visible;   /* untracked: better a repaint than a stale title */
+        }
+    }
+    snprintf(slot->title, sizeof(slot->title), "%s", title);
+    slot->held = true;
+    return false;
+}
+
+size_t title_throttle_flush(uint64_t now_ns, uint64_t interval_ns, bool force,
+                            TitleApplyFn apply, void *user) {
+    size_t applied = 0;
+    size_t i = 0;
+    while (i < s_count) {
+        TitleSlot *slot = &s_slots[i];
+        bool due = slot_due(slot, now_ns, interval_ns);
+        if (slot->held && (force || due)) {
+            apply(slot->address, slot->title, user);
+            slot->applied_ns = now_ns;
+            slot->held = false;
+            applied++;
+            due = interval_ns == 0;
+        }
+        /* Quiet for a whole interval: the next change goes straight through */
+        if (!slot->held && due) {
+            slot_remove(i);
+            continue;
+        }
+        i++;
+    }
+    if (applied > 0) {
+        LOG_DEBUG("[TITLE] Applied %zu held titles (%zu windows tracked)", applied, s_count);
+    }
+    return applied;
+}
+
+uint64_t title_throttle_next_due(uint64_t interval_ns) {
+    uint64_t next = 0;
+    for (size_t i = 0; i < s_count; i++) {
+        if (!s_slots[i].held) {
+            continue;
+        }
+        uint64_t due = s_slots[i].applied_ns + interval_ns;
+        if (next == 0 || due < next) {
+            next = due;
+        }
+    }
+    return next;
+}
+
+void title_throttle_forget(const char *address) {
+    for (size_t i = 0; address && i < s_count; i++) {
+        if (strcmp(s_slots[i].address, address) == 0) {
+            slot_remove(i);
+            return;
+        }
+    }
+}
+
+void title_throttle_reset(void) {
+    free(s_slots);
+    s_slots = NULL;
+    s_count = 0;
+    s_capacity = 0;
+}
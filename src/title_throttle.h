@@ -0,0 +1,65 @@
+#pragma once
+/*
+ * title_throttle.h - Per-window rate limit for live title updates
+ *
+ * Terminals with progress bars and browsers with animated titles can send
+ * dozens of windowtitlev2 events per second, and every applied title costs
+ * a reshape and a repaint. While the overlay is visible a window's title is
+ * applied at most once per interval: the first change goes through, later
+ * ones only replace the held title, and the latest one is applied when the
+ * interval has passed. While the overlay is hidden nothing is applied; the
+ * held titles are flushed when it is shown.
+ *
+ * Only windows that changed their title within the last interval (or have
+ * one held) occupy a slot, so lookups stay short however many windows are
+ * open. Times are CLOCK_MONOTONIC nanoseconds (flight_now()).
+ */
+
+#ifndef TITLE_THROTTLE_H
+#define TITLE_THROTTLE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Called for every held title that is due */
+typedef void (*TitleApplyFn)(const char *address, const char *title, void *user);
+
+/*
+ * Record a title change.
+ *
+ * @param interval_ns Minimum time between two applied titles of one window
+ * @param visible     Whether the overlay is shown (hidden: always hold)
+ *
+ * Returns:
+ *   true:  Apply `title` now
+ *   false: Held until title_throttle_flush()
+ */
+bool title_throttle_offer(const char *address, const char *title, uint64_t now_ns,
+                          uint64_t interval_ns, bool visible);
+
+/*
+ * Apply held titles whose interval has passed, or all of them with force
+ * (the overlay was just shown).
+ *
+ * Returns:
+ *   Number of titles passed to `apply`
+ */
+size_t title_throttle_flush(uint64_t now_ns, uint64_t interval_ns, bool force,
+                            TitleApplyFn apply, void *user);
+
+/*
+ * Earliest time a held title becomes due.
+ *
+ * Returns:
+ *   Deadline in ns, or 0 if no title is held
+ */
+uint64_t title_throttle_next_due(uint64_t interval_ns);
+
+/* Drop the state of a closed window. */
+void title_throttle_forget(const char *address);
+
+/* Drop all state (shutdown). */
+void title_throttle_reset(void);
+
+#endif /* TITLE_THROTTLE_H */
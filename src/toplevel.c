@@ -0,0 +1,454 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "toplevel.h"
+#include "config.h"
+#include "text.h"
+#include "logger/logger.h"
+
+#include <wayland-client.h>
+#include "wlr-foreign-toplevel-management-unstable-v1-client-protocol.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define TOPLEVEL_MANAGER_VERSION 3
+
+/* Windows remembered across sessions in $STATE/toplevel-recency */
+#define RECENCY_MAX 32
+#define RECENCY_FILE "toplevel-recency"
+
+typedef struct Toplevel {
+    struct zwlr_foreign_toplevel_handle_v1 *handle;
+    uint32_t id;
+    char *title;
+    char *app_id;
+    bool activated;
+    uint64_t active_seq;       /* activation order; 0 = never seen active */
+    int seed_rank;             /* position in the previous session's order; -1 = none */
+
+    /* Double-buffered until the done event */
+    char *pending_title;
+    char *pending_app_id;
+    bool pending_activated;
+    bool has_pending_state;
+
+    struct Toplevel *next;
+} Toplevel;
+
+static struct zwlr_foreign_toplevel_manager_v1 *s_manager = NULL;
+static Toplevel *s_toplevels = NULL;   /* newest first */
+static uint32_t s_next_id = 0;
+static uint64_t s_active_seq = 0;
+static bool s_changed = false;
+
+/* The previous session's window order (app_id, title), most recent first */
+typedef struct {
+    char *app_id;
+    char *title;
+    bool used;
+} RecencyEntry;
+static RecencyEntry s_recency[RECENCY_MAX];
+static size_t s_recency_count = 0;
+static bool s_recency_loaded = false;
+
+static void toplevel_free(Toplevel *tl) {
+    if (tl->handle) {
+        zwlr_foreign_toplevel_handle_v1_destroy(tl->handle);
+    }
+    free(tl->title);
+    free(tl->app_id);
+    free(tl->pending_title);
+    free(tl->pending_app_id);
+    free(tl);
+}
+
+static void handle_title(void *data, struct zwlr_foreign_toplevel_handle_v1 *handle,
+                         const char *title) {
+    (void)handle;
+    Toplevel *tl = data;
+    free(tl->pending_title);
+    tl->pending_title = text_sanitize_dup(title);
+}
+
+static void handle_app_id(void *data, struct zwlr_foreign_toplevel_handle_v1 *handle,
+                          const char *app_id) {
+    (void)handle;
+    Toplevel *tl = data;
+    free(tl->pending_app_id);
+    tl->pending_app_id = text_sanitize_dup(app_id);
+}
+
+static void handle_output_enter(void *data, struct zwlr_foreign_toplevel_handle_v1 *handle,
+                                struct wl_output *output) {
+    (void)data; (void)handle; (void)output;
+}
+
+static void handle_output_leave(void *data, struct zwlr_foreign_toplevel_handle_v1 *handle,
+                                struct wl_output *output) {
+    (void)data; (void)handle; (void)output;
+}
+
+static void handle_state(void *data, struct zwlr_foreign_toplevel_handle_v1 *handle,
+                         struct wl_array *state) {
+    (void)handle;
+    Toplevel *tl = data;
+    tl->pending_activated = false;
+    uint32_t *entry;
+    wl_array_for_each(entry, state) {
+        if (*entry == ZWLR_FOREIGN_TOPLEVEL_HANDLE_V1_STATE_ACTIVATED) {
+            tl->pending_activated = true;
+        }
+    }
+    tl->has_pending_state = true;
+}
+
+static void handle_done(void *data, struct zwlr_foreign_toplevel_handle_v1 *handle) {
+    (void)handle;
+    Toplevel *tl = data;
+
+    if (tl->pending_title) {
+        free(tl->title);
+        tl->title = tl->pending_title;
+        tl->pending_title = NULL;
+        s_changed = true;
+    }
+    if (tl->pending_app_id) {
+        free(tl->app_id);
+        tl->app_id = tl->pending_app_id;
+        tl->pending_app_id = NULL;
+        s_changed = true;
+    }
+    if (tl->has_pending_state) {
+        if (tl->pending_activated && !tl->activated) {
+            tl->active_seq = ++s_active_seq;
+            s_changed = true;
+        }
+        tl->activated = tl->pending_activated;
+        tl->has_pending_state = false;
+    }
+}
+
+static void handle_closed(void *data, struct zwlr_foreign_toplevel_handle_v1 *handle) {
+    (void)handle;
+    Toplevel *tl = data;
+
+    for (Toplevel **pp = &s_toplevels; *pp; pp = &(*pp)->next) {
+        if (*pp == tl) {
+            *pp = tl->next;
+            break;
+        }
+    }
+    LOG_DEBUG("[TOPLEVEL] Closed tl:%u (%s)", tl->id, tl->app_id ? tl->app_id : "");
+    toplevel_free(tl);
+    s_changed = true;
+}
+
+static void handle_parent(void *data, struct zwlr_foreign_toplevel_handle_v1 *handle,
+                          struct zwlr_foreign_toplevel_handle_v1 *parent) {
+    (void)data; (void)handle; (void)parent;
+}
+
+static const struct zwlr_foreign_toplevel_handle_v1_listener handle_listener = {
+    .title = handle_title,
+    .app_id = handle_app_id,
+    .output_enter = handle_output_enter,
+    .output_leave = handle_output_leave,
+    .state = handle_state,
+    .done = handle_done,
+    .closed = handle_closed,
+    .parent = handle_parent,
+};
+
+static void manager_toplevel(void *data, struct zwlr_foreign_toplevel_manager_v1 *manager,
+                             struct zwlr_foreign_toplevel_handle_v1 *handle) {
+    (void)data; (void)manager;
+    Toplevel *tl = calloc(1, sizeof(*tl));
+    if (!tl) {
+        LOG_ERROR("[TOPLEVEL] Out of memory tracking toplevel");
+        zwlr_foreign_toplevel_handle_v1_destroy(handle);
+        return;
+    }
+    tl->handle = handle;
+    tl->id = ++s_next_id;
+    tl->next = s_toplevels;
+    s_toplevels = tl;
+    zwlr_foreign_toplevel_handle_v1_add_listener(handle, &handle_listener, tl);
+}
+
+static void manager_finished(void *data, struct zwlr_foreign_toplevel_manager_v1 *manager) {
+    (void)data;
+    LOG_WARN("[TOPLEVEL] Compositor finished the toplevel manager; using Hyprland IPC");
+    zwlr_foreign_toplevel_manager_v1_destroy(manager);
+    s_manager = NULL;
+    s_changed = true;
+}
+
+static const struct zwlr_foreign_toplevel_manager_v1_listener manager_listener = {
+    .toplevel = manager_toplevel,
+    .finished = manager_finished,
+};
+
+void toplevel_bind(struct wl_registry *registry, uint32_t name, uint32_t version) {
+    if (s_manager) {
+        return;
+    }
+    uint32_t bind_version = version < TOPLEVEL_MANAGER_VERSION ? version : TOPLEVEL_MANAGER_VERSION;
+    s_manager = wl_registry_bind(registry, name,
+                                 &zwlr_foreign_toplevel_manager_v1_interface, bind_version);
+    zwlr_foreign_toplevel_manager_v1_add_listener(s_manager, &manager_listener, NULL);
+    LOG_INFO("[TOPLEVEL] Bound foreign toplevel manager v%u", bind_version);
+}
+
+bool toplevel_available(void) {
+    return s_manager != NULL;
+}
+
+/*
+ * Most recently activated first; then windows never seen active in the
+ * previous session's order; then the rest oldest first
+ */
+static int compare_toplevels(const void *a, const void *b) {
+    const Toplevel *ta = *(const Toplevel *const *)a;
+    const Toplevel *tb = *(const Toplevel *const *)b;
+    if (ta->active_seq != tb->active_seq) {
+        return ta->active_seq > tb->active_seq ? -1 : 1;
+    }
+    if (ta->seed_rank != tb->seed_rank) {
+        if (ta->seed_rank < 0) return 1;
+        if (tb->seed_rank < 0) return -1;
+        return ta->seed_rank < tb->seed_rank ? -1 : 1;
+    }
+    return ta->id < tb->id ? -1 : (ta->id > tb->id);
+}
+
+/* ============================================================================
+ * Recency Across Sessions
+ * ============================================================================ */
+
+/*
+ * Every session is a new client of the manager, and the protocol has no
+ * focus history: only the window active at bind time is known. The order
+ * of the previous session is kept by app_id and title so "previous window"
+ * still means something on the first Tab.
+ */
+static int recency_path(char *buf, size_t bufsize) {
+    char state_dir[384];
+    if (config_get_state_dir(state_dir, sizeof(state_dir)) != 0) {
+        return -1;
+    }
+    int ret = snprintf(buf, bufsize, "%s/%s", state_dir, RECENCY_FILE);
+    return (ret < 0 || (size_t)ret >= bufsize) ? -1 : 0;
+}
+
+static void recency_load(void) {
+    s_recency_loaded = true;
+    char path[512];
+    if (recency_path(path, sizeof(path)) != 0) {
+        return;
+    }
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        return;
+    }
+    char line[1024];
+    while (s_recency_count < RECENCY_MAX && fgets(line, sizeof(line), f)) {
+        line[strcspn(line, "\n")] = '\0';
+        char *tab = strchr(line, '\t');
+        if (!tab) {
+            continue;
+        }
+        *tab = '\0';
+        RecencyEntry *e = &s_recency[s_recency_count];
+        e->app_id = strdup(line);
+        e->title = strdup(tab + 1);
+        if (!e->app_id || !e->title) {
+            free(e->app_id);
+            free(e->title);
+            break;
+        }
+        s_recency_count++;
+    }
+    fclose(f);
+    LOG_DEBUG("[TOPLEVEL] Loaded %zu remembered windows", s_recency_count);
+}
+
+static bool same_text(const char *a, const char *b) {
+    return strcmp(a ? a : "", b ? b : "") == 0;
+}
+
+/*
+ * Give windows never seen active their rank in the previous session: an
+ * exact app_id and title match first, then the first unused entry of the
+ * same app_id (titles change). Each entry ranks one window.
+ */
+static void recency_seed(Toplevel **order, size_t n) {
+    if (!s_recency_loaded) {
+        recency_load();
+    }
+    for (size_t r = 0; r < s_recency_count; r++) {
+        s_recency[r].used = false;
+    }
+    for (size_t i = 0; i < n; i++) {
+        order[i]->seed_rank = -1;
+    }
+    for (int pass = 0; pass < 2; pass++) {
+        for (size_t i = 0; i < n; i++) {
+            Toplevel *tl = order[i];
+            if (tl->active_seq != 0 || tl->seed_rank >= 0) {
+                continue;
+            }
+            for (size_t r = 0; r < s_recency_count; r++) {
+                RecencyEntry *e = &s_recency[r];
+                if (!e->used && same_text(e->app_id, tl->app_id) &&
+                    (pass == 1 || same_text(e->title, tl->title))) {
+                    e->used = true;
+                    tl->seed_rank = (int)r;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+/* Write the current order for the next session (atomically) */
+static void recency_save(void) {
+    char path[512];
+    char tmp[520];
+    if (!s_toplevels || recency_path(path, sizeof(path)) != 0) {
+        return;
+    }
+    size_t n = 0;
+    for (Toplevel *tl = s_toplevels; tl; tl = tl->next) {
+        n++;
+    }
+    Toplevel **order = malloc(n * sizeof(*order));
+    if (!order) {
+        return;
+    }
+    size_t i = 0;
+    for (Toplevel *tl = s_toplevels; tl; tl = tl->next) {
+        order[i++] = tl;
+    }
+    recency_seed(order, n);
+    qsort(order, n, sizeof(*order), compare_toplevels);
+
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+    FILE *f = fopen(tmp, "w");
+    if (!f) {
+        LOG_DEBUG("[TOPLEVEL] Could not write %s: %s", tmp, strerror(errno));
+        free(order);
+        return;
+    }
+    for (i = 0; i < n && i < RECENCY_MAX; i++) {
+        /* Sanitized text has no tabs or newlines */
+        fprintf(f, "%s\t%s\n", order[i]->app_id ? order[i]->app_id : "",
+                order[i]->title ? order[i]->title : "");
+    }
+    free(order);
+    if (fclose(f) != 0 || rename(tmp, path) != 0) {
+        unlink(tmp);
+    }
+}
+
+static void recency_free(void) {
+    for (size_t r = 0; r < s_recency_count; r++) {
+        free(s_recency[r].app_id);
+        free(s_recency[r].title);
+    }
+    s_recency_count = 0;
+    s_recency_loaded = false;
+}
+
+int toplevel_get_clients(HyprClientInfo **list_out, size_t *count_out) {
+    *list_out = NULL;
+    *count_out = 0;
+    if (!s_manager) {
+        return -1;
+    }
+
+    size_t n = 0;
+    for (Toplevel *tl = s_toplevels; tl; tl = tl->next) {
+        n++;
+    }
+    if (n == 0) {
+        return 0;
+    }
+
+    Toplevel **order = malloc(n * sizeof(*order));
+    HyprClientInfo *list = calloc(n, sizeof(*list));
+    if (!order || !list) {
+        free(order);
+        free(list);
+        return -1;
+    }
+    size_t i = 0;
+    for (Toplevel *tl = s_toplevels; tl; tl = tl->next) {
+        order[i++] = tl;
+    }
+    recency_seed(order, n);
+    qsort(order, n, sizeof(*order), compare_toplevels);
+
+    for (i = 0; i < n; i++) {
+        const Toplevel *tl = order[i];
+        HyprClientInfo *info = &list[i];
+        char address[32];
+        snprintf(address, sizeof(address), TOPLEVEL_ADDRESS_PREFIX "%u", tl->id);
+        info->address = strdup(address);
+        info->title = strdup(tl->title && tl->title[0] ? tl->title : "(untitled)");
+        info->app_class = strdup(tl->app_id ? tl->app_id : "");
+        info->workspace_id = -1;
+        info->monitor_id = -1;
+        info->pid = 0;
+        info->focusHistoryID = (int)i;
+        info->focused = tl->activated;
+    }
+    free(order);
+
+    *list_out = list;
+    *count_out = n;
+    return 0;
+}
+
+int toplevel_activate(const char *address, struct wl_seat *seat) {
+    if (!s_manager || !seat || !address ||
+        strncmp(address, TOPLEVEL_ADDRESS_PREFIX, strlen(TOPLEVEL_ADDRESS_PREFIX)) != 0) {
+        return -1;
+    }
+    uint32_t id = (uint32_t)strtoul(address + strlen(TOPLEVEL_ADDRESS_PREFIX), NULL, 10);
+    for (Toplevel *tl = s_toplevels; tl; tl = tl->next) {
+        if (tl->id == id) {
+            zwlr_foreign_toplevel_handle_v1_activate(tl->handle, seat);
+            /* The activated state may only arrive after we are gone; the
+             * saved order must already have the choice first */
+            tl->active_seq = ++s_active_seq;
+            LOG_DEBUG("[TOPLEVEL] Activate %s (%s)", address, tl->app_id ? tl->app_id : "");
+            return 0;
+        }
+    }
+    LOG_WARN("[TOPLEVEL] No toplevel with address %s", address);
+    return -1;
+}
+
+bool toplevel_take_changed(void) {
+    bool changed = s_changed;
+    s_changed = false;
+    return changed;
+}
+
+void toplevel_destroy(void) {
+    recency_save();
+    recency_free();
+    while (s_toplevels) {
+        Toplevel *tl = s_toplevels;
+        s_toplevels = tl->next;
+        toplevel_free(tl);
+    }
+    if (s_manager) {
+        zwlr_foreign_toplevel_manager_v1_stop(s_manager);
+        zwlr_foreign_toplevel_manager_v1_destroy(s_manager);
+        s_manager = NULL;
+    }
+}
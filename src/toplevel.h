@@ -0,0 +1,69 @@
+#pragma once
+/*
+ * toplevel.h - Window list backend on zwlr_foreign_toplevel_manager_v1
+ *
+ * Instead of querying Hyprland's socket, the compositor pushes window
+ * add/remove/title/app_id/state changes over the Wayland connection we
+ * already hold, and windows are activated with a protocol request.
+ * Selected with `window_backend=toplevel`; when the compositor does not
+ * advertise the manager, the Hyprland IPC path is used instead.
+ *
+ * Windows are exposed as HyprClientInfo, the same shape ipc.c produces,
+ * with synthesized addresses of the form "tl:<id>". The protocol carries no
+ * focus history, so recency is tracked from activation changes seen while
+ * we are bound. The order is saved in the state directory when the session
+ * ends, and windows not seen active yet are ranked by it (matched by app_id
+ * and title); the rest keep the compositor's order.
+ */
+
+#ifndef TOPLEVEL_H
+#define TOPLEVEL_H
+
+#include "ipc.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+struct wl_registry;
+struct wl_seat;
+
+/* Address prefix of windows owned by this backend */
+#define TOPLEVEL_ADDRESS_PREFIX "tl:"
+
+/*
+ * Bind the manager global (call from the registry listener).
+ * The initial window list arrives with the following roundtrip.
+ */
+void toplevel_bind(struct wl_registry *registry, uint32_t name, uint32_t version);
+
+/* Whether the manager is bound and still alive. */
+bool toplevel_available(void);
+
+/*
+ * Copy the current window list, most recently activated first
+ * (focusHistoryID 0 = currently active).
+ *
+ * Returns:
+ *   0:  Success (list may be empty); free with hypr_ipc_free_client_infos
+ *   -1: Backend unavailable or allocation failed
+ */
+int toplevel_get_clients(HyprClientInfo **list_out, size_t *count_out);
+
+/*
+ * Request activation of a window by its "tl:<id>" address.
+ *
+ * Returns:
+ *   0:  Request sent
+ *   -1: Unknown address or backend unavailable
+ */
+int toplevel_activate(const char *address, struct wl_seat *seat);
+
+/*
+ * Whether the window list changed since the last call (clears the flag).
+ */
+bool toplevel_take_changed(void);
+
+/* Destroy all handles and the manager. */
+void toplevel_destroy(void);
+
+#endif /* TOPLEVEL_H */
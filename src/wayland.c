@@ -7,8 +7,18 @@
 #include "ipc.h"
 #include "input.h"
 #include "switcher_ipc.h"
+#include "switcher_ring.h"
 #include "hypr_events.h"
+#include "hypr_caps.h"
 #include "config.h"
+#include "flight.h"
+#include "hypr_worker.h"
+#include "toplevel.h"
+#include "client_model.h"
+#include "model_snapshot.h"
+#include "bg_layer.h"
+#include "list_output.h"
+#include "title_throttle.h"
 #include <stdint.h>
 #include <string.h>
 #include <stdio.h>
@@ -30,18 +40,17 @@ static struct wl_surface *surface;
 static struct zwlr_layer_surface_v1 *layer_surface;
 static struct wl_seat *seat;
 
+/* Event queues: input is dispatched before anything render-related */
+static struct wl_event_queue *input_queue;
+static struct wl_event_queue *render_queue;
+
 static uint32_t current_width  = 600;
 static uint32_t current_height = 120;
 
 static int configured = 0;
 
-/* Client list state */
-static HyprClientInfo *g_clients = NULL;
-static size_t g_client_count = 0;
-
-/* Deep-copied titles for safe rendering (won't dangle if clients refreshed) */
-static char **g_titles = NULL;
-static size_t g_titles_count = 0;
+/* The client list itself lives in client_model.c, in every sort order */
+static ClientModel *g_model = NULL;
 
 /* Selection state */
 static int g_selection_index = -1;
@@ -61,13 +70,47 @@ static bool g_needs_redraw = false;
 /* Flag to track if client list changed and needs refresh */
 static bool g_clients_dirty = false;
 
+/* Initial client list: fetched by the IPC worker while Wayland starts up */
+typedef enum {
+    INITIAL_WAITING = 0,   /* snapshot not arrived yet */
+    INITIAL_RECEIVED,      /* snapshot stored in the client model, not applied */
+    INITIAL_FAILED,        /* query failed */
+    INITIAL_APPLIED        /* applied on the first configure */
+} InitialListState;
+static InitialListState g_initial_state = INITIAL_WAITING;
+
+/* The applied initial list was the worker's early two-window list; the
+ * full one replaces it when the reply has been read */
+static bool g_initial_partial = false;
+
+/* Tabs received during show_delay_ms, before there was a list to move in
+ * (negative = backward); applied on top of the initial selection */
+static int g_startup_cycles = 0;
+
+/* Class steps (Alt+` or CLASS) that came before the full list */
+static int g_startup_class_cycles = 0;
+
+/* COMMIT, Alt release or focus loss that came before the list it needs:
+ * carried out once the list is in, or at the deadline with what there is */
+#define COMMIT_WAIT_TIMEOUT_NS (1000ull * 1000000ull)
+static const char *g_pending_commit = NULL;
+static uint64_t g_pending_commit_deadline_ns = 0;
+
+/* Selection is moving through the focused window's app_class; plain
+ * cycling leaves this mode */
+static bool g_class_mode = false;
+
+/* Started with --prepare: frames are drawn but the surface stays unmapped
+ * until the first Tab (CYCLE) arrives, or the instance gives up */
+static bool g_prepared = false;
+static uint64_t g_prepare_deadline_ns = 0;
+
 /* ============================================================================
  * Forward Declarations
  * ============================================================================ */
 
 void wayland_shutdown(void);
 static void refresh_client_list(void);
-static void rebuild_titles(void);
 static void redraw_overlay(void);
 
 /* ============================================================================
@@ -93,51 +136,22 @@ static uint32_t calculate_overlay_height(size_t visible_count, int item_height,
 }
 
 /* ============================================================================
- * Title Management (Deep Copy for Safety)
+ * Row Labels
  * ============================================================================ */
 
-static void free_titles(void) {
-    if (g_titles) {
-        for (size_t i = 0; i < g_titles_count; i++) {
-            free(g_titles[i]);
-        }
-        free(g_titles);
-        g_titles = NULL;
+/* RenderRowText over the client model: app class, falling back to the title */
+static const char *model_row_text(size_t index, void *user) {
+    const HyprClientInfo *info = client_model_at(user, index);
+    if (!info) {
+        return NULL;
     }
-    g_titles_count = 0;
-}
-
-static void rebuild_titles(void) {
-    free_titles();
-    
-    if (g_client_count == 0 || !g_clients) {
-        return;
+    if (info->app_class && info->app_class[0] != '\0') {
+        return info->app_class;
     }
-    
-    g_titles = calloc(g_client_count, sizeof(char *));
-    if (!g_titles) {
-        LOG_ERROR("[WAYLAND] Failed to allocate titles array");
-        return;
-    }
-    g_titles_count = g_client_count;
-    
-    for (size_t i = 0; i < g_client_count; i++) {
-        const char *display_name = NULL;
-        
-        /* Prefer app_class, fall back to title */
-        if (g_clients[i].app_class && g_clients[i].app_class[0] != '\0') {
-            display_name = g_clients[i].app_class;
-        } else if (g_clients[i].title && g_clients[i].title[0] != '\0') {
-            display_name = g_clients[i].title;
-        } else {
-            display_name = "(untitled)";
-        }
-        
-        g_titles[i] = strdup(display_name);
-        if (!g_titles[i]) {
-            g_titles[i] = "(error)";
-        }
+    if (info->title && info->title[0] != '\0') {
+        return info->title;
     }
+    return "(untitled)";
 }
 
 /* ============================================================================
@@ -153,8 +167,9 @@ static void rebuild_titles(void) {
  */
 static void selection_set(int new_index, bool wrap) {
     int old_index = g_selection_index;
+    size_t count = client_model_count(g_model);
     
-    if (g_client_count == 0) {
+    if (count == 0) {
         g_selection_index = -1;
         if (old_index != g_selection_index) {
             g_needs_redraw = true;
@@ -164,15 +179,15 @@ static void selection_set(int new_index, bool wrap) {
     
     if (new_index < 0) {
         if (wrap) {
-            new_index = (int)g_client_count - 1;
+            new_index = (int)count - 1;
         } else {
             new_index = 0;
         }
-    } else if (new_index >= (int)g_client_count) {
+    } else if (new_index >= (int)count) {
         if (wrap) {
             new_index = 0;
         } else {
-            new_index = (int)g_client_count - 1;
+            new_index = (int)count - 1;
         }
     }
     
@@ -181,35 +196,24 @@ static void selection_set(int new_index, bool wrap) {
     /* Update selected address for preservation across refreshes */
     free(g_selected_address);
     g_selected_address = NULL;
-    if (g_selection_index >= 0 && g_selection_index < (int)g_client_count) {
-        if (g_clients[g_selection_index].address) {
-            g_selected_address = strdup(g_clients[g_selection_index].address);
-        }
+    const HyprClientInfo *selected = client_model_at(g_model, (size_t)g_selection_index);
+    if (selected && selected->address) {
+        g_selected_address = strdup(selected->address);
     }
     
     if (old_index != g_selection_index) {
         LOG_DEBUG("[SELECTION] Changed from %d to %d (count=%zu)", 
-                  old_index, g_selection_index, g_client_count);
+                  old_index, g_selection_index, count);
         g_needs_redraw = true;
     }
 }
 
 /*
- * Find a client by address in the current list.
+ * Find a client by address in the current order.
  * Returns index if found, -1 if not found.
  */
 static int find_client_by_address(const char *address) {
-    if (!address || !g_clients) {
-        return -1;
-    }
-    
-    for (size_t i = 0; i < g_client_count; i++) {
-        if (g_clients[i].address && strcmp(g_clients[i].address, address) == 0) {
-            return (int)i;
-        }
-    }
-    
-    return -1;
+    return address ? client_model_index_of(g_model, address) : -1;
 }
 
 /*
@@ -218,7 +222,7 @@ static int find_client_by_address(const char *address) {
  * If not found, adjusts selection to remain valid.
  */
 static void preserve_selection(void) {
-    if (g_client_count == 0) {
+    if (client_model_count(g_model) == 0) {
         selection_set(-1, false);
         return;
     }
@@ -242,91 +246,200 @@ static void preserve_selection(void) {
 
 /* Helper: cycle selection forward */
 static void cycle_forward(void) {
-    if (g_client_count > 0) {
+    g_class_mode = false;
+    if (client_model_count(g_model) > 0) {
         selection_set(g_selection_index + 1, true);
         LOG_DEBUG("[WAYLAND] Cycle forward: new selection index: %d", g_selection_index);
     }
 }
 
+/* Helper: switch the list order, keeping the selection on the same window */
+static void set_sort_order(SortOrder order) {
+    if (order == client_model_get_order(g_model)) {
+        return;
+    }
+    client_model_set_order(g_model, order);
+    if (g_initial_focus_address) {
+        g_initial_focus_index = client_model_index_of(g_model, g_initial_focus_address);
+    }
+    preserve_selection();
+    g_needs_redraw = true;
+    LOG_DEBUG("[WAYLAND] Sort order: %s", config_sort_order_name(order));
+}
+
 /* Helper: cycle selection backward */
 static void cycle_backward(void) {
-    if (g_client_count > 0) {
+    g_class_mode = false;
+    if (client_model_count(g_model) > 0) {
         selection_set(g_selection_index - 1, true);
         LOG_DEBUG("[WAYLAND] Cycle backward: new selection index: %d", g_selection_index);
     }
 }
 
-/* ============================================================================
- * Client List Management (Phase 2: Dynamic Updates)
- * ============================================================================ */
+/*
+ * Helper: step through the windows sharing the focused window's app_class,
+ * in MRU order. The first step starts from the focused window; later ones
+ * from the selection. Both go through the model's class index.
+ */
+static void class_step(int direction) {
+    const HyprClientInfo *next = NULL;
+    if (g_class_mode && g_selected_address) {
+        next = client_model_class_step(g_model, g_selected_address, direction);
+    }
+    if (!next) {
+        /* Entering the mode, or the selected window has closed */
+        const char *from = g_initial_focus_address;
+        if (!from) {
+            const HyprClientInfo *top = client_model_mru_at(g_model, 0);
+            from = top ? top->address : NULL;
+        }
+        next = from ? client_model_class_step(g_model, from, direction) : NULL;
+    }
+    if (!next) {
+        LOG_DEBUG("[WAYLAND] Class cycle: no focused window");
+        return;
+    }
+    g_class_mode = true;
+    selection_set(client_model_index_of(g_model, next->address), false);
+    LOG_DEBUG("[WAYLAND] Class cycle %s: %s (%zu windows)", direction < 0 ? "backward" : "forward",
+              next->app_class, client_model_class_count(g_model, next->address));
+}
 
-static void free_client_list(void) {
-    if (g_clients) {
-        hypr_ipc_free_client_infos(g_clients, g_client_count);
-        g_clients = NULL;
+/* Helper: class step, held back while only the early two-window list is in */
+static void cycle_class(int direction) {
+    if (g_initial_state != INITIAL_APPLIED || g_initial_partial) {
+        g_startup_class_cycles += direction;
+        return;
     }
-    g_client_count = 0;
+    class_step(direction);
 }
 
+static void apply_startup_class_cycles(void) {
+    for (; g_startup_class_cycles > 0; g_startup_class_cycles--) class_step(1);
+    for (; g_startup_class_cycles < 0; g_startup_class_cycles++) class_step(-1);
+}
+
+/* ============================================================================
+ * Client List Management (Phase 2: Dynamic Updates)
+ * ============================================================================ */
+
 /*
- * Refresh client list from Hyprland IPC.
- * Preserves selection if possible.
+ * Resize the overlay to fit the current number of rows.
  */
-static void refresh_client_list(void) {
-    LOG_DEBUG("[WAYLAND] Refreshing client list...");
-    
-    /* Store old selection address for preservation */
-    char *old_selected = g_selected_address ? strdup(g_selected_address) : NULL;
+static void update_overlay_height(void) {
+    size_t count = client_model_count(g_model);
+    if (!layer_surface || count == 0) {
+        return;
+    }
     
-    /* Free old list */
-    free_client_list();
+    const SwitcherConfig *cfg = config_get();
+    int item_height = cfg->item_height;
+    /* shadow is drawn inside the surface (the background layer has none) */
+    int padding = cfg->padding + (bg_layer_active() ? 0 : cfg->shadow_size);
+    size_t visible_count = count;
     
-    /* Fetch new list */
-    if (hypr_ipc_get_clients_basic(&g_clients, &g_client_count) != 0) {
-        LOG_WARN("[WAYLAND] Failed to refresh client list");
-        g_clients = NULL;
-        g_client_count = 0;
-    } else {
-        /* Sort by focus history: most recently focused first */
-        hypr_ipc_sort_clients_by_focus(g_clients, g_client_count);
+    /* Limit visible items if configured */
+    if (cfg->max_visible_items > 0 && visible_count > (size_t)cfg->max_visible_items) {
+        visible_count = (size_t)cfg->max_visible_items;
     }
     
-    LOG_DEBUG("[WAYLAND] Client list refreshed: %zu clients (sorted by focus history)", g_client_count);
-    
-    /* Rebuild titles with deep copies */
-    rebuild_titles();
+    uint32_t desired_height = calculate_overlay_height(visible_count, item_height, padding);
     
-    /* Restore selection address and preserve */
-    if (old_selected) {
-        free(g_selected_address);
-        g_selected_address = old_selected;
+    if (desired_height != current_height) {
+        current_height = desired_height;
+        zwlr_layer_surface_v1_set_size(layer_surface, current_width, current_height);
+        wl_surface_commit(surface);
+        LOG_DEBUG("[WAYLAND] Resized overlay to %ux%u", current_width, current_height);
     }
+}
+
+/*
+ * The model changed (windows added, removed or reordered): keep the
+ * selection on the same window, fit the overlay and redraw.
+ */
+static void client_list_changed(void) {
     preserve_selection();
+    update_overlay_height();
+    g_needs_redraw = true;
+}
+
+/*
+ * Install a freshly fetched client list (sorted by focus history).
+ * Preserves selection if possible.
+ */
+static void install_client_list(HyprClientInfo *list, size_t count) {
+    uint64_t flight_start = flight_now();
     
-    /* Update layer surface size based on config */
-    if (layer_surface && g_client_count > 0) {
-        const SwitcherConfig *cfg = config_get();
-        int item_height = cfg->item_height;
-        int padding = cfg->padding;
-        size_t visible_count = g_client_count;
-        
-        /* Limit visible items if configured */
-        if (cfg->max_visible_items > 0 && visible_count > (size_t)cfg->max_visible_items) {
-            visible_count = (size_t)cfg->max_visible_items;
-        }
-        
-        uint32_t desired_height = calculate_overlay_height(visible_count, item_height, padding);
-        
-        if (desired_height != current_height) {
-            current_height = desired_height;
-            zwlr_layer_surface_v1_set_size(layer_surface, current_width, current_height);
-            wl_surface_commit(surface);
-            LOG_DEBUG("[WAYLAND] Resized overlay to %ux%u", current_width, current_height);
-        }
-    }
+    client_model_sync(g_model, list, count);
+    LOG_DEBUG("[WAYLAND] Client list refreshed: %zu clients (order=%s)",
+              client_model_count(g_model), config_sort_order_name(client_model_get_order(g_model)));
     
-    g_needs_redraw = true;
+    client_list_changed();
+    flight_span(FLIGHT_REFRESH, flight_start, (int64_t)client_model_count(g_model));
+}
+
+/*
+ * Refresh client list from Hyprland IPC. With the IPC worker running this
+ * only posts a request; the list is installed when the snapshot arrives.
+ */
+static void refresh_client_list(void) {
+    LOG_DEBUG("[WAYLAND] Refreshing client list...");
     g_clients_dirty = false;
+
+    HyprClientInfo *list = NULL;
+    size_t count = 0;
+    if (toplevel_available()) {
+        if (toplevel_get_clients(&list, &count) == 0) {
+            install_client_list(list, count);
+        }
+        return;
+    }
+
+    if (hypr_worker_event_fd() >= 0) {
+        hypr_worker_request_clients();
+        return;
+    }
+
+    if (hypr_ipc_get_clients_basic(&list, &count) != 0) {
+        LOG_WARN("[WAYLAND] Failed to refresh client list");
+        return;
+    }
+    hypr_ipc_sort_clients_by_focus(list, count);
+    install_client_list(list, count);
+}
+
+/* ============================================================================
+ * Live Titles
+ * ============================================================================ */
+
+static uint64_t title_interval_ns(void) {
+    return (uint64_t)config_get()->title_update_ms * 1000000ull;
+}
+
+/* Titles are drawn once the full list is applied and the overlay is mapped */
+static bool titles_shown(void) {
+    return g_initial_state == INITIAL_APPLIED && !g_initial_partial && !g_prepared;
+}
+
+static void apply_title(const char *address, const char *title, void *user) {
+    bool *changed = user;
+    *changed |= client_model_set_title(g_model, address, title);
+}
+
+/* Apply held titles whose interval has passed (all of them with force) */
+static void flush_titles(bool force) {
+    bool changed = false;
+    title_throttle_flush(flight_now(), title_interval_ns(), force, apply_title, &changed);
+    if (changed) {
+        client_list_changed();
+    }
+}
+
+/* The overlay just became visible: catch up on titles held while hidden */
+static void show_held_titles(void) {
+    if (titles_shown()) {
+        flush_titles(true);
+    }
 }
 
 /* ============================================================================
@@ -339,20 +452,36 @@ static void process_hypr_events(void) {
     }
     
     HyprEvent event;
-    bool list_changed = false;
+    bool list_changed = false;     /* needs a fresh snapshot */
+    bool model_changed = false;    /* model already updated in place */
+    uint64_t flight_start = flight_now();
+    bool shown = titles_shown();
+    int64_t handled = 0;
     
-    /* Process all pending events */
-    while (hypr_events_read(g_hypr_events_fd, &event)) {
+    /* Process all pending events (unparsed lines don't stop the drain,
+     * but leave nothing to handle) */
+    for (;;) {
+        if (!hypr_events_read(g_hypr_events_fd, &event)) {
+            if (hypr_events_pending()) {
+                continue;
+            }
+            break;
+        }
+        handled++;
         switch (event.type) {
             case HYPR_EVENT_OPEN_WINDOW:
                 LOG_INFO("[HYPR_EVENT] Window opened: %s (%s)", 
                          event.address, event.window_class);
+                /* Show it right away; the snapshot fills in the monitor */
+                model_changed |= client_model_insert(g_model, event.address, event.window_class,
+                                                     event.title, event.workspace_id);
                 list_changed = true;
                 break;
                 
             case HYPR_EVENT_CLOSE_WINDOW:
                 LOG_INFO("[HYPR_EVENT] Window closed: %s", event.address);
-                list_changed = true;
+                model_changed |= client_model_remove(g_model, event.address);
+                title_throttle_forget(event.address);
                 
                 /* Check if closed window was our initial focus */
                 if (g_initial_focus_address && 
@@ -370,10 +499,34 @@ static void process_hypr_events(void) {
                           event.window_class, event.title);
                 break;
                 
+            case HYPR_EVENT_ACTIVE_WINDOW_V2:
+                model_changed |= client_model_touch(g_model, event.address);
+                break;
+                
             case HYPR_EVENT_MOVE_WINDOW:
                 LOG_DEBUG("[HYPR_EVENT] Window moved: %s to workspace %d", 
                           event.address, event.workspace_id);
-                /* Could refresh if we filter by workspace */
+                if (event.workspace_id > 0) {
+                    model_changed |= client_model_move(g_model, event.address, event.workspace_id);
+                } else {
+                    /* Named workspace: the id is only in the snapshot */
+                    list_changed = true;
+                }
+                break;
+
+            case HYPR_EVENT_WINDOW_TITLE_V2:
+                if (title_throttle_offer(event.address, event.title, flight_start,
+                                         title_interval_ns(), shown)) {
+                    model_changed |= client_model_set_title(g_model, event.address, event.title);
+                }
+                break;
+
+            case HYPR_EVENT_WINDOW_TITLE:
+                /* Older Hyprland: the new title is only in the snapshot
+                 * (newer ones send windowtitlev2 with it as well) */
+                if (!hypr_caps_get()->window_title_v2) {
+                    list_changed = true;
+                }
                 break;
                 
             default:
@@ -384,6 +537,40 @@ static void process_hypr_events(void) {
     if (list_changed) {
         g_clients_dirty = true;
     }
+    if (model_changed && g_initial_state == INITIAL_APPLIED) {
+        client_list_changed();
+    }
+    if (handled > 0) {
+        flight_span(FLIGHT_EVENTS, flight_start, handled);
+    }
+}
+
+/* ============================================================================
+ * Event Queue Dispatch
+ * ============================================================================ */
+
+/*
+ * Dispatch queued Wayland events in priority order: keyboard first, then the
+ * default queue (registry, seat), then configure events and buffer releases.
+ * Selection changes therefore always see the newest key state before the
+ * next frame is built.
+ * Returns -1 if any dispatch failed.
+ */
+static int dispatch_queues_prioritized(void) {
+    if (!display) {
+        return -1;
+    }
+    if (input_queue && wl_display_dispatch_queue_pending(display, input_queue) < 0) {
+        return -1;
+    }
+    if (wl_display_dispatch_pending(display) < 0) {
+        return -1;
+    }
+    if (display && render_queue &&
+        wl_display_dispatch_queue_pending(display, render_queue) < 0) {
+        return -1;
+    }
+    return 0;
 }
 
 /* ============================================================================
@@ -395,15 +582,19 @@ static void redraw_overlay(void) {
         return;
     }
     
-    if (g_titles && g_titles_count > 0) {
-        render_draw_titles_focus(surface, current_width, current_height,
-                                 (const char **)g_titles, g_titles_count, 
-                                 g_selection_index);
+    uint64_t flight_start = flight_now();
+
+    /* Drawn on the thread that owns the model: no snapshot copy needed */
+    size_t count = client_model_count(g_model);
+    if (count > 0) {
+        render_draw_rows(surface, current_width, current_height,
+                         model_row_text, g_model, count, g_selection_index);
     } else {
         /* Show "No windows" placeholder */
-        render_draw_titles_focus(surface, current_width, current_height,
-                                 NULL, 0, -1);
+        render_draw_rows(surface, current_width, current_height,
+                         NULL, NULL, 0, -1);
     }
+    flight_span(FLIGHT_RENDER, flight_start, (int64_t)count);
     
     g_needs_redraw = false;
 }
@@ -416,7 +607,6 @@ static void registry_add(void *data, struct wl_registry *registry,
         uint32_t name, const char *interface, uint32_t version)
 {
     (void)data;
-    (void)version;
 
     if (strcmp(interface, "wl_compositor") == 0) {
         compositor = wl_registry_bind(registry, name, &wl_compositor_interface, 4);
@@ -432,6 +622,14 @@ static void registry_add(void *data, struct wl_registry *registry,
         seat = wl_registry_bind(registry, name, &wl_seat_interface, 7);
         input_handle_seat(seat);
     }
+    else if (config_get()->background_layer &&
+             bg_layer_bind(registry, name, interface, version)) {
+        /* viewporter, single-pixel buffers, subcompositor */
+    }
+    else if (strcmp(interface, "zwlr_foreign_toplevel_manager_v1") == 0 &&
+             config_get()->window_backend == WINDOW_BACKEND_TOPLEVEL) {
+        toplevel_bind(registry, name, version);
+    }
 }
 
 static void registry_remove(void *data, struct wl_registry *registry, uint32_t name)
@@ -448,6 +646,159 @@ static const struct wl_registry_listener registry_listener = {
  * Layer Surface Handlers
  * ============================================================================ */
 
+/*
+ * First client list of the session: remember the initially focused window
+ * (for Escape), start the selection on the previous window and size the
+ * overlay. Runs once both the first configure and the snapshot are in.
+ */
+static void apply_initial_clients(void) {
+    const SwitcherConfig *cfg = config_get();
+    bool ok = (g_initial_state == INITIAL_RECEIVED);
+    g_initial_state = INITIAL_APPLIED;
+
+    if (!ok) {
+        LOG_WARN("[WAYLAND] Failed to get initial client list");
+        render_draw(surface, current_width, current_height);
+        return;
+    }
+
+    /* In MRU order:
+     *   Position 0 = currently focused window (focusHistoryID == 0)
+     *   Position 1 = previously focused window (focusHistoryID == 1)
+     * 
+     * Initial focus is always MRU position 0 (for Escape restore).
+     * Selection starts on MRU position 1 (previous window) so one Tab press
+     * switches to the last used window, wherever the current order puts it. */
+    
+    size_t count = client_model_count(g_model);
+    const HyprClientInfo *current = client_model_mru_at(g_model, 0);
+    const HyprClientInfo *previous = client_model_mru_at(g_model, count > 1 ? 1 : 0);
+    
+    g_initial_focus_index = current ? client_model_index_of(g_model, current->address) : -1;
+    if (current && current->address) {
+        g_initial_focus_address = strdup(current->address);
+        if (!g_initial_focus_address) {
+            LOG_WARN("[WAYLAND] Failed to allocate initial focus address");
+        }
+    }
+    
+    /* Start selection on the previous window if available */
+    g_selection_index = previous ? client_model_index_of(g_model, previous->address) : -1;
+
+    /* Calculate dynamic height based on config */
+    int item_height = cfg->item_height;
+    /* shadow is drawn inside the surface (the background layer has none) */
+    int padding = cfg->padding + (bg_layer_active() ? 0 : cfg->shadow_size);
+    size_t visible_count = count;
+    
+    /* Limit visible items if configured */
+    if (cfg->max_visible_items > 0 && visible_count > (size_t)cfg->max_visible_items) {
+        visible_count = (size_t)cfg->max_visible_items;
+    }
+    
+    uint32_t desired_height = calculate_overlay_height(visible_count, item_height, padding);
+
+    current_height = desired_height;
+    zwlr_layer_surface_v1_set_size(layer_surface, current_width, current_height);
+    
+    LOG_DEBUG("Initial configure: %ux%u (clients: %zu%s, focus=%d, initial=%d)",
+              current_width, current_height, count, g_initial_partial ? ", early" : "",
+              g_selection_index, g_initial_focus_index);
+
+    /* Update selected address */
+    free(g_selected_address);
+    g_selected_address = NULL;
+    if (previous && previous->address) {
+        g_selected_address = strdup(previous->address);
+        if (!g_selected_address) {
+            LOG_WARN("[WAYLAND] Failed to allocate selected address");
+        }
+    }
+
+    for (; g_startup_cycles > 0; g_startup_cycles--) cycle_forward();
+    for (; g_startup_cycles < 0; g_startup_cycles++) cycle_backward();
+    if (!g_initial_partial) {
+        client_model_freeze(g_model, true);
+        apply_startup_class_cycles();
+    }
+    show_held_titles();
+
+    redraw_overlay();
+}
+
+/*
+ * Store the initial snapshot (status 1 = ok, 2 = early partial list,
+ * -1 = failed). It is applied by the first configure, or right away if that
+ * has already happened.
+ */
+static void receive_initial_clients(HyprClientInfo *list, size_t count, int status) {
+    g_initial_partial = (status == 2);
+    client_model_clear(g_model);
+    if (status > 0) {
+        client_model_sync(g_model, list, count);
+    } else {
+        hypr_ipc_free_client_infos(list, count);
+    }
+    g_selection_index = -1;
+    g_initial_focus_index = -1;
+    free(g_initial_focus_address);
+    g_initial_focus_address = NULL;
+    g_initial_state = status > 0 ? INITIAL_RECEIVED : INITIAL_FAILED;
+}
+
+/* The full list replaced the early two-window one (or never will) */
+static void finish_partial_list(void) {
+    if (g_initial_focus_address) {
+        /* Escape's index fallback must point into the full list */
+        g_initial_focus_index = find_client_by_address(g_initial_focus_address);
+    }
+    g_initial_partial = false;
+    client_model_freeze(g_model, true);
+    apply_startup_class_cycles();
+    show_held_titles();
+}
+
+/* Pick up snapshots posted by the IPC worker */
+static void process_worker_results(void) {
+    HyprClientInfo *list = NULL;
+    size_t count = 0;
+    int r = hypr_worker_take_clients(&list, &count);
+    if (r == 0) {
+        return;
+    }
+
+    if (g_initial_state == INITIAL_APPLIED) {
+        if (r == 2) {
+            /* Early list of a session already showing a full one */
+            hypr_ipc_free_client_infos(list, count);
+        } else if (r > 0) {
+            install_client_list(list, count);
+            if (g_initial_partial) {
+                finish_partial_list();
+            }
+        } else if (g_initial_partial) {
+            /* The full list must not stay missing: the session would be
+             * left with two windows, no titles and no frozen order */
+            LOG_WARN("[WAYLAND] Full client list query failed; retrying in place");
+            if (hypr_ipc_get_clients_basic(&list, &count) == 0) {
+                hypr_ipc_sort_clients_by_focus(list, count);
+                install_client_list(list, count);
+            } else {
+                LOG_WARN("[WAYLAND] Keeping the early client list");
+            }
+            finish_partial_list();
+        } else {
+            LOG_WARN("[WAYLAND] Failed to refresh client list");
+        }
+        return;
+    }
+
+    receive_initial_clients(list, count, r);
+    if (configured) {
+        apply_initial_clients();
+    }
+}
+
 static void layer_surface_configure(void *data,
     struct zwlr_layer_surface_v1 *lsurf,
     uint32_t serial, uint32_t width, uint32_t height)
@@ -467,79 +818,44 @@ static void layer_surface_configure(void *data,
     zwlr_layer_surface_v1_ack_configure(lsurf, serial);
     configured = 1;
 
-    /* Initial client list fetch */
-    free_client_list();
-    free_titles();
-    
-    g_selection_index = -1;
-    g_initial_focus_index = -1;
-    free(g_initial_focus_address);
-    g_initial_focus_address = NULL;
-
-    if (hypr_ipc_get_clients_basic(&g_clients, &g_client_count) == 0) {
-
-        /* Sort by focus history: most recently focused first */
-        hypr_ipc_sort_clients_by_focus(g_clients, g_client_count);
+    if (g_initial_state == INITIAL_APPLIED) {
+        /* Later configures (e.g. after a resize) keep the current list */
+        g_needs_redraw = true;
+        return;
+    }
 
-        /* After sorting:
-         *   Index 0 = currently focused window (focusHistoryID == 0)
-         *   Index 1 = previously focused window (focusHistoryID == 1)
-         * 
-         * Initial focus is always index 0 (for Escape restore).
-         * Selection starts at index 1 (previous window) so one Tab press
-         * switches to the last used window. */
-        
-        g_initial_focus_index = 0;
-        if (g_client_count > 0 && g_clients[0].address) {
-            g_initial_focus_address = strdup(g_clients[0].address);
-            if (!g_initial_focus_address) {
-                LOG_WARN("[WAYLAND] Failed to allocate initial focus address");
+    /* Initial client list: pushed by the compositor or requested from the
+     * IPC worker at startup */
+    if (g_initial_state == INITIAL_WAITING) {
+        if (toplevel_available()) {
+            HyprClientInfo *list = NULL;
+            size_t count = 0;
+            int r = toplevel_get_clients(&list, &count) == 0 ? 1 : -1;
+            receive_initial_clients(list, count, r);
+        } else if (hypr_worker_event_fd() >= 0) {
+            HyprClientInfo *list = NULL;
+            size_t count = 0;
+            int r = hypr_worker_take_clients(&list, &count);
+            if (r != 0) {
+                receive_initial_clients(list, count, r);
             }
-        }
-        
-        /* Start selection at index 1 (previous window) if available */
-        if (g_client_count > 1) {
-            g_selection_index = 1;
-        } else if (g_client_count == 1) {
-            g_selection_index = 0;
-        }
-
-        /* Calculate dynamic height based on config */
-        int item_height = cfg->item_height;
-        int padding = cfg->padding;
-        size_t visible_count = g_client_count;
-        
-        /* Limit visible items if configured */
-        if (cfg->max_visible_items > 0 && visible_count > (size_t)cfg->max_visible_items) {
-            visible_count = (size_t)cfg->max_visible_items;
-        }
-        
-        uint32_t desired_height = calculate_overlay_height(visible_count, item_height, padding);
-
-        current_height = desired_height;
-        zwlr_layer_surface_v1_set_size(lsurf, current_width, current_height);
-        
-        LOG_DEBUG("Initial configure: %ux%u (clients: %zu, focus=%d, initial=%d)",
-                  current_width, current_height, g_client_count, 
-                  g_selection_index, g_initial_focus_index);
-
-        /* Build titles and update selected address */
-        rebuild_titles();
-        
-        free(g_selected_address);
-        g_selected_address = NULL;
-        if (g_selection_index >= 0 && g_clients[g_selection_index].address) {
-            g_selected_address = strdup(g_clients[g_selection_index].address);
-            if (!g_selected_address) {
-                LOG_WARN("[WAYLAND] Failed to allocate selected address");
+        } else {
+            HyprClientInfo *list = NULL;
+            size_t count = 0;
+            int r = hypr_ipc_get_clients_basic(&list, &count) == 0 ? 1 : -1;
+            if (r > 0) {
+                hypr_ipc_sort_clients_by_focus(list, count);
             }
+            receive_initial_clients(list, count, r);
         }
+    }
 
-        redraw_overlay();
-    } else {
-        LOG_WARN("[WAYLAND] Failed to get initial client list");
+    if (g_initial_state == INITIAL_WAITING) {
+        /* Snapshot still in flight; show the placeholder until it arrives */
         render_draw(surface, current_width, current_height);
+        return;
     }
+    apply_initial_clients();
 }
 
 static void layer_surface_closed(void *data,
@@ -561,12 +877,28 @@ static const struct zwlr_layer_surface_v1_listener layer_surface_listener = {
 
 struct wl_shm *get_shm() { return shm; }
 
+struct wl_event_queue *get_render_queue() { return render_queue; }
+
 struct wl_display *init_wayland() {
     display = wl_display_connect(NULL);
     if (!display) {
         DIE("Failed to connect to Wayland.\n");
     }
 
+    /* Queues must exist before the registry roundtrip binds the seat */
+    input_queue = wl_display_create_queue(display);
+    render_queue = wl_display_create_queue(display);
+    if (!input_queue || !render_queue) {
+        DIE("Failed to create Wayland event queues.\n");
+    }
+    input_set_event_queue(input_queue);
+
+    g_model = client_model_new();
+    if (!g_model) {
+        DIE("Failed to allocate the window list.\n");
+    }
+    client_model_set_order(g_model, config_get()->sort_order);
+
     struct wl_registry *registry = wl_display_get_registry(display);
     wl_registry_add_listener(registry, &registry_listener, NULL);
     wl_display_roundtrip(display);
@@ -575,15 +907,29 @@ struct wl_display *init_wayland() {
         DIE("Missing Wayland globals.\n");
     }
 
+    if (config_get()->window_backend == WINDOW_BACKEND_TOPLEVEL) {
+        if (toplevel_available()) {
+            /* Receive the initial toplevels and their title/app_id/state */
+            wl_display_roundtrip(display);
+        } else {
+            LOG_WARN("[WAYLAND] Foreign toplevel manager not advertised; using Hyprland IPC");
+            hypr_worker_request_initial_clients();
+        }
+    }
+
     return display;
 }
 
 void create_layer_surface() {
     surface = wl_compositor_create_surface(compositor);
+    if (config_get()->background_layer) {
+        bg_layer_attach(compositor, surface);
+    }
 
     layer_surface = zwlr_layer_shell_v1_get_layer_surface(
         layer_shell, surface, NULL,
         ZWLR_LAYER_SHELL_V1_LAYER_OVERLAY, "hyprswitcher");
+    wl_proxy_set_queue((struct wl_proxy *)layer_surface, render_queue);
 
     zwlr_layer_surface_v1_set_size(layer_surface, current_width, current_height);
     zwlr_layer_surface_v1_set_anchor(layer_surface,
@@ -602,25 +948,41 @@ void create_layer_surface() {
     if (g_hypr_events_fd < 0) {
         LOG_WARN("[WAYLAND] Could not connect to Hyprland events; dynamic updates disabled");
     }
+    hypr_ipc_set_event_fd(g_hypr_events_fd);
 }
 
 /* ============================================================================
  * Focus Helpers
  * ============================================================================ */
 
+/* Activate a client through the backend that listed it */
+static int focus_client(const HyprClientInfo *client) {
+    if (client->address &&
+        strncmp(client->address, TOPLEVEL_ADDRESS_PREFIX, strlen(TOPLEVEL_ADDRESS_PREFIX)) == 0) {
+        int rc = toplevel_activate(client->address, seat);
+        /* The connection is closed right after focusing; send it now */
+        if (rc == 0 && wl_display_flush(display) < 0) {
+            rc = -1;
+        }
+        return rc;
+    }
+    return hypr_ipc_focus_client(client);
+}
+
 /* Helper: attempt focusing the currently selected client */
 static void wayland_focus_selected(const char *tag) {
-    if (g_clients && g_client_count > 0 &&
-        g_selection_index >= 0 &&
-        g_selection_index < (int)g_client_count) {
-        HyprClientInfo *sel = &g_clients[g_selection_index];
+    const HyprClientInfo *sel = g_selection_index >= 0
+        ? client_model_at(g_model, (size_t)g_selection_index) : NULL;
+    if (sel) {
         LOG_INFO("[FOCUS] %s Selected index=%d address=%s class=%s title=%s",
                  tag ? tag : "",
                  g_selection_index,
                  sel->address ? sel->address : "(null)",
                  sel->app_class ? sel->app_class : "(null)",
                  sel->title ? sel->title : "(null)");
-        int frc = hypr_ipc_focus_client(sel);
+        uint64_t flight_start = flight_now();
+        int frc = focus_client(sel);
+        flight_span(FLIGHT_FOCUS, flight_start, frc);
         if (frc == 0) {
             LOG_INFO("[FOCUS] %s Focus attempt succeeded.", tag ? tag : "");
         } else {
@@ -629,22 +991,80 @@ static void wayland_focus_selected(const char *tag) {
     } else {
         LOG_WARN("[FOCUS] %s No valid selection (index=%d count=%zu).",
                  tag ? tag : "",
-                 g_selection_index, g_client_count);
+                 g_selection_index, client_model_count(g_model));
+    }
+}
+
+/* The selection can't be trusted yet: no list, or class steps held back
+ * until the full list replaces the early two-window one */
+static bool commit_must_wait(void) {
+    return g_initial_state != INITIAL_APPLIED ||
+           (g_initial_partial && g_startup_class_cycles != 0);
+}
+
+/* Focus the selection (or the previous window without one) and close */
+static void finish_commit(const char *tag) {
+    if (g_prepared) {
+        /* Never shown: nothing was chosen */
+    } else if (g_selection_index >= 0) {
+        wayland_focus_selected(tag);
+    } else {
+        /* No list at all (query failed or never came): a quick Alt+Tab
+         * still means "previous window" */
+        LOG_INFO("[FOCUS] %s No selection; focusing the previous window", tag);
+        if (hypr_ipc_focus_last() != 0) {
+            LOG_WARN("[FOCUS] %s Focusing the previous window failed.", tag);
+        }
+    }
+    g_pending_commit = NULL;
+    wayland_shutdown();
+}
+
+/*
+ * Commit the selection, or hold that back while the list is still on its
+ * way. Returns true if the session ended.
+ */
+static bool commit_selection(const char *tag) {
+    if (g_pending_commit) {
+        return false;   /* already committing */
+    }
+    if (!g_prepared && commit_must_wait()) {
+        LOG_INFO("[FOCUS] %s Window list not in yet; switching once it arrives", tag);
+        g_pending_commit = tag;
+        g_pending_commit_deadline_ns = flight_now() + COMMIT_WAIT_TIMEOUT_NS;
+        return false;
+    }
+    finish_commit(tag);
+    return true;
+}
+
+/* Carry out a held commit once its list is in (or it waited long enough) */
+static bool run_pending_commit(void) {
+    if (!g_pending_commit) {
+        return false;
     }
+    if (commit_must_wait()) {
+        if (flight_now() < g_pending_commit_deadline_ns) {
+            return false;
+        }
+        LOG_WARN("[FOCUS] %s Window list still missing; committing anyway", g_pending_commit);
+    }
+    finish_commit(g_pending_commit);
+    return true;
 }
 
 /* Helper: restore initial focus (for Escape/Cancel) */
 static void wayland_restore_initial_focus(void) {
     /* First try to find by stored address (more reliable) */
-    if (g_initial_focus_address && g_clients) {
+    if (g_initial_focus_address) {
         int found = find_client_by_address(g_initial_focus_address);
         if (found >= 0) {
-            HyprClientInfo *initial = &g_clients[found];
+            const HyprClientInfo *initial = client_model_at(g_model, (size_t)found);
             LOG_INFO("[FOCUS] Restoring initial focus by address: %s class=%s title=%s",
                      initial->address ? initial->address : "(null)",
                      initial->app_class ? initial->app_class : "(null)",
                      initial->title ? initial->title : "(null)");
-            int frc = hypr_ipc_focus_client(initial);
+            int frc = focus_client(initial);
             if (frc == 0) {
                 LOG_INFO("[FOCUS] Initial focus restored successfully.");
             } else {
@@ -657,14 +1077,14 @@ static void wayland_restore_initial_focus(void) {
     }
     
     /* Fall back to index-based restore */
-    if (g_clients && g_client_count > 0 &&
-        g_initial_focus_index >= 0 &&
-        g_initial_focus_index < (int)g_client_count) {
-        HyprClientInfo *initial = &g_clients[g_initial_focus_index];
+    const HyprClientInfo *fallback = g_initial_focus_index >= 0
+        ? client_model_at(g_model, (size_t)g_initial_focus_index) : NULL;
+    if (fallback) {
+        const HyprClientInfo *initial = fallback;
         LOG_INFO("[FOCUS] Restoring initial focus by index: %d address=%s",
                  g_initial_focus_index,
                  initial->address ? initial->address : "(null)");
-        int frc = hypr_ipc_focus_client(initial);
+        int frc = focus_client(initial);
         if (frc == 0) {
             LOG_INFO("[FOCUS] Initial focus restored successfully.");
         } else {
@@ -672,15 +1092,164 @@ static void wayland_restore_initial_focus(void) {
         }
     } else {
         LOG_DEBUG("[FOCUS] No initial focus to restore (index=%d count=%zu address=%s).",
-                  g_initial_focus_index, g_client_count,
+                  g_initial_focus_index, client_model_count(g_model),
                   g_initial_focus_address ? g_initial_focus_address : "(null)");
     }
 }
 
+/* ============================================================================
+ * Prepared (Unmapped) Sessions
+ * ============================================================================ */
+
+static void prepare_extend_deadline(void) {
+    g_prepare_deadline_ns = flight_now() +
+                            (uint64_t)config_get()->prepare_timeout_ms * 1000000ull;
+}
+
+void wayland_set_prepared(void) {
+    g_prepared = true;
+    prepare_extend_deadline();
+    render_set_deferred(true);
+    LOG_INFO("[WAYLAND] Prepared mode: overlay stays hidden until Tab (%d ms)",
+             config_get()->prepare_timeout_ms);
+}
+
+void wayland_add_startup_cycles(int delta) {
+    g_startup_cycles += delta;
+}
+
+void wayland_add_startup_class_cycles(int delta) {
+    g_startup_class_cycles += delta;
+}
+
+/* Tab arrived: show the frame drawn while waiting */
+static void map_prepared_overlay(void) {
+    g_prepared = false;
+    render_set_deferred(false);
+    show_held_titles();
+    if (g_needs_redraw || !render_present_pending(surface)) {
+        redraw_overlay();
+    }
+    LOG_INFO("[WAYLAND] Mapped prepared overlay");
+}
+
 /* ============================================================================
  * IPC Command Processing
  * ============================================================================ */
 
+/*
+ * Apply a single command from a helper instance (socket or shared ring).
+ * Returns true if the command ended the session (display is gone).
+ */
+static bool handle_switcher_command(SwitcherCmdType cmd) {
+    if (cmd != SWITCHER_CMD_TYPE_NONE &&
+        !(cmd >= SWITCHER_CMD_TYPE_LIST_TSV && cmd <= SWITCHER_CMD_TYPE_LIST_BIN)) {
+        flight_action_begin(FLIGHT_COMMAND, cmd);
+    }
+
+    /* The first Tab after --prepare only reveals the overlay, which already
+     * selects the previous window like a cold start would */
+    if (g_prepared && (cmd == SWITCHER_CMD_TYPE_CYCLE || cmd == SWITCHER_CMD_TYPE_CYCLE_BACKWARD)) {
+        LOG_INFO("[IPC] Received %s while prepared", cmd == SWITCHER_CMD_TYPE_CYCLE
+                 ? "CYCLE" : "CYCLE_BACKWARD");
+        map_prepared_overlay();
+        return false;
+    }
+
+    switch (cmd) {
+        case SWITCHER_CMD_TYPE_CYCLE:
+            LOG_INFO("[IPC] Received CYCLE command");
+            cycle_forward();
+            break;
+
+        case SWITCHER_CMD_TYPE_CYCLE_BACKWARD:
+            LOG_INFO("[IPC] Received CYCLE_BACKWARD command");
+            cycle_backward();
+            break;
+
+        case SWITCHER_CMD_TYPE_COMMIT:
+            LOG_INFO("[IPC] Received COMMIT command");
+            return commit_selection("(IPC COMMIT)");
+
+        case SWITCHER_CMD_TYPE_CANCEL:
+            LOG_INFO("[IPC] Received CANCEL command");
+            if (!g_prepared) {
+                wayland_restore_initial_focus();
+            }
+            wayland_shutdown();
+            return true;
+
+        case SWITCHER_CMD_TYPE_PREPARE:
+            LOG_INFO("[IPC] Received PREPARE command");
+            if (g_prepared) {
+                prepare_extend_deadline();   /* Alt pressed again; keep waiting */
+            } else if (g_hypr_events_fd < 0 && !toplevel_available()) {
+                g_clients_dirty = true;      /* no live updates; the list may be stale */
+            }
+            break;
+
+        case SWITCHER_CMD_TYPE_SORT_MRU:
+        case SWITCHER_CMD_TYPE_SORT_CLASS:
+        case SWITCHER_CMD_TYPE_SORT_WORKSPACE:
+        case SWITCHER_CMD_TYPE_SORT_MONITOR:
+            LOG_INFO("[IPC] Received SORT command");
+            set_sort_order((SortOrder)(SORT_ORDER_MRU + (cmd - SWITCHER_CMD_TYPE_SORT_MRU)));
+            break;
+
+        case SWITCHER_CMD_TYPE_CLASS:
+        case SWITCHER_CMD_TYPE_CLASS_BACKWARD:
+            LOG_INFO("[IPC] Received %s command", cmd == SWITCHER_CMD_TYPE_CLASS
+                     ? "CLASS" : "CLASS_BACKWARD");
+            cycle_class(cmd == SWITCHER_CMD_TYPE_CLASS ? 1 : -1);
+            if (g_prepared) {
+                map_prepared_overlay();   /* showing the class selection */
+            }
+            break;
+
+        case SWITCHER_CMD_TYPE_LIST_TSV:
+        case SWITCHER_CMD_TYPE_LIST_JSON:
+        case SWITCHER_CMD_TYPE_LIST_BIN:
+            /* Answered in process_ipc_commands(); the ring has no reply channel */
+            LOG_WARN("[IPC] Received LIST without a reply channel, ignoring");
+            break;
+
+        case SWITCHER_CMD_TYPE_NONE:
+            /* No data yet or client disconnected - not an error */
+            break;
+            
+        case SWITCHER_CMD_TYPE_UNKNOWN:
+            LOG_WARN("[IPC] Received unknown command, ignoring");
+            break;
+            
+        default:
+            break;
+    }
+    return false;
+}
+
+/*
+ * LIST_*: reply with the published list, formatted for --list. Without a
+ * complete list yet the connection is closed unanswered and the helper
+ * queries Hyprland itself.
+ */
+static void answer_list_command(int client_fd, SwitcherCmdType cmd) {
+    if (g_initial_state != INITIAL_APPLIED || g_initial_partial) {
+        LOG_DEBUG("[IPC] LIST before the full client list; not answering");
+        return;
+    }
+    /* Copied only when asked for, and only if the model changed since */
+    model_snapshot_publish(g_model);
+    const ModelSnapshot *snap = model_snapshot_acquire();
+    size_t len = 0;
+    char *buf = list_output_format(snap, (ListFormat)(cmd - SWITCHER_CMD_TYPE_LIST_TSV), &len);
+    model_snapshot_release(snap);
+    if (buf) {
+        switcher_ipc_reply(client_fd, buf, len);
+        LOG_INFO("[IPC] Answered LIST (%zu bytes)", len);
+        free(buf);
+    }
+}
+
 /* Process incoming IPC commands from helper instances */
 static void process_ipc_commands(int listen_fd) {
     if (listen_fd < 0) return;
@@ -690,41 +1259,25 @@ static void process_ipc_commands(int listen_fd) {
     while ((client_fd = switcher_ipc_accept(listen_fd)) >= 0) {
         /* Read command from this client */
         SwitcherCmdType cmd = switcher_ipc_read_command(client_fd);
+        if (cmd >= SWITCHER_CMD_TYPE_LIST_TSV && cmd <= SWITCHER_CMD_TYPE_LIST_BIN) {
+            answer_list_command(client_fd, cmd);
+            close(client_fd);
+            continue;
+        }
         close(client_fd);
 
-        switch (cmd) {
-            case SWITCHER_CMD_TYPE_CYCLE:
-                LOG_INFO("[IPC] Received CYCLE command");
-                cycle_forward();
-                break;
-
-            case SWITCHER_CMD_TYPE_CYCLE_BACKWARD:
-                LOG_INFO("[IPC] Received CYCLE_BACKWARD command");
-                cycle_backward();
-                break;
-
-            case SWITCHER_CMD_TYPE_COMMIT:
-                LOG_INFO("[IPC] Received COMMIT command");
-                wayland_focus_selected("(IPC COMMIT)");
-                wayland_shutdown();
-                return;
-
-            case SWITCHER_CMD_TYPE_CANCEL:
-                LOG_INFO("[IPC] Received CANCEL command");
-                wayland_restore_initial_focus();
-                wayland_shutdown();
-                return;
+        if (handle_switcher_command(cmd)) {
+            return;
+        }
+    }
+}
 
-            case SWITCHER_CMD_TYPE_NONE:
-                /* No data yet or client disconnected - not an error */
-                break;
-                
-            case SWITCHER_CMD_TYPE_UNKNOWN:
-                LOG_WARN("[IPC] Received unknown command, ignoring");
-                break;
-                
-            default:
-                break;
+/* Drain commands published into the shared-memory ring */
+static void process_ring_commands(void) {
+    SwitcherCmdType cmd;
+    while ((cmd = switcher_ring_pop()) != SWITCHER_CMD_TYPE_NONE) {
+        if (handle_switcher_command(cmd)) {
+            return;
         }
     }
 }
@@ -735,19 +1288,19 @@ static void process_ipc_commands(int listen_fd) {
 
 /* Original wayland_loop for backward compatibility */
 void wayland_loop() {
-    wayland_loop_with_ipc(-1);
+    wayland_loop_with_ipc(-1, -1);
 }
 
 /* Main event loop with IPC socket integration */
-void wayland_loop_with_ipc(int ipc_listen_fd) {
+void wayland_loop_with_ipc(int ipc_listen_fd, int ring_event_fd) {
     if (!display) return;
 
     g_ipc_listen_fd = ipc_listen_fd;
 
     int wl_fd = wl_display_get_fd(display);
 
-    /* Set up poll for Wayland, IPC, and Hyprland events */
-    struct pollfd pfds[3];
+    /* Set up poll for Wayland, IPC, command ring, IPC worker and Hyprland events */
+    struct pollfd pfds[5];
     int nfds = 1;
 
     pfds[0].fd = wl_fd;
@@ -758,7 +1311,20 @@ void wayland_loop_with_ipc(int ipc_listen_fd) {
         pfds[nfds].events = POLLIN;
         nfds++;
     }
+
+    if (ring_event_fd >= 0) {
+        pfds[nfds].fd = ring_event_fd;
+        pfds[nfds].events = POLLIN;
+        nfds++;
+    }
     
+    int worker_fd = hypr_worker_event_fd();
+    if (worker_fd >= 0) {
+        pfds[nfds].fd = worker_fd;
+        pfds[nfds].events = POLLIN;
+        nfds++;
+    }
+
     int hypr_events_poll_idx = -1;
     if (g_hypr_events_fd >= 0) {
         hypr_events_poll_idx = nfds;
@@ -769,30 +1335,66 @@ void wayland_loop_with_ipc(int ipc_listen_fd) {
 
     while (display) {
         /* Process any already queued (non-blocking) Wayland events */
-        wl_display_dispatch_pending(display);
+        if (dispatch_queues_prioritized() < 0) {
+            LOG_ERROR("[WAYLAND] Event dispatch failed; shutting down.");
+            wayland_shutdown();
+            break;
+        }
+        if (!display) break;  /* a handler may have called shutdown */
+
+        /* Window list changes pushed over the toplevel protocol */
+        if (toplevel_take_changed() && g_initial_state == INITIAL_APPLIED) {
+            g_clients_dirty = true;
+        }
         
         /* Process Hyprland window events */
         if (g_hypr_events_fd >= 0) {
             process_hypr_events();
         }
         
+        /* Titles held back by the per-window rate limit */
+        if (titles_shown()) {
+            flush_titles(false);
+        }
+        
         /* Refresh client list if dirty */
         if (g_clients_dirty) {
             refresh_client_list();
         }
 
+        /* Install client snapshots finished by the IPC worker */
+        if (worker_fd >= 0) {
+            process_worker_results();
+        }
+
         /* Process any pending IPC commands */
         if (ipc_listen_fd >= 0) {
             process_ipc_commands(ipc_listen_fd);
             if (!display) break;  /* process_ipc_commands may have called shutdown */
         }
 
+        /* Process commands published through the shared-memory ring */
+        if (ring_event_fd >= 0) {
+            process_ring_commands();
+            if (!display) break;
+        }
+
+        /* A commit that arrived before the window list */
+        if (run_pending_commit()) {
+            break;
+        }
+
+        /* A prepared instance whose Tab never came goes away unseen */
+        if (g_prepared && flight_now() >= g_prepare_deadline_ns) {
+            LOG_INFO("[WAYLAND] No Tab after PREPARE; exiting without showing the overlay");
+            wayland_shutdown();
+            break;
+        }
+
         /* Input / lifecycle checks */
         if (input_focus_lost()) {
             LOG_INFO("[INPUT] Focus lost; attempting focus then closing overlay.");
-            wayland_focus_selected("(focus-lost)");
-            wayland_shutdown();
-            break;
+            if (commit_selection("(focus-lost)")) break;
         }
         if (input_escape_pressed()) {
             LOG_INFO("[INPUT] Escape pressed, restoring initial focus and shutting down.");
@@ -801,7 +1403,7 @@ void wayland_loop_with_ipc(int ipc_listen_fd) {
             break;
         }
         if (input_alt_tab_triggered()) {
-            if (g_client_count > 0) {
+            if (client_model_count(g_model) > 0) {
                 if (input_shift_is_down()) {
                     cycle_backward();
                 } else {
@@ -809,11 +1411,12 @@ void wayland_loop_with_ipc(int ipc_listen_fd) {
                 }
             }
         }
+        if (input_alt_grave_triggered()) {
+            cycle_class(input_shift_is_down() ? -1 : 1);
+        }
         if (input_alt_released()) {
             LOG_INFO("[INPUT] Alt released; attempting to focus selected client.");
-            wayland_focus_selected("");
-            wayland_shutdown();
-            break;
+            if (commit_selection("(alt-release)")) break;
         }
         
         /* Redraw if needed */
@@ -821,7 +1424,15 @@ void wayland_loop_with_ipc(int ipc_listen_fd) {
             redraw_overlay();
         }
 
-        /* Prepare to block for new events with timeout */
+        /* Scroll a cut-off selected title (one row band per frame callback) */
+        uint64_t marquee_due = render_marquee_deadline();
+        if (marquee_due > 0 && marquee_due <= flight_now()) {
+            render_marquee_step(surface, flight_now());
+        }
+
+        /* Prepare to block for new events with timeout.
+         * All queues were drained above, so only the default queue can
+         * have gained events since (nothing reads the socket in between). */
         if (wl_display_prepare_read(display) != 0) {
             /* Events queued, dispatch them next iteration */
             continue;
@@ -838,6 +1449,18 @@ void wayland_loop_with_ipc(int ipc_listen_fd) {
         }
 
         int timeout_ms = 50; /* wake 20 times per second to remain responsive */
+        uint64_t title_due = titles_shown() ? title_throttle_next_due(title_interval_ns()) : 0;
+        if (title_due > 0) {
+            uint64_t now = flight_now();
+            int due_ms = title_due <= now ? 0 : (int)((title_due - now + 999999) / 1000000);
+            if (due_ms < timeout_ms) timeout_ms = due_ms;
+        }
+        marquee_due = render_marquee_deadline();
+        if (marquee_due > 0) {
+            uint64_t now = flight_now();
+            int due_ms = marquee_due <= now ? 0 : (int)((marquee_due - now + 999999) / 1000000);
+            if (due_ms < timeout_ms) timeout_ms = due_ms;
+        }
         int pr = poll(pfds, nfds, timeout_ms);
 
         if (pr < 0) {
@@ -855,7 +1478,7 @@ void wayland_loop_with_ipc(int ipc_listen_fd) {
             /* Check Wayland FD */
             if (pfds[0].revents & POLLIN) {
                 if (wl_display_read_events(display) == 0) {
-                    wl_display_dispatch_pending(display);
+                    dispatch_queues_prioritized();
                 } else {
                     LOG_WARN("[WAYLAND] read_events failed; shutting down.");
                     wl_display_cancel_read(display);
@@ -885,6 +1508,7 @@ void wayland_loop_with_ipc(int ipc_listen_fd) {
                 LOG_WARN("[WAYLAND] Hyprland event socket disconnected");
                 hypr_events_disconnect(g_hypr_events_fd);
                 g_hypr_events_fd = -1;
+                hypr_ipc_set_event_fd(-1);
                 
                 /* Compact the poll array by moving last element to this position */
                 if (hypr_events_poll_idx < nfds - 1) {
@@ -894,7 +1518,7 @@ void wayland_loop_with_ipc(int ipc_listen_fd) {
                 nfds--;
             }
 
-            /* IPC FD activity will be processed at start of next iteration */
+            /* IPC, ring and worker FD activity will be processed at start of next iteration */
         } else {
             /* Timeout; cancel read so we can check state again */
             wl_display_cancel_read(display);
@@ -908,22 +1532,37 @@ void wayland_loop_with_ipc(int ipc_listen_fd) {
 
 void wayland_shutdown() {
     LOG_DEBUG("[WAYLAND] Shutting down...");
-    
-    /* Close Hyprland event socket */
-    if (g_hypr_events_fd >= 0) {
-        hypr_events_disconnect(g_hypr_events_fd);
-        g_hypr_events_fd = -1;
-    }
+
+    /* A pending commit/cancel action ends here, after its focus dispatch */
+    flight_action_end();
     
     /* Destroy layer surface early to let compositor reclaim resources */
     if (layer_surface) { 
         zwlr_layer_surface_v1_destroy(layer_surface); 
         layer_surface = NULL; 
+        if (display) {
+            wl_display_flush(display);
+        }
+    }
+
+    /* Confirm a commit's focus only now, with the overlay already gone */
+    hypr_ipc_focus_confirm();
+    
+    /* Close Hyprland event socket */
+    if (g_hypr_events_fd >= 0) {
+        hypr_events_disconnect(g_hypr_events_fd);
+        g_hypr_events_fd = -1;
+        hypr_ipc_set_event_fd(-1);
     }
 
     /* Free client list and titles */
-    free_client_list();
-    free_titles();
+    title_throttle_reset();
+    model_snapshot_shutdown();
+    client_model_free(g_model);
+    g_model = NULL;
+    toplevel_destroy();
+    render_cleanup();
+    bg_layer_destroy();   /* subsurface goes before its parent */
     
     /* Free address tracking strings */
     free(g_initial_focus_address);
@@ -934,6 +1573,8 @@ void wayland_shutdown() {
     /* Reset indices */
     g_selection_index = -1;
     g_initial_focus_index = -1;
+    g_prepared = false;
+    render_set_deferred(false);
 
     /* Input after layer surface so no more events target destroyed surface */
     input_shutdown();
@@ -943,6 +1584,8 @@ void wayland_shutdown() {
     if (compositor) { wl_compositor_destroy(compositor); compositor = NULL; }
     if (shm) { wl_shm_destroy(shm); shm = NULL; }
     if (seat) { wl_seat_destroy(seat); seat = NULL; }
+    if (input_queue) { wl_event_queue_destroy(input_queue); input_queue = NULL; }
+    if (render_queue) { wl_event_queue_destroy(render_queue); render_queue = NULL; }
     if (display) { wl_display_disconnect(display); display = NULL; }
     
     LOG_INFO("[WAYLAND] Shutdown complete");
@@ -4,9 +4,24 @@
 
 struct wl_display *init_wayland();
 void create_layer_surface();
+
+/* Keep the overlay unmapped (but drawn) until the first CYCLE command;
+   exit after prepare_timeout_ms without one. Call before create_layer_surface. */
+void wayland_set_prepared(void);
+
+/* Extra Tabs (negative for Shift+Tab) that arrived before the overlay was
+   created; applied after the initial selection. Call before create_layer_surface. */
+void wayland_add_startup_cycles(int delta);
+
+/* Same for class steps (--class): applied once the full list is in. */
+void wayland_add_startup_class_cycles(int delta);
 void wayland_loop();
 
-/* Main event loop with IPC socket integration for single-instance coordination */
-void wayland_loop_with_ipc(int ipc_listen_fd);
+/* Main event loop with IPC socket integration for single-instance coordination.
+   ring_event_fd is the eventfd from switcher_ring_create(), or -1 if unused. */
+void wayland_loop_with_ipc(int ipc_listen_fd, int ring_event_fd);
+
+struct wl_shm *get_shm();
 
-struct wl_shm *get_shm();
\ No newline at end of file
+/* Queue for configure events and buffer releases (dispatched after input) */
+struct wl_event_queue *get_render_queue();
\ No newline at end of file